@@ -1,24 +1,49 @@
 ﻿#include "pch.h"
 #include "Calculator.h"
 #include "Calculator.g.cpp"
-#include "ExprtkEvaluator.h"
 
 namespace winrt::CalculatorEngineCommon::implementation
 {
+    Calculator::Calculator() :
+        m_evaluator(std::make_unique<ExprtkCalculator::internal::ExprtkEvaluator>(std::unordered_map<std::string, double>{}))
+    {
+    }
+
     Calculator::Calculator(winrt::Windows::Foundation::Collections::IPropertySet const& constants)
     {
+        std::unordered_map<std::string, double> constantValues;
         for (auto const& pair : constants)
         {
             auto key = pair.Key();
             auto value = winrt::unbox_value<double>(pair.Value());
-            m_constants.emplace(winrt::to_string(key), value);
+            constantValues.emplace(winrt::to_string(key), value);
         }
+
+        m_evaluator = std::make_unique<ExprtkCalculator::internal::ExprtkEvaluator>(constantValues);
     }
 
     hstring Calculator::EvaluateExpression(hstring const& expression)
     {
-        auto result = ExprtkCalculator::internal::EvaluateExpression(winrt::to_string(expression), m_constants);
+        return EvaluateExpression(expression, ResultFormat::Fixed);
+    }
+
+    hstring Calculator::EvaluateExpression(hstring const& expression, ResultFormat format)
+    {
+        const auto numberFormat = format == ResultFormat::Scientific ? ExprtkCalculator::internal::NumberFormat::Scientific : ExprtkCalculator::internal::NumberFormat::Fixed;
+
+        std::lock_guard lock(m_mutex);
+        auto result = m_evaluator->Evaluate(winrt::to_string(expression), numberFormat);
 
         return hstring(result);
     }
+
+    com_array<double> Calculator::EvaluateBatch(hstring const& expression, hstring const& variable, array_view<double const> inputs)
+    {
+        com_array<double> results(inputs.size());
+
+        std::lock_guard lock(m_mutex);
+        m_evaluator->EvaluateBatch(winrt::to_string(expression), winrt::to_string(variable), inputs.data(), inputs.size(), results.data());
+
+        return results;
+    }
 }
@@ -1,19 +1,28 @@
 ﻿#pragma once
 
 #include "Calculator.g.h"
+#include "ExprtkEvaluator.h"
+
+#include <mutex>
 
 namespace winrt::CalculatorEngineCommon::implementation
 {
     struct Calculator : CalculatorT<Calculator>
     {
-        Calculator() = default;
+        Calculator();
 
         Calculator(winrt::Windows::Foundation::Collections::IPropertySet const& constants);
 
         winrt::hstring EvaluateExpression(winrt::hstring const& expression);
 
+        winrt::hstring EvaluateExpression(winrt::hstring const& expression, winrt::CalculatorEngineCommon::ResultFormat format);
+
+        winrt::com_array<double> EvaluateBatch(winrt::hstring const& expression, winrt::hstring const& variable, winrt::array_view<double const> inputs);
+
     private:
-        std::unordered_map<std::string, double> m_constants;
+        // The Command Palette evaluates on every keystroke, possibly from several threads
+        std::mutex m_mutex;
+        std::unique_ptr<ExprtkCalculator::internal::ExprtkEvaluator> m_evaluator;
     };
 }
 
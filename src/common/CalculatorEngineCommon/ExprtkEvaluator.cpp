@@ -1,50 +1,198 @@
 #include "ExprtkEvaluator.h"
 #include "exprtk.hpp"
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <optional>
 
 namespace ExprtkCalculator::internal
 {
 
-    std::wstring ToWStringFullPrecision(double value)
+    std::wstring FormatNumber(double value, NumberFormat format)
     {
-        std::wostringstream oss;
-        oss << std::fixed << std::setprecision(15) << value;
-        return oss.str();
+        // to_chars writes "-nan(ind)" for the NaN arithmetic produces
+        if (std::isnan(value))
+        {
+            return L"NaN";
+        }
+        if (std::isinf(value))
+        {
+            return value > 0 ? L"Infinity" : L"-Infinity";
+        }
+
+        // Fits the longest fixed output, the digits of the smallest denormal after "-0."
+        char buffer[384];
+
+        auto result = std::to_chars(buffer, std::end(buffer), value, format == NumberFormat::Scientific ? std::chars_format::scientific : std::chars_format::fixed);
+        if (result.ec != std::errc{})
+        {
+            result = std::to_chars(buffer, std::end(buffer), value, std::chars_format::scientific);
+        }
+
+        // Only ASCII digits, signs and letters, widening is a plain copy
+        return std::wstring(buffer, result.ptr);
     }
 
-    std::wstring EvaluateExpression(
-        const std::string& expressionText,
-        const std::unordered_map<std::string, double>& constants)
+    // Trims the text and collapses whitespace runs outside of string literals, so expressions
+    // that only differ in spacing share one cache entry
+    std::string NormalizeExpression(const std::string& expressionText)
     {
-        exprtk::symbol_table<double> symbol_table;
+        std::string normalized;
+        normalized.reserve(expressionText.size());
 
-        for (auto const& [name, value] : constants)
+        bool inString = false;
+        bool pendingSpace = false;
+        for (char c : expressionText)
         {
-            symbol_table.add_constant(name, value);
+            if (!inString && std::isspace(static_cast<unsigned char>(c)))
+            {
+                pendingSpace = !normalized.empty();
+                continue;
+            }
+
+            if (pendingSpace)
+            {
+                normalized.push_back(' ');
+                pendingSpace = false;
+            }
+
+            if (c == '\'')
+            {
+                inString = !inString;
+            }
+            normalized.push_back(c);
         }
 
+        return normalized;
+    }
+
+    struct CompiledExpression
+    {
+        std::string key;
+
+        // Free variable of a batch expression, bound by reference before the expression compiles.
+        // Only batch expressions pay for the extra symbol table.
+        std::optional<exprtk::symbol_table<double>> variables;
+        double input = 0;
+
         exprtk::expression<double> expression;
-        expression.register_symbol_table(symbol_table);
+        bool valid = false;
+    };
 
+    struct ExprtkEvaluator::State
+    {
+        exprtk::symbol_table<double> symbolTable;
         exprtk::parser<double> parser;
+        size_t cacheCapacity = 0;
+
+        // Most recently used first, declared after the symbol table they reference
+        std::list<CompiledExpression> lru;
+        std::unordered_map<std::string, std::list<CompiledExpression>::iterator> cache;
+
+        CompiledExpression& Compile(const std::string& expressionText, const std::string& variable = {});
+    };
+
+    ExprtkEvaluator::ExprtkEvaluator(const std::unordered_map<std::string, double>& constants, size_t cacheCapacity) :
+        m_state(std::make_unique<State>())
+    {
+        m_state->cacheCapacity = cacheCapacity > 0 ? cacheCapacity : 1;
+
+        for (auto const& [name, value] : constants)
+        {
+            m_state->symbolTable.add_constant(name, value);
+        }
+
+        auto& settings = m_state->parser.settings();
 
         // Enable all base functions and arithmetic operators
-        parser.settings().enable_all_base_functions(); // Enable all base functions like sin, cos, log, etc.
-        parser.settings().enable_all_arithmetic_ops(); // Enable all arithmetic operators like +, -, *, /, etc.
+        settings.enable_all_base_functions(); // Enable all base functions like sin, cos, log, etc.
+        settings.enable_all_arithmetic_ops(); // Enable all arithmetic operators like +, -, *, /, etc.
 
         // Disable all control structures and assignment operators to ensure only expressions are evaluated
-        parser.settings().disable_all_control_structures(); // Disable control structures like if, for, while, etc.
-        parser.settings().disable_all_assignment_ops(); // Disable assignment operators like =, +=, -=, etc.
+        settings.disable_all_control_structures(); // Disable control structures like if, for, while, etc.
+        settings.disable_all_assignment_ops(); // Disable assignment operators like =, +=, -=, etc.
 
         // Disabled for now, but can be enabled later for enhanced functionality
-        parser.settings().disable_all_logic_ops(); // Disable logical operators like &&, ||, !, etc.
-        parser.settings().disable_all_inequality_ops(); // Disable inequality operators like <, >, <=, >=, !=, etc.
+        settings.disable_all_logic_ops(); // Disable logical operators like &&, ||, !, etc.
+        settings.disable_all_inequality_ops(); // Disable inequality operators like <, >, <=, >=, !=, etc.
+    }
+
+    ExprtkEvaluator::~ExprtkEvaluator() = default;
 
-        if (!parser.compile(expressionText, expression))
+    bool ExprtkEvaluator::EvaluateBatch(const std::string& expressionText, const std::string& variable, const double* inputs, size_t count, double* results)
+    {
+        auto& compiled = m_state->Compile(expressionText, variable);
+        if (!compiled.valid)
+        {
+            std::fill(results, results + count, std::numeric_limits<double>::quiet_NaN());
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            compiled.input = inputs[i];
+            results[i] = compiled.expression.value();
+        }
+
+        return true;
+    }
+
+    std::wstring ExprtkEvaluator::Evaluate(const std::string& expressionText, NumberFormat format)
+    {
+        const auto& compiled = m_state->Compile(expressionText);
+        if (!compiled.valid)
             return L"NaN";
 
-        return ToWStringFullPrecision(expression.value());
+        return FormatNumber(compiled.expression.value(), format);
+    }
+
+    std::vector<std::wstring> ExprtkEvaluator::EvaluateBatch(const std::vector<std::string>& expressions, NumberFormat format)
+    {
+        std::vector<std::wstring> results;
+        results.reserve(expressions.size());
+        for (const auto& expressionText : expressions)
+        {
+            results.push_back(Evaluate(expressionText, format));
+        }
+
+        return results;
+    }
+
+    CompiledExpression& ExprtkEvaluator::State::Compile(const std::string& expressionText, const std::string& variable)
+    {
+        // Normalized text has no line breaks, so the variable can't run into the expression
+        std::string key = variable.empty() ? NormalizeExpression(expressionText) : variable + '\n' + NormalizeExpression(expressionText);
+        if (auto it = cache.find(key); it != cache.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            return *it->second;
+        }
+
+        if (lru.size() >= cacheCapacity)
+        {
+            cache.erase(lru.back().key);
+            lru.pop_back();
+        }
+
+        // Failures are cached too, the same incomplete input tends to come back while typing
+        auto& compiled = lru.emplace_front();
+        compiled.key = key;
+        if (variable.empty())
+        {
+            compiled.expression.register_symbol_table(symbolTable);
+            compiled.valid = parser.compile(key, compiled.expression);
+        }
+        else if (!symbolTable.symbol_exists(variable) && compiled.variables.emplace().add_variable(variable, compiled.input))
+        {
+            compiled.expression.register_symbol_table(*compiled.variables);
+            compiled.expression.register_symbol_table(symbolTable);
+            compiled.valid = parser.compile(key.substr(variable.size() + 1), compiled.expression);
+        }
+
+        cache.emplace(std::move(key), lru.begin());
+        return compiled;
     }
-}
\ No newline at end of file
+}
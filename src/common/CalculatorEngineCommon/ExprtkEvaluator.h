@@ -1,10 +1,46 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace ExprtkCalculator::internal
 {
-    std::wstring EvaluateExpression(
-        const std::string& expression,
-        const std::unordered_map<std::string, double>& constants);
-}
\ No newline at end of file
+    enum class NumberFormat
+    {
+        Fixed, // 0.000123, what the Command Palette parses
+        Scientific, // 1.23e-04
+    };
+
+    // Shortest text that parses back to the same value. Non-finite values are "NaN", "Infinity"
+    // and "-Infinity" whatever their sign or payload, the symbols .NET parses.
+    std::wstring FormatNumber(double value, NumberFormat format = NumberFormat::Fixed);
+
+    // Keeps a configured parser and symbol table alive between evaluations, and the most recently
+    // used compiled expressions, so typing into the calculator doesn't rebuild them on every key.
+    // Not thread safe.
+    class ExprtkEvaluator
+    {
+    public:
+        explicit ExprtkEvaluator(const std::unordered_map<std::string, double>& constants, size_t cacheCapacity = DefaultCacheCapacity);
+        ~ExprtkEvaluator();
+
+        ExprtkEvaluator(const ExprtkEvaluator&) = delete;
+        ExprtkEvaluator& operator=(const ExprtkEvaluator&) = delete;
+
+        std::wstring Evaluate(const std::string& expression, NumberFormat format = NumberFormat::Fixed);
+        std::vector<std::wstring> EvaluateBatch(const std::vector<std::string>& expressions, NumberFormat format = NumberFormat::Fixed);
+
+        // Compiles expression once with a free variable and evaluates it with the variable set to
+        // each of the count inputs in turn. When the expression doesn't compile, or the variable
+        // name is invalid or taken by a constant, every result is NaN and false is returned.
+        bool EvaluateBatch(const std::string& expression, const std::string& variable, const double* inputs, size_t count, double* results);
+
+        static constexpr size_t DefaultCacheCapacity = 64;
+
+    private:
+        struct State;
+
+        std::unique_ptr<State> m_state;
+    };
+}
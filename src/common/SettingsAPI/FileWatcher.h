@@ -12,15 +12,14 @@
 #include <wil/resource.h>
 #include <wil/filesystem.h>
 
+#include "SettingsFileCache.h"
+
+// Calls the callback when the contents of a JSON file change. The watchers of a process share
+// one folder change reader per folder and one parsed snapshot per file, see SettingsFileCache.
 class FileWatcher
 {
-    std::wstring m_path;
-    std::wstring m_file_name;
-    std::optional<FILETIME> m_lastWrite;
-    std::function<void()> m_callback;
-    wil::unique_folder_change_reader_nothrow m_folder_change_reader;
+    std::unique_ptr<SettingsFileCache::Subscription> m_subscription;
 
-    std::optional<FILETIME> MyFileTime();
 public:
     FileWatcher(const std::wstring& path, std::function<void()> callback);
     ~FileWatcher();
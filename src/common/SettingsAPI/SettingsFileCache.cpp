@@ -0,0 +1,327 @@
+#include "pch.h"
+#include "SettingsFileCache.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include <wil/filesystem.h>
+#include <wil/resource.h>
+
+#include <utils/winapi_error.h>
+
+namespace
+{
+    std::wstring to_key(std::wstring path)
+    {
+        std::transform(path.begin(), path.end(), path.begin(), ::towlower);
+        std::replace(path.begin(), path.end(), L'/', L'\\');
+        return path;
+    }
+
+    struct FileStamp
+    {
+        uint64_t lastWrite = 0;
+        uint64_t size = 0;
+    };
+
+    std::optional<FileStamp> file_stamp(const std::wstring& path)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        {
+            return std::nullopt;
+        }
+
+        return FileStamp{
+            (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime,
+            (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow
+        };
+    }
+
+    std::optional<std::string> read_file(const std::wstring& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return std::nullopt;
+        }
+
+        using isbi = std::istreambuf_iterator<char>;
+        return std::string{ isbi{ file }, isbi{} };
+    }
+}
+
+struct SettingsFileCache::Watcher
+{
+    wil::unique_folder_change_reader_nothrow reader;
+    size_t subscriptions = 0;
+};
+
+struct SettingsFileCache::Timer
+{
+    TP_CALLBACK_ENVIRON environment{};
+    PTP_TIMER timer = nullptr;
+};
+
+SettingsFileCache::Subscription::Subscription(SettingsFileCache& cache, std::wstring path, uint64_t id) :
+    m_cache(cache),
+    m_path(std::move(path)),
+    m_id(id)
+{
+}
+
+SettingsFileCache::Subscription::~Subscription()
+{
+    m_cache.unsubscribe(m_path, m_id);
+}
+
+SettingsFileCache& SettingsFileCache::instance()
+{
+    // Never destroyed: module singletons drop their subscriptions from their own static destructors
+    static SettingsFileCache* cache = new SettingsFileCache();
+    return *cache;
+}
+
+SettingsFileCache::SettingsFileCache() :
+    m_timer(std::make_unique<Timer>())
+{
+    // Keeps the module loaded while a callback runs, the timer is canceled with the last subscription
+    HMODULE module{};
+    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCWSTR>(&SettingsFileCache::instance), &module);
+    InitializeThreadpoolEnvironment(&m_timer->environment);
+    SetThreadpoolCallbackLibrary(&m_timer->environment, module);
+    m_timer->timer = CreateThreadpoolTimer([](PTP_CALLBACK_INSTANCE, PVOID context, PTP_TIMER) { static_cast<SettingsFileCache*>(context)->on_timer(); }, this, &m_timer->environment);
+    if (!m_timer->timer)
+    {
+        Logger::error(L"Failed to create the settings file timer. {}", get_last_error_or_default(GetLastError()));
+    }
+}
+
+SettingsFileCache::~SettingsFileCache() = default;
+
+SettingsFileSnapshotPtr SettingsFileCache::get(const std::wstring& path)
+{
+    return reload(to_key(path), path, true);
+}
+
+std::unique_ptr<SettingsFileCache::Subscription> SettingsFileCache::subscribe(const std::wstring& path, Callback callback)
+{
+    const std::wstring key = to_key(path);
+
+    // The current contents are the baseline, the first change is reported
+    reload(key, path, true);
+
+    std::lock_guard lock(m_mutex);
+    const uint64_t id = m_nextSubscriptionId++;
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->callback = std::move(callback);
+    m_entries[key].subscribers.emplace(id, std::move(subscriber));
+
+    const std::wstring folder = watched_folder(key);
+    auto& watcher = m_watchers[folder];
+    if (!watcher)
+    {
+        watcher = std::make_unique<Watcher>();
+        watcher->reader = wil::make_folder_change_reader_nothrow(
+            folder.c_str(),
+            false,
+            wil::FolderChangeEvents::LastWriteTime | wil::FolderChangeEvents::FileName,
+            [this, folder](wil::FolderChangeEvent event, PCWSTR fileName) {
+                on_folder_change(folder, event == wil::FolderChangeEvent::ChangesLost ? L"" : fileName);
+            });
+
+        if (!watcher->reader)
+        {
+            Logger::error(L"Failed to start folder change reader for path {}. {}", folder, get_last_error_or_default(GetLastError()));
+        }
+    }
+    watcher->subscriptions++;
+
+    return std::unique_ptr<Subscription>(new Subscription(*this, key, id));
+}
+
+SettingsFileSnapshotPtr SettingsFileCache::reload(const std::wstring& key, const std::wstring& path, bool checkStamp)
+{
+    const auto stamp = file_stamp(path);
+    if (checkStamp && stamp.has_value())
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_entries.find(key); it != m_entries.end() && it->second.snapshot && it->second.lastWrite == stamp->lastWrite && it->second.size == stamp->size)
+        {
+            return it->second.snapshot;
+        }
+    }
+
+    SettingsFileSnapshotPtr snapshot;
+    auto text = stamp.has_value() ? read_file(path) : std::nullopt;
+    if (text.has_value())
+    {
+        const size_t hash = std::hash<std::string>{}(text.value());
+        {
+            std::lock_guard lock(m_mutex);
+            auto& entry = m_entries[key];
+            if (entry.snapshot && entry.snapshot->hash == hash && entry.snapshot->text == text.value())
+            {
+                entry.lastWrite = stamp->lastWrite;
+                entry.size = stamp->size;
+                return entry.snapshot;
+            }
+        }
+
+        try
+        {
+            auto json = json::JsonValue::Parse(winrt::to_hstring(text.value())).GetObjectW();
+            snapshot = std::make_shared<const SettingsFileSnapshot>(SettingsFileSnapshot{ std::move(text.value()), hash, json });
+        }
+        catch (...)
+        {
+            // Not valid JSON, or only partially written yet
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto& entry = m_entries[key];
+    entry.snapshot = snapshot;
+    entry.lastWrite = stamp.has_value() ? stamp->lastWrite : 0;
+    entry.size = stamp.has_value() ? stamp->size : 0;
+    return snapshot;
+}
+
+void SettingsFileCache::unsubscribe(const std::wstring& path, uint64_t id)
+{
+    std::unique_ptr<Watcher> stoppedWatcher;
+    std::shared_ptr<Subscriber> subscriber;
+    {
+        std::lock_guard lock(m_mutex);
+        if (auto it = m_entries.find(path); it != m_entries.end())
+        {
+            if (auto subscriberIt = it->second.subscribers.find(id); subscriberIt != it->second.subscribers.end())
+            {
+                subscriber = std::move(subscriberIt->second);
+                it->second.subscribers.erase(subscriberIt);
+            }
+        }
+
+        if (auto it = m_watchers.find(watched_folder(path)); it != m_watchers.end() && --it->second->subscriptions == 0)
+        {
+            stoppedWatcher = std::move(it->second);
+            m_watchers.erase(it);
+        }
+
+        if (m_watchers.empty())
+        {
+            m_pending.clear();
+            if (m_timer->timer)
+            {
+                SetThreadpoolTimer(m_timer->timer, nullptr, 0, 0);
+            }
+        }
+    }
+
+    // Wait for the callback of this subscription, unless it's the one unsubscribing. The timer
+    // may have copied the subscriber before it was removed, it's skipped once inactive.
+    if (subscriber)
+    {
+        std::lock_guard subscriberLock(subscriber->mutex);
+        subscriber->active = false;
+    }
+
+    // Waits for the reader callbacks, so it must not hold m_mutex
+    stoppedWatcher.reset();
+}
+
+void SettingsFileCache::on_folder_change(const std::wstring& folder, const std::wstring& fileName)
+{
+    std::lock_guard lock(m_mutex);
+    if (!m_timer->timer)
+    {
+        return;
+    }
+
+    if (fileName.empty())
+    {
+        // The reader's buffer overflowed, any file of the folder may have changed. Files that
+        // didn't are read again but have the same hash, so nobody gets notified for them.
+        for (const auto& [key, entry] : m_entries)
+        {
+            if (!entry.subscribers.empty() && watched_folder(key) == folder)
+            {
+                m_pending.insert(key);
+            }
+        }
+    }
+    else
+    {
+        const std::wstring key = folder + L"\\" + to_key(fileName);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end() || it->second.subscribers.empty())
+        {
+            return;
+        }
+        m_pending.insert(key);
+    }
+
+    // Every change restarts the timer, so a save that writes in several steps is read once
+    ULARGE_INTEGER dueTime;
+    dueTime.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(debounce_ms) * 10000);
+    FILETIME due{ dueTime.LowPart, dueTime.HighPart };
+    SetThreadpoolTimer(m_timer->timer, &due, 0, 0);
+}
+
+void SettingsFileCache::on_timer()
+{
+    std::unordered_set<std::wstring> pending;
+    {
+        std::lock_guard lock(m_mutex);
+        pending.swap(m_pending);
+    }
+
+    std::lock_guard timerLock(m_timerMutex);
+    for (const auto& key : pending)
+    {
+        SettingsFileSnapshotPtr previous;
+        {
+            std::lock_guard lock(m_mutex);
+            previous = m_entries[key].snapshot;
+        }
+
+        auto snapshot = reload(key, key, false);
+        if (!snapshot || snapshot == previous)
+        {
+            continue;
+        }
+
+        std::vector<std::shared_ptr<Subscriber>> subscribers;
+        {
+            std::lock_guard lock(m_mutex);
+            for (const auto& [id, subscriber] : m_entries[key].subscribers)
+            {
+                subscribers.push_back(subscriber);
+            }
+        }
+
+        for (const auto& subscriber : subscribers)
+        {
+            std::lock_guard subscriberLock(subscriber->mutex);
+            if (!subscriber->active)
+            {
+                continue;
+            }
+
+            try
+            {
+                subscriber->callback(snapshot);
+            }
+            catch (...)
+            {
+                Logger::error(L"Settings file subscriber failed for {}", key);
+            }
+        }
+    }
+}
+
+std::wstring SettingsFileCache::watched_folder(const std::wstring& path)
+{
+    return std::filesystem::path(path).parent_path().wstring();
+}
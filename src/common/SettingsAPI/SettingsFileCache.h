@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../utils/json.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Parsed contents of a settings file, shared by everyone who reads the file until it changes.
+// Treat json as read-only, parse text for a copy that can be modified.
+struct SettingsFileSnapshot
+{
+    std::string text;
+    size_t hash = 0;
+    json::JsonObject json;
+};
+
+using SettingsFileSnapshotPtr = std::shared_ptr<const SettingsFileSnapshot>;
+
+// Settings files of the process, parsed once per change. Every folder with a subscribed file
+// has a folder change reader of its own, not a recursive one, so log files written under the
+// settings folder don't wake it up. Changes are debounced and only reported when the contents
+// hash differs from the last snapshot.
+class SettingsFileCache
+{
+public:
+    using Callback = std::function<void(const SettingsFileSnapshotPtr&)>;
+
+    class Subscription
+    {
+    public:
+        ~Subscription();
+        Subscription(const Subscription&) = delete;
+        Subscription& operator=(const Subscription&) = delete;
+
+    private:
+        friend class SettingsFileCache;
+        Subscription(SettingsFileCache& cache, std::wstring path, uint64_t id);
+
+        SettingsFileCache& m_cache;
+        std::wstring m_path;
+        uint64_t m_id;
+    };
+
+    static SettingsFileCache& instance();
+
+    // Snapshot of the file, nullptr if it's missing or not valid JSON. The file is only read
+    // again when its size or last write time changed, and only parsed when its contents did.
+    SettingsFileSnapshotPtr get(const std::wstring& path);
+
+    // Calls callback on a thread pool thread with the new snapshot whenever the contents of the
+    // file change, until the subscription is destroyed. Destroying it waits for its own callback
+    // if that is running on another thread, so the callback must not wait for whoever destroys
+    // the subscription. No lock of the cache is held while callbacks run.
+    [[nodiscard]] std::unique_ptr<Subscription> subscribe(const std::wstring& path, Callback callback);
+
+    // Time a file has to stay unchanged before subscribers are notified
+    static constexpr unsigned int debounce_ms = 100;
+
+private:
+    struct Subscriber
+    {
+        Callback callback;
+        // Held while the callback runs, unsubscribing takes it to wait for the callback
+        std::recursive_mutex mutex;
+        bool active = true;
+    };
+
+    struct Entry
+    {
+        SettingsFileSnapshotPtr snapshot;
+        uint64_t lastWrite = 0;
+        uint64_t size = 0;
+        std::unordered_map<uint64_t, std::shared_ptr<Subscriber>> subscribers;
+    };
+
+    struct Watcher;
+
+    SettingsFileCache();
+    ~SettingsFileCache();
+
+    SettingsFileSnapshotPtr reload(const std::wstring& key, const std::wstring& path, bool checkStamp);
+    void unsubscribe(const std::wstring& path, uint64_t id);
+    // An empty file name means the reader lost changes, every subscribed file of the folder is read again
+    void on_folder_change(const std::wstring& folder, const std::wstring& fileName);
+    void on_timer();
+    static std::wstring watched_folder(const std::wstring& path);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::wstring, Entry> m_entries;
+    std::unordered_map<std::wstring, std::unique_ptr<Watcher>> m_watchers;
+    std::unordered_set<std::wstring> m_pending;
+    uint64_t m_nextSubscriptionId = 1;
+
+    // Held by the timer callback only, so the notifications of a file arrive in order
+    std::mutex m_timerMutex;
+
+    struct Timer;
+    std::unique_ptr<Timer> m_timer;
+};
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "settings_objects.h"
 #include "settings_helpers.h"
+#include "SettingsFileCache.h"
 
 namespace PowerToysSettings
 {
@@ -302,7 +303,12 @@ namespace PowerToysSettings
     PowerToyValues PowerToyValues::load_from_settings_file(std::wstring_view powertoy_key)
     {
         PowerToyValues result = PowerToyValues();
-        result.m_json = PTSettingsHelper::load_module_settings(powertoy_key);
+        if (auto snapshot = SettingsFileCache::instance().get(PTSettingsHelper::get_module_save_file_location(powertoy_key)))
+        {
+            // Modules that read the same file share the parsed object until one of them modifies it
+            result.m_json = snapshot->json;
+            result.m_snapshot = std::move(snapshot);
+        }
         result._key = powertoy_key;
         return result;
     }
@@ -355,11 +361,18 @@ namespace PowerToysSettings
         {
             return std::nullopt;
         }
-        return m_json.GetNamedObject(L"properties").GetNamedObject(property_name).GetNamedObject(L"value");
+        auto value = m_json.GetNamedObject(L"properties").GetNamedObject(property_name).GetNamedObject(L"value");
+        if (m_snapshot)
+        {
+            // The caller may modify it
+            return json::JsonValue::Parse(value.Stringify()).GetObjectW();
+        }
+        return value;
     }
 
     json::JsonObject PowerToyValues::get_raw_json()
     {
+        detach();
         return m_json;
     }
 
@@ -377,6 +390,16 @@ namespace PowerToysSettings
 
     void PowerToyValues::set_version()
     {
+        detach();
         m_json.SetNamedValue(L"version", json::value(m_version));
     }
+
+    void PowerToyValues::detach()
+    {
+        if (m_snapshot)
+        {
+            m_json = json::JsonValue::Parse(winrt::to_hstring(m_snapshot->text)).GetObjectW();
+            m_snapshot.reset();
+        }
+    }
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "../utils/json.h"
 
 #include <cwctype>
+#include <memory>
+
+struct SettingsFileSnapshot;
 
 namespace PowerToysSettings
 {
@@ -76,6 +79,7 @@ namespace PowerToysSettings
         template<typename T>
         inline void add_property(std::wstring_view name, T value)
         {
+            detach();
             json::JsonObject prop_value;
             prop_value.SetNamedValue(L"value", json::value(value));
             m_json.GetNamedObject(L"properties").SetNamedValue(name, prop_value);
@@ -94,7 +98,10 @@ namespace PowerToysSettings
     private:
         const std::wstring m_version = L"1.0";
         void set_version();
+        void detach();
         json::JsonObject m_json;
+        // Set while m_json is the shared snapshot of the settings file, modifying it detaches first
+        std::shared_ptr<const SettingsFileSnapshot> m_snapshot;
         std::wstring _key;
         PowerToyValues() {}
     };
@@ -0,0 +1,221 @@
+#include "pch.h"
+
+#include <common/logger/async_log_sink.h>
+#include <common/logger/logger.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Both the test framework and PowerToys have a Logger
+using TestLogger = Microsoft::VisualStudio::CppUnitTestFramework::Logger;
+
+namespace UnitTestsAsyncLogSink
+{
+    // Keeps the payload of every record, optionally holding the writer until released
+    class CollectingSink : public spdlog::sinks::base_sink<std::mutex>
+    {
+    public:
+        std::vector<std::string> payloads;
+        std::atomic<bool> gateOpen{ true };
+
+        void open_gate()
+        {
+            gateOpen = true;
+            gateOpen.notify_all();
+        }
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override
+        {
+            gateOpen.wait(false);
+            payloads.emplace_back(msg.payload.data(), msg.payload.size());
+        }
+
+        void flush_() override
+        {
+        }
+    };
+
+    // Calls back into the async sink from the flush thread, like a crash handler that flushes the log
+    class ReentrantSink : public spdlog::sinks::base_sink<std::mutex>
+    {
+    public:
+        AsyncLogSink* owner = nullptr;
+        std::vector<std::string> payloads;
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override
+        {
+            payloads.emplace_back(msg.payload.data(), msg.payload.size());
+            if (payloads.back() != "nested")
+            {
+                owner->drain();
+                owner->log(spdlog::details::log_msg(spdlog::source_loc{}, "test", spdlog::level::info, "nested"));
+            }
+        }
+
+        void flush_() override
+        {
+        }
+    };
+
+    TEST_CLASS (AsyncLogSinkTests)
+    {
+        static spdlog::details::log_msg make_message(const std::string& text)
+        {
+            return spdlog::details::log_msg(spdlog::source_loc{}, "test", spdlog::level::info, text);
+        }
+
+        // Average and 99th percentile of the time a Logger::info call takes, in microseconds
+        static std::pair<double, double> MeasureLoggerLatency(LoggerMode mode, const std::filesystem::path& logFile)
+        {
+            constexpr int calls = 20000;
+            ::Logger::init({ std::make_shared<spdlog::sinks::basic_file_sink_mt>(logFile.native(), true) }, mode);
+
+            std::vector<double> latencies;
+            latencies.reserve(calls);
+            for (int i = 0; i < calls; i++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                ::Logger::info(L"Hook event {} at {}, {}", i, 120, 340);
+                const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+                latencies.push_back(elapsed.count());
+
+                // Log at a hook-like pace, so the async ring isn't just measuring overflow
+                if (i % 256 == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            ::Logger::flush();
+            ::Logger::init({ std::make_shared<spdlog::sinks::null_sink_mt>() });
+
+            double total = 0;
+            for (double latency : latencies)
+            {
+                total += latency;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            return { total / calls, latencies[calls * 99 / 100] };
+        }
+
+    public:
+        TEST_METHOD (WritesRecordsInOrder)
+        {
+            auto collector = std::make_shared<CollectingSink>();
+            AsyncLogSink sink("test", { collector });
+            for (int i = 0; i < 1000; i++)
+            {
+                sink.log(make_message(std::to_string(i)));
+            }
+            sink.drain();
+
+            Assert::AreEqual(size_t{ 1000 }, collector->payloads.size());
+            for (int i = 0; i < 1000; i++)
+            {
+                Assert::AreEqual(std::to_string(i), collector->payloads[i]);
+            }
+        }
+
+        TEST_METHOD (KeepsMessagesLongerThanTheReservedRecord)
+        {
+            auto collector = std::make_shared<CollectingSink>();
+            AsyncLogSink sink("test", { collector });
+            const std::string longMessage(4096, 'x');
+            sink.log(make_message(longMessage));
+            sink.drain();
+
+            Assert::AreEqual(size_t{ 1 }, collector->payloads.size());
+            Assert::AreEqual(longMessage, collector->payloads[0]);
+        }
+
+        TEST_METHOD (DropsAndCountsRecordsWhenFull)
+        {
+            auto collector = std::make_shared<CollectingSink>();
+            collector->gateOpen = false;
+            AsyncLogSink sink("test", { collector }, AsyncLogSink::OverflowPolicy::DropNewest, 4);
+            for (int i = 0; i < 100; i++)
+            {
+                sink.log(make_message("message"));
+            }
+
+            collector->open_gate();
+            sink.drain();
+
+            const auto written = std::count(collector->payloads.begin(), collector->payloads.end(), "message");
+            Assert::IsTrue(sink.dropped_count() > 0);
+            Assert::AreEqual(uint64_t{ 100 }, static_cast<uint64_t>(written) + sink.dropped_count());
+            Assert::AreEqual(std::to_string(sink.dropped_count()) + " log messages were dropped because the log queue was full", collector->payloads.back());
+        }
+
+        TEST_METHOD (BlockPolicyKeepsEveryRecord)
+        {
+            auto collector = std::make_shared<CollectingSink>();
+            AsyncLogSink sink("test", { collector }, AsyncLogSink::OverflowPolicy::Block, 4);
+            std::vector<std::thread> threads;
+            for (int producer = 0; producer < 4; producer++)
+            {
+                threads.emplace_back([&sink] {
+                    for (int i = 0; i < 10000; i++)
+                    {
+                        sink.log(make_message("message"));
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            sink.drain();
+
+            Assert::AreEqual(size_t{ 40000 }, collector->payloads.size());
+            Assert::AreEqual(uint64_t{ 0 }, sink.dropped_count());
+        }
+
+        TEST_METHOD (FlushThreadDoesNotWaitForItself)
+        {
+            auto reentrant = std::make_shared<ReentrantSink>();
+            {
+                AsyncLogSink sink("test", { reentrant }, AsyncLogSink::OverflowPolicy::Block, 2);
+                reentrant->owner = &sink;
+                for (int i = 0; i < 100; i++)
+                {
+                    sink.log(make_message("message " + std::to_string(i)));
+                }
+                sink.drain();
+            }
+
+            // The nested records fill the ring too, the flush thread drops them instead of blocking
+            std::vector<std::string> messages;
+            std::copy_if(reentrant->payloads.begin(), reentrant->payloads.end(), std::back_inserter(messages), [](const std::string& payload) {
+                return payload.starts_with("message ");
+            });
+            Assert::AreEqual(size_t{ 100 }, messages.size());
+            for (int i = 0; i < 100; i++)
+            {
+                Assert::AreEqual("message " + std::to_string(i), messages[i]);
+            }
+        }
+
+        TEST_METHOD (LoggerLatencySyncVsAsync)
+        {
+            const auto logFile = std::filesystem::temp_directory_path() / "powertoys-async-log-sink-test.log";
+            const auto [syncAverage, syncP99] = MeasureLoggerLatency(LoggerMode::Synchronous, logFile);
+            const auto [asyncAverage, asyncP99] = MeasureLoggerLatency(LoggerMode::Asynchronous, logFile);
+            std::filesystem::remove(logFile);
+
+            TestLogger::WriteMessage(std::format(L"sync: {:.2f} us average, {:.2f} us p99\n", syncAverage, syncP99).c_str());
+            TestLogger::WriteMessage(std::format(L"async: {:.2f} us average, {:.2f} us p99\n", asyncAverage, asyncP99).c_str());
+        }
+    };
+}
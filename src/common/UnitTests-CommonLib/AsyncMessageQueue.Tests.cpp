@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include <common/interop/async_message_queue.h>
+
+#include <chrono>
+#include <format>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsAsyncMessageQueue
+{
+    TEST_CLASS (AsyncMessageQueueTests)
+    {
+        // Pushes producers * messagesPerProducer messages "<producer>:<index>" and checks every
+        // message is popped exactly once, in order for each producer. Producers retry a message
+        // the full queue dropped. Returns messages/s.
+        static double RunProducers(size_t capacity, int producers, int messagesPerProducer)
+        {
+            AsyncMessageQueue queue(capacity);
+            const auto start = std::chrono::steady_clock::now();
+
+            std::vector<std::thread> threads;
+            for (int producer = 0; producer < producers; producer++)
+            {
+                threads.emplace_back([&queue, producer, messagesPerProducer] {
+                    for (int i = 0; i < messagesPerProducer; i++)
+                    {
+                        const auto message = std::to_wstring(producer) + L":" + std::to_wstring(i);
+                        while (!queue.queue_message(message))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+
+            std::vector<int> lastIndex(producers, -1);
+            int received = 0;
+            while (received < producers * messagesPerProducer)
+            {
+                for (const auto& message : queue.pop_messages())
+                {
+                    const auto separator = message.find(L':');
+                    const int producer = std::stoi(message.substr(0, separator));
+                    const int index = std::stoi(message.substr(separator + 1));
+                    Assert::AreEqual(lastIndex[producer] + 1, index);
+                    lastIndex[producer] = index;
+                    received++;
+                }
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return received / elapsed.count();
+        }
+
+    public:
+        TEST_METHOD (PopReturnsMessagesInOrder)
+        {
+            AsyncMessageQueue queue;
+            queue.queue_message(L"first");
+            queue.queue_message(L"second");
+            queue.queue_message(L"third");
+
+            Assert::AreEqual(std::wstring(L"first"), queue.pop_message());
+            auto rest = queue.pop_messages();
+            Assert::AreEqual(size_t{ 2 }, rest.size());
+            Assert::AreEqual(std::wstring(L"second"), rest[0]);
+            Assert::AreEqual(std::wstring(L"third"), rest[1]);
+        }
+
+        TEST_METHOD (InterruptWakesUpWaitingConsumer)
+        {
+            AsyncMessageQueue queue;
+            std::vector<std::wstring> messages{ L"not popped" };
+            std::thread consumer([&queue, &messages] {
+                messages = queue.pop_messages();
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            queue.interrupt();
+            consumer.join();
+            Assert::IsTrue(messages.empty());
+            Assert::AreEqual(std::wstring(L""), queue.pop_message());
+        }
+
+        TEST_METHOD (FullQueueDropsNewMessages)
+        {
+            AsyncMessageQueue queue(2);
+            Assert::IsTrue(queue.queue_message(L"a"));
+            Assert::IsTrue(queue.queue_message(L"b"));
+            Assert::IsFalse(queue.queue_message(L"c"));
+            Assert::IsFalse(queue.queue_message(L"d"));
+            Assert::AreEqual(uint64_t{ 2 }, queue.dropped_messages());
+
+            // The messages that fit come out in order, and popping makes room again
+            auto messages = queue.pop_messages();
+            Assert::AreEqual(size_t{ 2 }, messages.size());
+            Assert::AreEqual(std::wstring(L"a"), messages[0]);
+            Assert::AreEqual(std::wstring(L"b"), messages[1]);
+
+            Assert::IsTrue(queue.queue_message(L"e"));
+            Assert::AreEqual(std::wstring(L"e"), queue.pop_message());
+            Assert::AreEqual(uint64_t{ 2 }, queue.dropped_messages());
+        }
+
+        TEST_METHOD (InterruptDropsNewMessages)
+        {
+            AsyncMessageQueue queue(2);
+            queue.interrupt();
+            Assert::IsFalse(queue.queue_message(L"a"));
+            Assert::IsTrue(queue.pop_messages().empty());
+        }
+
+        TEST_METHOD (StressManyProducers)
+        {
+            // A tiny queue keeps producers running into a full ring all the time.
+            RunProducers(2, 8, 20000);
+            RunProducers(16, 8, 20000);
+        }
+
+        TEST_METHOD (Throughput)
+        {
+            for (int producers : { 1, 2, 4, 8 })
+            {
+                const double messagesPerSecond = RunProducers(1024, producers, 100000);
+                Logger::WriteMessage(std::format(L"{} producers: {:.0f} messages/s\n", producers, messagesPerSecond).c_str());
+            }
+        }
+    };
+}
@@ -0,0 +1,95 @@
+#include "pch.h"
+
+#include <common/utils/gpo.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsGpo
+{
+    TEST_CLASS (GpoTests)
+    {
+        static std::vector<std::wstring> PolicyNames()
+        {
+            return {
+                powertoys_gpo::POLICY_CONFIGURE_ENABLED_GLOBAL_ALL_UTILITIES,
+                powertoys_gpo::POLICY_CONFIGURE_ENABLED_ALWAYS_ON_TOP,
+                powertoys_gpo::POLICY_CONFIGURE_ENABLED_FANCYZONES,
+                powertoys_gpo::POLICY_CONFIGURE_ENABLED_KEYBOARD_MANAGER,
+                powertoys_gpo::POLICY_CONFIGURE_ENABLED_POWER_LAUNCHER,
+                powertoys_gpo::POLICY_MWB_ALLOW_SERVICE_MODE,
+                L"NotAPowerToysPolicy",
+            };
+        }
+
+    public:
+        TEST_METHOD (SnapshotMatchesRegistry)
+        {
+            for (const auto& name : PolicyNames())
+            {
+                Assert::AreEqual(static_cast<int>(powertoys_gpo::readConfiguredValue(name)), static_cast<int>(powertoys_gpo::getConfiguredValue(name)), name.c_str());
+            }
+        }
+
+        TEST_METHOD (SnapshotIgnoresNameCase)
+        {
+            Assert::AreEqual(static_cast<int>(powertoys_gpo::getConfiguredValue(powertoys_gpo::POLICY_CONFIGURE_ENABLED_FANCYZONES)),
+                             static_cast<int>(powertoys_gpo::getConfiguredValue(L"configureenabledutilityfancyzones")));
+        }
+
+        TEST_METHOD (SnapshotIsReusedUntilPoliciesChange)
+        {
+            const auto first = powertoys_gpo::details::policySnapshot();
+            Assert::IsNotNull(first, L"The policy keys can't be watched on this machine");
+
+            for (const auto& name : PolicyNames())
+            {
+                powertoys_gpo::getConfiguredValue(name);
+            }
+
+            // Lookups don't read the registry again, they all go to the same snapshot
+            Assert::IsTrue(first == powertoys_gpo::details::policySnapshot());
+        }
+
+        TEST_METHOD (SnapshotFollowsRegistryChanges)
+        {
+            // A PowerToys policy key of its own under HKCU\SOFTWARE, which needs no elevation to write
+            const std::wstring test_root = L"SOFTWARE\\PowerToysGpoTests";
+            const std::wstring policies_path = test_root + L"\\PowerToys";
+            const std::wstring policy_name = L"TestPolicy";
+            RegDeleteTreeW(HKEY_CURRENT_USER, test_root.c_str());
+            HKEY key{};
+            Assert::AreEqual(ERROR_SUCCESS, RegCreateKeyExW(HKEY_CURRENT_USER, policies_path.c_str(), 0, nullptr, 0, KEY_WRITE, nullptr, &key, nullptr));
+
+            powertoys_gpo::details::PolicyWatcher watcher(L"SOFTWARE", policies_path);
+            const auto before = watcher.snapshot();
+            Assert::IsNotNull(before, L"The test keys can't be watched on this machine");
+            Assert::AreEqual(static_cast<int>(powertoys_gpo::gpo_rule_configured_not_configured), static_cast<int>(before->lookup(policy_name)));
+
+            const DWORD enabled = 1;
+            RegSetValueExW(key, policy_name.c_str(), 0, REG_DWORD, reinterpret_cast<const BYTE*>(&enabled), sizeof(enabled));
+            RegCloseKey(key);
+
+            auto after = watcher.snapshot();
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (after == before && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                after = watcher.snapshot();
+            }
+
+            Assert::IsTrue(after != before, L"No new snapshot after the policy changed");
+            Assert::AreEqual(static_cast<int>(powertoys_gpo::gpo_rule_configured_enabled), static_cast<int>(after->lookup(policy_name)));
+
+            // The replaced snapshot stays valid for whoever still uses it
+            Assert::AreEqual(static_cast<int>(powertoys_gpo::gpo_rule_configured_not_configured), static_cast<int>(before->lookup(policy_name)));
+
+            watcher.stop();
+            Assert::IsNull(watcher.snapshot());
+            RegDeleteTreeW(HKEY_CURRENT_USER, test_root.c_str());
+        }
+    };
+}
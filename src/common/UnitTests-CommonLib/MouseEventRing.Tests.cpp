@@ -0,0 +1,112 @@
+#include "pch.h"
+
+#include <common/hooks/MouseEventRing.h>
+
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsMouseEventRing
+{
+    TEST_CLASS (MouseEventRingTests)
+    {
+        static LowlevelMouseEvent make_event(UINT message, LONG x, DWORD mouseData = 0)
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            return LowlevelMouseEvent{ .message = message, .pt = { x, 0 }, .mouseData = mouseData, .hookTimestamp = now.QuadPart };
+        }
+
+        static std::vector<LowlevelMouseEvent> drain(MouseEventRing& ring)
+        {
+            std::vector<LowlevelMouseEvent> events;
+            ring.Drain([&events](const LowlevelMouseEvent& event) { events.push_back(event); });
+            return events;
+        }
+
+    public:
+        TEST_METHOD (CoalescesConsecutiveMoves)
+        {
+            MouseEventRing ring;
+            ring.Push(make_event(WM_MOUSEMOVE, 1));
+            ring.Push(make_event(WM_MOUSEMOVE, 2));
+            ring.Push(make_event(WM_MOUSEMOVE, 3));
+
+            const auto events = drain(ring);
+
+            Assert::AreEqual(size_t{ 1 }, events.size());
+            Assert::AreEqual(static_cast<UINT>(WM_MOUSEMOVE), events[0].message);
+            Assert::AreEqual(3L, events[0].pt.x);
+            Assert::AreEqual(uint64_t{ 2 }, ring.Statistics().coalesced);
+            Assert::AreEqual(uint64_t{ 1 }, ring.Statistics().delivered);
+        }
+
+        TEST_METHOD (KeepsButtonEventsInOrder)
+        {
+            MouseEventRing ring;
+            ring.Push(make_event(WM_MOUSEMOVE, 1));
+            ring.Push(make_event(WM_MOUSEMOVE, 2));
+            ring.Push(make_event(WM_LBUTTONDOWN, 2));
+            ring.Push(make_event(WM_MOUSEMOVE, 3));
+            ring.Push(make_event(WM_MOUSEMOVE, 4));
+            ring.Push(make_event(WM_LBUTTONUP, 4));
+            ring.Push(make_event(WM_MOUSEMOVE, 5));
+
+            const auto events = drain(ring);
+
+            // The last move before each button event is kept, so buttons are reported where they happened
+            const std::vector<std::pair<UINT, LONG>> expected{
+                { WM_MOUSEMOVE, 2 },
+                { WM_LBUTTONDOWN, 2 },
+                { WM_MOUSEMOVE, 4 },
+                { WM_LBUTTONUP, 4 },
+                { WM_MOUSEMOVE, 5 },
+            };
+            Assert::AreEqual(expected.size(), events.size());
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                Assert::AreEqual(expected[i].first, events[i].message);
+                Assert::AreEqual(expected[i].second, events[i].pt.x);
+            }
+            Assert::AreEqual(uint64_t{ 2 }, ring.Statistics().coalesced);
+        }
+
+        TEST_METHOD (NotifiesOncePerDrain)
+        {
+            MouseEventRing ring;
+            Assert::IsTrue(ring.Push(make_event(WM_MOUSEMOVE, 1)));
+            Assert::IsFalse(ring.Push(make_event(WM_MOUSEMOVE, 2)));
+            Assert::IsFalse(ring.Push(make_event(WM_LBUTTONDOWN, 2)));
+
+            drain(ring);
+
+            Assert::IsTrue(ring.Push(make_event(WM_LBUTTONUP, 2)));
+        }
+
+        TEST_METHOD (DropsNewEventsWhenFull)
+        {
+            MouseEventRing ring;
+            constexpr DWORD overflow = 10;
+            for (DWORD i = 0; i < MouseEventRing::Capacity + overflow; i++)
+            {
+                ring.Push(make_event(WM_MOUSEWHEEL, 0, i));
+            }
+
+            const auto events = drain(ring);
+
+            // The events that fit are delivered in order, the newest ones are dropped
+            Assert::AreEqual(static_cast<size_t>(MouseEventRing::Capacity), events.size());
+            for (DWORD i = 0; i < MouseEventRing::Capacity; i++)
+            {
+                Assert::AreEqual(i, events[i].mouseData);
+            }
+            Assert::AreEqual(uint64_t{ overflow }, ring.Statistics().dropped);
+
+            // Draining makes room again
+            Assert::IsTrue(ring.Push(make_event(WM_MOUSEWHEEL, 0, 1234)));
+            const auto next = drain(ring);
+            Assert::AreEqual(size_t{ 1 }, next.size());
+            Assert::AreEqual(DWORD{ 1234 }, next[0].mouseData);
+        }
+    };
+}
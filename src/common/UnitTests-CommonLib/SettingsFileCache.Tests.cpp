@@ -0,0 +1,134 @@
+#include "pch.h"
+
+#include <common/SettingsAPI/SettingsFileCache.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsSettingsFileCache
+{
+    TEST_CLASS (SettingsFileCacheTests)
+    {
+        std::filesystem::path folder;
+        std::wstring file;
+
+        static void WriteFile(const std::wstring& path, const std::string& text)
+        {
+            std::ofstream{ path, std::ios::binary } << text;
+        }
+
+        // Waits up to a second for the counter to reach the expected value
+        static bool WaitFor(const std::atomic<int>& counter, int expected)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (counter < expected && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return counter >= expected;
+        }
+
+    public:
+        TEST_METHOD_INITIALIZE(CreateFolder)
+        {
+            folder = std::filesystem::temp_directory_path() / ("powertoys-settings-file-cache-test-" + std::to_string(GetCurrentProcessId()));
+            std::filesystem::create_directories(folder);
+            file = (folder / L"settings.json").wstring();
+        }
+
+        TEST_METHOD_CLEANUP(RemoveFolder)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(folder, error);
+        }
+
+        TEST_METHOD (GetReturnsSameSnapshotUntilFileChanges)
+        {
+            WriteFile(file, R"({"value":1})");
+            auto first = SettingsFileCache::instance().get(file);
+            auto second = SettingsFileCache::instance().get(file);
+            Assert::IsTrue(first != nullptr);
+            Assert::IsTrue(first == second);
+
+            WriteFile(file, R"({"value":22})");
+            auto changed = SettingsFileCache::instance().get(file);
+            Assert::IsTrue(changed != first);
+            Assert::AreEqual(22.0, changed->json.GetNamedNumber(L"value"));
+        }
+
+        TEST_METHOD (GetReturnsNullForMissingOrInvalidFile)
+        {
+            Assert::IsTrue(SettingsFileCache::instance().get(file) == nullptr);
+
+            WriteFile(file, "{ not json");
+            Assert::IsTrue(SettingsFileCache::instance().get(file) == nullptr);
+        }
+
+        TEST_METHOD (SubscriberIsNotifiedOncePerContentChange)
+        {
+            WriteFile(file, R"({"value":1})");
+            std::atomic<int> notifications = 0;
+            std::atomic<int> lastValue = 0;
+            auto subscription = SettingsFileCache::instance().subscribe(file, [&](const SettingsFileSnapshotPtr& snapshot) {
+                lastValue = static_cast<int>(snapshot->json.GetNamedNumber(L"value"));
+                notifications++;
+            });
+
+            WriteFile(file, R"({"value":2})");
+            Assert::IsTrue(WaitFor(notifications, 1));
+            Assert::AreEqual(2, lastValue.load());
+
+            // Same contents written again
+            WriteFile(file, R"({"value":2})");
+            std::this_thread::sleep_for(std::chrono::milliseconds(SettingsFileCache::debounce_ms * 4));
+            Assert::AreEqual(1, notifications.load());
+
+            subscription.reset();
+            WriteFile(file, R"({"value":3})");
+            std::this_thread::sleep_for(std::chrono::milliseconds(SettingsFileCache::debounce_ms * 4));
+            Assert::AreEqual(1, notifications.load());
+        }
+
+        TEST_METHOD (SubscribersShareOneSnapshot)
+        {
+            WriteFile(file, R"({"value":1})");
+            SettingsFileSnapshotPtr first;
+            SettingsFileSnapshotPtr second;
+            std::atomic<int> notifications = 0;
+            auto firstSubscription = SettingsFileCache::instance().subscribe(file, [&](const SettingsFileSnapshotPtr& snapshot) {
+                first = snapshot;
+                notifications++;
+            });
+            auto secondSubscription = SettingsFileCache::instance().subscribe(file, [&](const SettingsFileSnapshotPtr& snapshot) {
+                second = snapshot;
+                notifications++;
+            });
+
+            WriteFile(file, R"({"value":2})");
+            Assert::IsTrue(WaitFor(notifications, 2));
+            Assert::IsTrue(first == second);
+            Assert::IsTrue(first == SettingsFileCache::instance().get(file));
+        }
+
+        TEST_METHOD (CallbackCanWaitForAnotherThreadThatUnsubscribes)
+        {
+            WriteFile(file, R"({"value":1})");
+            auto other = SettingsFileCache::instance().subscribe(file, [](const SettingsFileSnapshotPtr&) {});
+            std::atomic<int> notifications = 0;
+            auto subscription = SettingsFileCache::instance().subscribe(file, [&](const SettingsFileSnapshotPtr&) {
+                // No cache lock is held here, so the other thread doesn't wait for this callback
+                std::thread([&other] { other.reset(); }).join();
+                notifications++;
+            });
+
+            WriteFile(file, R"({"value":2})");
+            Assert::IsTrue(WaitFor(notifications, 1));
+            Assert::IsTrue(other == nullptr);
+        }
+    };
+}
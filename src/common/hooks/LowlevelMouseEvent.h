@@ -0,0 +1,14 @@
+#pragma once
+#include <windows.h>
+
+struct LowlevelMouseEvent
+{
+    // WM_MOUSEMOVE, WM_LBUTTONDOWN, ...
+    UINT message;
+    POINT pt;
+    DWORD mouseData;
+    DWORD flags;
+    DWORD time;
+    // QueryPerformanceCounter value when the hook received the event.
+    LONGLONG hookTimestamp;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "LowlevelMouseEvent.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+struct MouseEventRingStatistics
+{
+    uint64_t delivered = 0;
+    uint64_t coalesced = 0;
+    uint64_t dropped = 0;
+    uint64_t totalLatencyUs = 0;
+    uint64_t maxLatencyUs = 0;
+};
+
+// Queue of mouse events from the low level mouse hook thread to one subscriber thread.
+// There is exactly one producer and one consumer, so no locks are needed. When the
+// queue is full, new events are dropped and counted, the hook never waits.
+class MouseEventRing
+{
+public:
+    static constexpr uint32_t Capacity = 256;
+
+    // Called on the hook thread. Returns true when the subscriber has to be notified,
+    // which happens once for any number of events pushed between two drains.
+    bool Push(const LowlevelMouseEvent& event) noexcept
+    {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_events[head % Capacity] = event;
+        m_head.store(head + 1, std::memory_order_release);
+        return !m_notified.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // Called on the subscriber thread. Consecutive moves are coalesced into the last
+    // one, so a subscriber that falls behind catches up with a single update.
+    template<typename Callback>
+    void Drain(Callback&& callback) noexcept
+    {
+        // Cleared first, so an event pushed while draining notifies again.
+        m_notified.store(false, std::memory_order_release);
+
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint32_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head)
+        {
+            return;
+        }
+
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        for (; tail != head; ++tail)
+        {
+            const LowlevelMouseEvent& event = m_events[tail % Capacity];
+            if (event.message == WM_MOUSEMOVE && tail + 1 != head && m_events[(tail + 1) % Capacity].message == WM_MOUSEMOVE)
+            {
+                m_coalesced.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            const uint64_t latencyUs = ToMicroseconds(now.QuadPart - event.hookTimestamp);
+            m_totalLatencyUs.fetch_add(latencyUs, std::memory_order_relaxed);
+            if (latencyUs > m_maxLatencyUs.load(std::memory_order_relaxed))
+            {
+                m_maxLatencyUs.store(latencyUs, std::memory_order_relaxed);
+            }
+            m_delivered.fetch_add(1, std::memory_order_relaxed);
+
+            callback(event);
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    MouseEventRingStatistics Statistics() const noexcept
+    {
+        return {
+            .delivered = m_delivered.load(std::memory_order_relaxed),
+            .coalesced = m_coalesced.load(std::memory_order_relaxed),
+            .dropped = m_dropped.load(std::memory_order_relaxed),
+            .totalLatencyUs = m_totalLatencyUs.load(std::memory_order_relaxed),
+            .maxLatencyUs = m_maxLatencyUs.load(std::memory_order_relaxed),
+        };
+    }
+
+private:
+    static uint64_t ToMicroseconds(LONGLONG ticks) noexcept
+    {
+        static const LONGLONG frequency = [] {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return f.QuadPart;
+        }();
+        return ticks > 0 ? static_cast<uint64_t>(ticks * 1'000'000 / frequency) : 0;
+    }
+
+    std::array<LowlevelMouseEvent, Capacity> m_events{};
+
+    // Written by the hook thread
+    alignas(64) std::atomic<uint32_t> m_head{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+
+    // Written by the subscriber thread
+    alignas(64) std::atomic<uint32_t> m_tail{ 0 };
+    std::atomic<uint64_t> m_delivered{ 0 };
+    std::atomic<uint64_t> m_coalesced{ 0 };
+    std::atomic<uint64_t> m_totalLatencyUs{ 0 };
+    std::atomic<uint64_t> m_maxLatencyUs{ 0 };
+
+    alignas(64) std::atomic<bool> m_notified{ false };
+};
@@ -1,54 +1,214 @@
 #pragma once
-#include <queue>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+// Lock-free ring queue with any number of producers and a single consumer.
+// Slots are claimed with a CAS on the enqueue position and published with a per-slot sequence
+// number, so producers don't take a lock and messages are moved in and out, never copied.
+// The ring is bounded and producers never wait: a message that doesn't fit is dropped and
+// counted, so a stuck consumer can't make the queue grow. The consumer sleeps on an eventcount
+// on top of std::atomic::wait when the queue is empty, producers only pay for a wake up when
+// it sleeps.
 class AsyncMessageQueue
 {
 private:
-    std::mutex queue_mutex;
-    std::queue<std::wstring> message_queue;
-    std::condition_variable message_ready;
-    bool interrupted = false;
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        std::wstring message;
+    };
+
+    static constexpr size_t default_capacity = 1024;
+
+    const size_t capacity_mask;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+    // Only touched by the consumer
+    alignas(64) size_t dequeue_position = 0;
+
+    // Bumped after every push, the consumer waits on it when the queue is empty
+    alignas(64) std::atomic<uint32_t> push_epoch{ 0 };
+    std::atomic<bool> consumer_waiting{ false };
+
+    // Messages that didn't fit in the ring
+    alignas(64) std::atomic<uint64_t> dropped{ 0 };
+
+    std::atomic<bool> interrupted{ false };
 
     //Disable copy
     AsyncMessageQueue(const AsyncMessageQueue&);
     AsyncMessageQueue& operator=(const AsyncMessageQueue&);
 
-public:
-    AsyncMessageQueue()
+    bool try_push(std::wstring& message)
     {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot& slot = slots[position & capacity_mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.message = std::move(message);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The consumer hasn't freed this slot yet, the queue is full.
+                return false;
+            }
+            else
+            {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
     }
-    void queue_message(std::wstring message)
+
+    bool try_pop(std::wstring& message)
     {
-        this->queue_mutex.lock();
-        this->message_queue.push(message);
-        this->queue_mutex.unlock();
-        this->message_ready.notify_one();
+        Slot& slot = slots[dequeue_position & capacity_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1)
+        {
+            return false;
+        }
+
+        message = std::move(slot.message);
+        slot.sequence.store(dequeue_position + capacity_mask + 1, std::memory_order_release);
+        ++dequeue_position;
+        return true;
     }
-    std::wstring pop_message()
+
+    void notify_consumer()
     {
-        std::unique_lock<std::mutex> lock(this->queue_mutex);
-        while (message_queue.empty() && !this->interrupted)
+        push_epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (consumer_waiting.load(std::memory_order_seq_cst))
         {
-            this->message_ready.wait(lock);
+            push_epoch.notify_one();
+        }
+    }
+
+    // Blocks until a message is available. Returns false if the queue was interrupted.
+    bool wait_pop(std::wstring& message)
+    {
+        for (;;)
+        {
+            if (interrupted.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (try_pop(message))
+            {
+                return true;
+            }
+
+            // Announce the wait, then check again: a producer that pushed in between either
+            // sees the announcement and wakes us up, or bumped the epoch before we read it.
+            const uint32_t epoch = push_epoch.load(std::memory_order_seq_cst);
+            consumer_waiting.store(true, std::memory_order_seq_cst);
+            if (!interrupted.load(std::memory_order_seq_cst) && try_pop(message))
+            {
+                consumer_waiting.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            if (!interrupted.load(std::memory_order_seq_cst))
+            {
+                push_epoch.wait(epoch, std::memory_order_seq_cst);
+            }
+            consumer_waiting.store(false, std::memory_order_relaxed);
         }
-        if (this->interrupted)
+    }
+
+public:
+    // capacity is rounded up to a power of two
+    explicit AsyncMessageQueue(size_t capacity = default_capacity) :
+        capacity_mask(round_up_to_power_of_two(capacity) - 1),
+        slots(std::make_unique<Slot[]>(capacity_mask + 1))
+    {
+        for (size_t i = 0; i <= capacity_mask; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Safe to call from any number of threads, never blocks on the consumer. Returns false if
+    // the message was dropped, because the ring is full or the queue is interrupted.
+    bool queue_message(std::wstring message)
+    {
+        if (interrupted.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        if (!try_push(message))
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        notify_consumer();
+        return true;
+    }
+
+    // How many messages were dropped because the ring was full
+    uint64_t dropped_messages() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Only one thread may pop.
+    std::wstring pop_message()
+    {
+        std::wstring message;
+        if (!wait_pop(message))
         {
             //Just returns a empty string if the queue was interrupted.
             return std::wstring(L"");
         }
-        std::wstring message = this->message_queue.front();
-        this->message_queue.pop();
         return message;
     }
+
+    // Waits for at least one message, then takes all the queued messages at once, in order.
+    // Returns no messages if the queue was interrupted. Only one thread may pop.
+    std::vector<std::wstring> pop_messages()
+    {
+        std::vector<std::wstring> messages;
+        std::wstring message;
+        if (!wait_pop(message))
+        {
+            return messages;
+        }
+
+        messages.push_back(std::move(message));
+        while (try_pop(message))
+        {
+            messages.push_back(std::move(message));
+        }
+        return messages;
+    }
+
+    // Wakes up the consumer. After this, pops return nothing and new messages are dropped.
     void interrupt()
     {
-        this->queue_mutex.lock();
-        this->interrupted = true;
-        this->queue_mutex.unlock();
-        this->message_ready.notify_all();
+        interrupted.store(true, std::memory_order_seq_cst);
+        push_epoch.fetch_add(1, std::memory_order_seq_cst);
+        push_epoch.notify_all();
+    }
+
+private:
+    static size_t round_up_to_power_of_two(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
     }
 };
@@ -3,6 +3,10 @@
 // See the LICENSE file in the project root for more information.
 
 using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Linq;
 using System.Threading;
 
 using Microsoft.VisualStudio.TestTools.UnitTesting;
@@ -61,6 +65,58 @@ namespace Microsoft.Interop.Tests
             }
         }
 
+        [TestMethod]
+        public void TestSendManyMessages()
+        {
+            const int messageCount = 10000;
+            var payload = new string('x', 2048);
+            var received = new List<string>(messageCount);
+            var latencies = new List<double>(messageCount);
+            var stopwatch = Stopwatch.StartNew();
+            using (var reset = new AutoResetEvent(false))
+            {
+                using (var serverPipe = new TwoWayPipeMessageIPCManaged(
+                    ServerSidePipe,
+                    ClientSidePipe,
+                    (string msg) =>
+                    {
+                        // Messages are "<index>|<send time in ticks>|<payload>"
+                        var parts = msg.Split('|', 3);
+                        received.Add(parts[0]);
+                        latencies.Add((stopwatch.ElapsedTicks - long.Parse(parts[1], CultureInfo.InvariantCulture)) * 1000.0 / Stopwatch.Frequency);
+                        Assert.AreEqual(payload, parts[2]);
+                        if (received.Count == messageCount)
+                        {
+                            reset.Set();
+                        }
+                    }))
+                {
+                    serverPipe.Start();
+                    ClientPipe.Start();
+
+                    // Test can be flaky as the pipes are still being set up and we end up receiving no message. Wait for a bit to avoid that.
+                    Thread.Sleep(100);
+
+                    var start = stopwatch.Elapsed;
+                    for (int i = 0; i < messageCount; i++)
+                    {
+                        ClientPipe.Send($"{i}|{stopwatch.ElapsedTicks}|{payload}");
+                    }
+
+                    Assert.IsTrue(reset.WaitOne(TimeSpan.FromSeconds(60)));
+                    var elapsed = stopwatch.Elapsed - start;
+
+                    serverPipe.End();
+
+                    // Every message is delivered exactly once. Each batch is read on its own connection, so batches aren't guaranteed to arrive in order.
+                    CollectionAssert.AreEquivalent(Enumerable.Range(0, messageCount).Select(i => i.ToString(CultureInfo.InvariantCulture)).ToList(), received);
+
+                    latencies.Sort();
+                    Console.WriteLine($"{messageCount / elapsed.TotalSeconds:F0} messages/s, latency p50 {latencies[messageCount / 2]:F2} ms, p99 {latencies[messageCount * 99 / 100]:F2} ms, max {latencies[messageCount - 1]:F2} ms");
+                }
+            }
+        }
+
         protected virtual void Dispose(bool disposing)
         {
             if (!disposedValue)
@@ -0,0 +1,79 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Wire format of TwoWayPipeMessageIPC.
+// Every pipe message carries a batch of messages: a magic number, then for each message
+// its UTF-8 byte count as a little endian uint32, followed by the UTF-8 bytes.
+namespace PipeMessageFraming
+{
+    // "PTB1" when read as bytes
+    constexpr uint32_t BATCH_MAGIC = 0x31425450;
+
+    // Appends a message to the batch, starting the batch if it's empty.
+    // The batch buffer is reused between batches, so its capacity is only grown once.
+    inline void append_message(std::string& batch, const std::wstring& message)
+    {
+        if (batch.empty())
+        {
+            batch.append(reinterpret_cast<const char*>(&BATCH_MAGIC), sizeof(BATCH_MAGIC));
+        }
+
+        const int utf8_size = message.empty() ? 0 : WideCharToMultiByte(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), nullptr, 0, nullptr, nullptr);
+        const uint32_t frame_size = static_cast<uint32_t>(utf8_size);
+        const size_t frame_start = batch.size();
+        batch.resize(frame_start + sizeof(frame_size) + frame_size);
+        memcpy(batch.data() + frame_start, &frame_size, sizeof(frame_size));
+        if (frame_size > 0)
+        {
+            WideCharToMultiByte(CP_UTF8, 0, message.data(), static_cast<int>(message.size()), batch.data() + frame_start + sizeof(frame_size), utf8_size, nullptr, nullptr);
+        }
+    }
+
+    // Calls on_message with every message of the batch, as an rvalue std::wstring the callback
+    // can take ownership of. Returns false if the batch is malformed, messages before the
+    // malformed part have been delivered.
+    template<typename Callback>
+    bool read_messages(const char* batch, size_t batch_size, Callback&& on_message)
+    {
+        uint32_t magic = 0;
+        if (batch_size < sizeof(magic))
+        {
+            return false;
+        }
+        memcpy(&magic, batch, sizeof(magic));
+        if (magic != BATCH_MAGIC)
+        {
+            return false;
+        }
+
+        size_t offset = sizeof(magic);
+        while (offset < batch_size)
+        {
+            uint32_t frame_size = 0;
+            if (batch_size - offset < sizeof(frame_size))
+            {
+                return false;
+            }
+            memcpy(&frame_size, batch + offset, sizeof(frame_size));
+            offset += sizeof(frame_size);
+            if (batch_size - offset < frame_size)
+            {
+                return false;
+            }
+
+            std::wstring message;
+            if (frame_size > 0)
+            {
+                const int length = MultiByteToWideChar(CP_UTF8, 0, batch + offset, static_cast<int>(frame_size), nullptr, 0);
+                message.resize(length);
+                MultiByteToWideChar(CP_UTF8, 0, batch + offset, static_cast<int>(frame_size), message.data(), length);
+            }
+            offset += frame_size;
+            on_message(std::move(message));
+        }
+        return true;
+    }
+}
@@ -23,7 +23,7 @@ TwoWayPipeMessageIPC::~TwoWayPipeMessageIPC()
 
 void TwoWayPipeMessageIPC::send(std::wstring msg)
 {
-    impl->send(msg);
+    impl->send(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::start(HANDLE _restricted_pipe_token)
@@ -48,7 +48,12 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
 {
-    output_queue.queue_message(msg);
+    if (msg.empty())
+    {
+        // Nothing to deliver, the receiving side never dispatches empty messages.
+        return;
+    }
+    output_queue.queue_message(std::move(msg));
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pipe_token)
@@ -75,11 +80,10 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
     input_pipe_thread.join();
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(const std::string& batch)
 {
     // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-client
     HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
     BOOL fSuccess = FALSE;
     DWORD cbToWrite, cbWritten, dwMode;
     const wchar_t* lpszPipename = output_pipe_name.c_str();
@@ -125,37 +129,44 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstr
         NULL); // don't set maximum time
     if (!fSuccess)
     {
+        CloseHandle(output_pipe_handle);
         return;
     }
 
-    // Send a message to the pipe server.
+    // Send the whole batch to the pipe server with a single write. Pipe is in message mode,
+    // so the server reads it back as one message.
 
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
+    cbToWrite = static_cast<DWORD>(batch.size());
 
-    fSuccess = WriteFile(
+    WriteFile(
         output_pipe_handle, // pipe handle
-        message_send, // message
+        batch.data(), // message
         cbToWrite, // message length
         &cbWritten, // bytes written
         NULL); // not overlapped
-    if (!fSuccess)
-    {
-        return;
-    }
     CloseHandle(output_pipe_handle);
     return;
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
+    // Everything queued while the previous batch was being written goes out in the next one,
+    // so a burst of messages costs one pipe connection instead of one per message.
+    std::string batch;
     while (!closed)
     {
-        std::wstring message = output_queue.pop_message();
-        if (message.length() == 0)
+        auto messages = output_queue.pop_messages();
+        if (messages.empty())
         {
             break;
         }
-        send_pipe_message(message);
+
+        batch.clear();
+        for (const auto& message : messages)
+        {
+            PipeMessageFraming::append_message(batch, message);
+        }
+        send_pipe_message(batch);
     }
 }
 
@@ -353,38 +364,43 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HAND
     {
         return;
     }
-    constexpr DWORD readBlockBytes = BUFSIZE;
-    std::wstring message;
-    size_t iBlock = 0;
-    message.reserve(BUFSIZE);
+    std::string batch(BUFSIZE, '\0');
+    size_t bytesTotal = 0;
     bool ok;
-    do
+    while (true)
     {
-        constexpr size_t charsPerBlock = readBlockBytes / sizeof(message[0]);
-        message.resize(message.size() + charsPerBlock);
         DWORD bytesRead = 0;
         ok = ReadFile(
             input_pipe_handle,
-            // read the message directly into the string block by block simultaneously resizing it
-            message.data() + iBlock * charsPerBlock,
-            readBlockBytes,
+            batch.data() + bytesTotal,
+            static_cast<DWORD>(batch.size() - bytesTotal),
             &bytesRead,
             nullptr);
+        bytesTotal += bytesRead;
 
-        if (!ok && GetLastError() != ERROR_MORE_DATA)
+        if (ok || GetLastError() != ERROR_MORE_DATA)
         {
             break;
         }
-        iBlock++;
-    } while (!ok);
-    // trim the message's buffer
-    const auto nullCharPos = message.find_last_not_of(L'\0');
-    if (nullCharPos != std::wstring::npos)
-    {
-        message.resize(nullCharPos + 1);
+
+        // Grow the buffer to fit the rest of the message at once
+        DWORD bytesLeft = 0;
+        if (!PeekNamedPipe(input_pipe_handle, nullptr, 0, nullptr, nullptr, &bytesLeft) || bytesLeft == 0)
+        {
+            bytesLeft = BUFSIZE;
+        }
+        batch.resize(bytesTotal + bytesLeft);
     }
 
-    input_queue.queue_message(std::move(message));
+    if (ok)
+    {
+        PipeMessageFraming::read_messages(batch.data(), bytesTotal, [this](std::wstring&& message) {
+            if (!message.empty())
+            {
+                input_queue.queue_message(std::move(message));
+            }
+        });
+    }
 
     // Flush the pipe to allow the client to read the pipe's contents
     // before disconnecting. Then disconnect the pipe, and close the
@@ -450,19 +466,19 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread(
 {
     while (!closed)
     {
-        outgoing_message = L"";
-        std::wstring message = input_queue.pop_message();
-        if (message.length() == 0)
+        auto messages = input_queue.pop_messages();
+        if (messages.empty())
         {
             break;
         }
 
         // Check if callback method exists first before trying to call it.
-        // otherwise just store the response message in a variable.
         if (dispatch_inc_message_function != nullptr)
         {
-            dispatch_inc_message_function(message);
+            for (const auto& message : messages)
+            {
+                dispatch_inc_message_function(message);
+            }
         }
-        outgoing_message = message;
     }
 }
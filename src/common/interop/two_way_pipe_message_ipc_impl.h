@@ -1,6 +1,7 @@
 #pragma once
 #include <Windows.h>
 #include "async_message_queue.h"
+#include "pipe_message_framing.h"
 #include <WinSafer.h>
 #include <accctrl.h>
 #include <aclapi.h>
@@ -24,13 +25,12 @@ private:
     std::thread output_queue_thread;
     std::thread input_pipe_thread;
     std::mutex pipe_connect_handle_mutex; // For manipulating the current_connect_pipe
-    std::wstring outgoing_message; // Store the updated json settings.
 
     HANDLE current_connect_pipe_handle = NULL;
     bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
 
-    void send_pipe_message(std::wstring message);
+    void send_pipe_message(const std::string& batch);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
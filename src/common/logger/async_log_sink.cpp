@@ -0,0 +1,330 @@
+#include "pch.h"
+#include "async_log_sink.h"
+
+namespace
+{
+    // Most log messages fit, longer ones grow their record once
+    constexpr size_t record_reserve = 256;
+
+    // How long the flush thread polls after writing records before it goes to sleep until the
+    // next push. While it polls, log calls don't pay for waking it up.
+    constexpr auto poll_interval = std::chrono::milliseconds(5);
+
+    size_t round_up_to_power_of_two(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+AsyncLogSink::AsyncLogSink(std::string loggerName, std::vector<spdlog::sink_ptr> sinks, OverflowPolicy overflowPolicy, size_t capacity) :
+    loggerName(std::move(loggerName)),
+    sinks(std::move(sinks)),
+    overflowPolicy(overflowPolicy),
+    capacityMask(round_up_to_power_of_two(capacity) - 1),
+    records(std::make_unique<Record[]>(capacityMask + 1))
+{
+    for (size_t i = 0; i <= capacityMask; i++)
+    {
+        records[i].sequence.store(i, std::memory_order_relaxed);
+        records[i].payload.reserve(record_reserve);
+    }
+
+    thread = std::thread(&AsyncLogSink::flush_thread, this);
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    stopping.store(true, std::memory_order_seq_cst);
+    pushEpoch.fetch_add(1, std::memory_order_seq_cst);
+    pushEpoch.notify_all();
+    popEpoch.fetch_add(1, std::memory_order_seq_cst);
+    popEpoch.notify_all();
+    thread.join();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+{
+    if (try_push(msg))
+    {
+        notify_flush_thread();
+        return;
+    }
+
+    // The flush thread can't wait for itself to free a record, e.g. when a sink logs
+    if (overflowPolicy == OverflowPolicy::DropNewest || on_flush_thread())
+    {
+        dropCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    blockCount.fetch_add(1, std::memory_order_relaxed);
+    for (;;)
+    {
+        // Announce the wait, then try again: the flush thread either sees the announcement
+        // and wakes us up, or freed a record before we read the epoch.
+        const uint32_t epoch = popEpoch.load(std::memory_order_seq_cst);
+        producersWaiting.fetch_add(1, std::memory_order_seq_cst);
+        if (stopping.load(std::memory_order_seq_cst))
+        {
+            producersWaiting.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        if (try_push(msg))
+        {
+            producersWaiting.fetch_sub(1, std::memory_order_relaxed);
+            notify_flush_thread();
+            return;
+        }
+        popEpoch.wait(epoch, std::memory_order_seq_cst);
+        producersWaiting.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLogSink::flush()
+{
+    flushRequested.store(true, std::memory_order_seq_cst);
+    notify_flush_thread();
+}
+
+void AsyncLogSink::set_pattern(const std::string& pattern)
+{
+    for (auto& sink : sinks)
+    {
+        sink->set_pattern(pattern);
+    }
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    for (auto& sink : sinks)
+    {
+        sink->set_formatter(sink_formatter->clone());
+    }
+}
+
+void AsyncLogSink::drain()
+{
+    if (on_flush_thread())
+    {
+        // Nobody else would write the records, e.g. for a crash handler running on the flush
+        // thread. Inside a sink call the sink may hold its lock, so the records are left then.
+        if (!writingToSink)
+        {
+            write_records();
+            write_dropped_count();
+            flush_sinks();
+            completedPosition.store(dequeuePosition, std::memory_order_seq_cst);
+        }
+        return;
+    }
+
+    const size_t target = enqueuePosition.load(std::memory_order_seq_cst);
+    drainWaiters.fetch_add(1, std::memory_order_seq_cst);
+    flush();
+
+    size_t completed = completedPosition.load(std::memory_order_acquire);
+    while (completed < target && !stopping.load(std::memory_order_acquire))
+    {
+        completedPosition.wait(completed, std::memory_order_acquire);
+        completed = completedPosition.load(std::memory_order_acquire);
+    }
+    drainWaiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogSink::dropped_count() const
+{
+    return dropCount.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogSink::blocked_count() const
+{
+    return blockCount.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogSink::on_flush_thread() const
+{
+    return std::this_thread::get_id() == flushThreadId.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogSink::try_push(const spdlog::details::log_msg& msg)
+{
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Record& record = records[position & capacityMask];
+        const size_t sequence = record.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0)
+        {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                record.level = msg.level;
+                record.time = msg.time;
+                record.threadId = msg.thread_id;
+                record.source = msg.source;
+                record.payload.assign(msg.payload.data(), msg.payload.size());
+                record.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The flush thread hasn't written this record yet, the ring is full.
+            return false;
+        }
+        else
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t AsyncLogSink::write_records()
+{
+    size_t written = 0;
+    for (;;)
+    {
+        Record& record = records[dequeuePosition & capacityMask];
+        if (record.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        {
+            return written;
+        }
+
+        spdlog::details::log_msg msg(record.time, record.source, loggerName, record.level, spdlog::string_view_t(record.payload.data(), record.payload.size()));
+        msg.thread_id = record.threadId;
+        writingToSink = true;
+        for (auto& sink : sinks)
+        {
+            if (sink->should_log(msg.level))
+            {
+                try
+                {
+                    sink->log(msg);
+                }
+                catch (...)
+                {
+                    // Nowhere to report it, keep writing the other records
+                }
+            }
+        }
+        writingToSink = false;
+
+        record.sequence.store(dequeuePosition + capacityMask + 1, std::memory_order_release);
+        ++dequeuePosition;
+        ++written;
+        if (overflowPolicy == OverflowPolicy::Block)
+        {
+            notify_producers();
+        }
+    }
+}
+
+void AsyncLogSink::write_dropped_count()
+{
+    const uint64_t dropped = dropCount.load(std::memory_order_relaxed);
+    if (dropped == reportedDropCount)
+    {
+        return;
+    }
+
+    const std::string text = std::to_string(dropped - reportedDropCount) + " log messages were dropped because the log queue was full";
+    reportedDropCount = dropped;
+
+    spdlog::details::log_msg msg(spdlog::source_loc{}, loggerName, spdlog::level::warn, text);
+    writingToSink = true;
+    for (auto& sink : sinks)
+    {
+        try
+        {
+            sink->log(msg);
+        }
+        catch (...)
+        {
+        }
+    }
+    writingToSink = false;
+}
+
+void AsyncLogSink::flush_sinks()
+{
+    writingToSink = true;
+    for (auto& sink : sinks)
+    {
+        try
+        {
+            sink->flush();
+        }
+        catch (...)
+        {
+        }
+    }
+    writingToSink = false;
+}
+
+void AsyncLogSink::flush_thread()
+{
+    flushThreadId.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    for (;;)
+    {
+        const uint32_t epoch = pushEpoch.load(std::memory_order_seq_cst);
+        const size_t written = write_records();
+        write_dropped_count();
+
+        const bool stop = stopping.load(std::memory_order_seq_cst);
+        if (flushRequested.exchange(false, std::memory_order_seq_cst) || drainWaiters.load(std::memory_order_seq_cst) != 0 || stop)
+        {
+            flush_sinks();
+        }
+
+        completedPosition.store(dequeuePosition, std::memory_order_seq_cst);
+        if (drainWaiters.load(std::memory_order_seq_cst) != 0 || stop)
+        {
+            completedPosition.notify_all();
+        }
+
+        if (stop)
+        {
+            return;
+        }
+
+        // Blocked producers need their records freed right away, so only poll when they can't block
+        if (overflowPolicy == OverflowPolicy::DropNewest && written > 0 && drainWaiters.load(std::memory_order_seq_cst) == 0)
+        {
+            std::this_thread::sleep_for(poll_interval);
+            continue;
+        }
+
+        // Same announce-then-check as the producers: a record pushed after the check above
+        // either sees flushThreadWaiting or bumped the epoch we're about to wait on.
+        flushThreadWaiting.store(true, std::memory_order_seq_cst);
+        const bool pending = records[dequeuePosition & capacityMask].sequence.load(std::memory_order_seq_cst) == dequeuePosition + 1;
+        if (!pending && !flushRequested.load(std::memory_order_seq_cst) && !stopping.load(std::memory_order_seq_cst))
+        {
+            pushEpoch.wait(epoch, std::memory_order_seq_cst);
+        }
+        flushThreadWaiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLogSink::notify_flush_thread()
+{
+    pushEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (flushThreadWaiting.load(std::memory_order_seq_cst))
+    {
+        pushEpoch.notify_one();
+    }
+}
+
+void AsyncLogSink::notify_producers()
+{
+    popEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (producersWaiting.load(std::memory_order_seq_cst) != 0)
+    {
+        popEpoch.notify_all();
+    }
+}
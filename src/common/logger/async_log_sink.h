@@ -0,0 +1,108 @@
+#pragma once
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Sink that hands log records to a background thread, which writes them to the wrapped sinks.
+// The caller only formats the message arguments and copies the result into a preallocated
+// record of a lock-free ring, the pattern formatting, disk I/O and flushing all happen on the
+// flush thread. Meant for processes that log from hook callbacks, where a log call must never
+// wait for the disk.
+// The flush thread is joined in the destructor, so don't use it in DLLs that can be unloaded
+// while the process keeps running.
+class AsyncLogSink final : public spdlog::sinks::sink
+{
+public:
+    enum class OverflowPolicy
+    {
+        // Drop the new record and count it, the caller never waits
+        DropNewest,
+        // Wait for the flush thread to free a record
+        Block,
+    };
+
+    static constexpr size_t default_capacity = 2048;
+
+    AsyncLogSink(std::string loggerName, std::vector<spdlog::sink_ptr> sinks, OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest, size_t capacity = default_capacity);
+    ~AsyncLogSink() override;
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    // Asks the flush thread to flush the wrapped sinks once it has written the queued records.
+    // Doesn't wait, spdlog calls it after every record at or above the flush level.
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+    // Waits until every record logged before the call is written and the wrapped sinks are flushed.
+    // On the flush thread it writes them itself instead, unless it's called from a wrapped sink.
+    void drain();
+
+    // Records dropped because the ring was full
+    uint64_t dropped_count() const;
+    // Log calls that had to wait because the ring was full
+    uint64_t blocked_count() const;
+
+private:
+    struct Record
+    {
+        std::atomic<size_t> sequence;
+        spdlog::level::level_enum level;
+        spdlog::log_clock::time_point time;
+        size_t threadId;
+        spdlog::source_loc source;
+        // Reserved up front, so copying a message that fits doesn't allocate
+        std::string payload;
+    };
+
+    bool on_flush_thread() const;
+    bool try_push(const spdlog::details::log_msg& msg);
+    size_t write_records();
+    void write_dropped_count();
+    void flush_sinks();
+    void flush_thread();
+
+    void notify_flush_thread();
+    void notify_producers();
+
+    const std::string loggerName;
+    const std::vector<spdlog::sink_ptr> sinks;
+    const OverflowPolicy overflowPolicy;
+
+    const size_t capacityMask;
+    std::unique_ptr<Record[]> records;
+
+    alignas(64) std::atomic<size_t> enqueuePosition{ 0 };
+    // Only touched by the flush thread
+    alignas(64) size_t dequeuePosition = 0;
+    uint64_t reportedDropCount = 0;
+    bool writingToSink = false;
+
+    // Position up to which records are written, drain() waits on it
+    alignas(64) std::atomic<size_t> completedPosition{ 0 };
+    std::atomic<uint32_t> drainWaiters{ 0 };
+
+    // Eventcounts, see AsyncMessageQueue
+    alignas(64) std::atomic<uint32_t> pushEpoch{ 0 };
+    std::atomic<bool> flushThreadWaiting{ false };
+    alignas(64) std::atomic<uint32_t> popEpoch{ 0 };
+    std::atomic<uint32_t> producersWaiting{ 0 };
+
+    std::atomic<bool> flushRequested{ false };
+    std::atomic<bool> stopping{ false };
+    std::atomic<uint64_t> dropCount{ 0 };
+    std::atomic<uint64_t> blockCount{ 0 };
+
+    // Set by the flush thread itself, it can run before the thread member is assigned
+    std::atomic<std::thread::id> flushThreadId;
+    std::thread thread;
+};
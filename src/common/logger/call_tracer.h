@@ -4,11 +4,17 @@
 
 #include "logger.h"
 
+#if POWERTOYS_LOGGER_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
 #define _TRACER_ CallTracer callTracer(__FUNCTION__)
+#else
+#define _TRACER_
+#endif
 
+// Logs entering and exiting the scope at trace level. Only checks the level when trace is off.
 class CallTracer
 {
-    std::string functionName;
+    const char* functionName;
+    bool enabled;
 public:
     CallTracer(const char* functionName);
     ~CallTracer();
@@ -3,6 +3,7 @@
 #include "pch.h"
 #include "framework.h"
 #include "logger.h"
+#include "async_log_sink.h"
 #include <unordered_map>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -10,7 +11,6 @@
 #include <spdlog/sinks/stdout_color_sinks-inl.h>
 #include <iostream>
 
-using spdlog::sinks_init_list;
 using spdlog::level::level_enum;
 using spdlog::sinks::daily_file_sink_mt;
 using spdlog::sinks::msvc_sink_mt;
@@ -45,6 +45,7 @@ level_enum getLogLevel(std::wstring_view logSettingsPath)
 }
 
 std::shared_ptr<spdlog::logger> Logger::logger = spdlog::null_logger_mt("null");
+std::shared_ptr<AsyncLogSink> Logger::asyncSink;
 
 bool Logger::wasLogFailedShown()
 {
@@ -55,7 +56,7 @@ bool Logger::wasLogFailedShown()
     return len;
 }
 
-void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
+void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, LoggerMode mode)
 {
     auto logLevel = getLogLevel(logSettingsPath);
     bool newLoggerCreated = false;
@@ -64,16 +65,22 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
         logger = spdlog::get(loggerName);
         if (logger == nullptr)
         {
-            auto sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+            std::vector<spdlog::sink_ptr> sinks{ make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention) };
             if (IsDebuggerPresent())
             {
                 auto msvc_sink = make_shared<msvc_sink_mt>();
                 msvc_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [t-%t] [%l] %v");
-                logger = make_shared<spdlog::logger>(loggerName, sinks_init_list{ sink, msvc_sink });
+                sinks.push_back(msvc_sink);
+            }
+
+            if (mode == LoggerMode::Asynchronous)
+            {
+                asyncSink = make_shared<AsyncLogSink>(loggerName, std::move(sinks));
+                logger = make_shared<spdlog::logger>(loggerName, asyncSink);
             }
             else
             {
-                logger = make_shared<spdlog::logger>(loggerName, sink);
+                logger = make_shared<spdlog::logger>(loggerName, begin(sinks), end(sinks));
             }
             newLoggerCreated = true;
         }
@@ -106,13 +113,38 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
     logger->info("{} logger is initialized", loggerName);
 }
 
-void Logger::init(std::vector<spdlog::sink_ptr> sinks)
+void Logger::init(std::vector<spdlog::sink_ptr> sinks, LoggerMode mode)
 {
-    auto init_logger = std::make_shared<spdlog::logger>("", begin(sinks), end(sinks));
+    std::shared_ptr<AsyncLogSink> init_async_sink;
+    std::shared_ptr<spdlog::logger> init_logger;
+    if (mode == LoggerMode::Asynchronous)
+    {
+        init_async_sink = std::make_shared<AsyncLogSink>("", std::move(sinks));
+        init_logger = std::make_shared<spdlog::logger>("", init_async_sink);
+    }
+    else
+    {
+        init_logger = std::make_shared<spdlog::logger>("", begin(sinks), end(sinks));
+    }
+
     if (!init_logger)
     {
         return;
     }
 
     Logger::logger = init_logger;
+    Logger::asyncSink = init_async_sink;
+}
+
+void Logger::flush()
+{
+    if (asyncSink)
+    {
+        // Flushes the wrapped sinks once the queue is written
+        asyncSink->drain();
+    }
+    else
+    {
+        logger->flush();
+    }
 }
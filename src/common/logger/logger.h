@@ -2,63 +2,124 @@
 #include <spdlog/spdlog.h>
 #include "logger_settings.h"
 
+// Log calls below this level are compiled out, the log settings filter the levels that remain.
+// Release builds drop trace messages, like the _TRACER_ scope logs, and keep debug and above for
+// the logs users attach to bug reports. Define it in a project to override the default.
+#ifndef POWERTOYS_LOGGER_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define POWERTOYS_LOGGER_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+#else
+#define POWERTOYS_LOGGER_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+#endif
+
+class AsyncLogSink;
+
+enum class LoggerMode
+{
+    // Log calls format and write to the log file on the calling thread
+    Synchronous,
+    // Log calls only queue the message, a background thread writes it. See AsyncLogSink.
+    Asynchronous,
+};
+
 class Logger
 {
 private:
     inline const static std::wstring logFailedShown = L"logFailedShown";
     static std::shared_ptr<spdlog::logger> logger;
+    static std::shared_ptr<AsyncLogSink> asyncSink;
     static bool wasLogFailedShown();
 
 public:
     Logger() = delete;
 
-    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath);
-    static void init(std::vector<spdlog::sink_ptr> sinks);
+    static void init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath, LoggerMode mode = LoggerMode::Synchronous);
+    static void init(std::vector<spdlog::sink_ptr> sinks, LoggerMode mode = LoggerMode::Synchronous);
 
-    // log message should not be localized
-    template<typename FormatString, typename... Args>
-    static void trace(const FormatString& fmt, const Args&... args)
+    // Whether messages of this level are compiled in and let through by the log settings
+    template<spdlog::level::level_enum level>
+    static bool enabled()
     {
-        logger->trace(fmt, args...);
+        if constexpr (level < POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            return false;
+        }
+        else
+        {
+            return logger->should_log(level);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
-    static void debug(const FormatString& fmt, const Args&... args)
+    static void trace([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->debug(fmt, args...);
+        if constexpr (SPDLOG_LEVEL_TRACE >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->trace(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
-    static void info(const FormatString& fmt, const Args&... args)
+    static void debug([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->info(fmt, args...);
+        if constexpr (SPDLOG_LEVEL_DEBUG >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->debug(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
-    static void warn(const FormatString& fmt, const Args&... args)
+    static void info([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->warn(fmt, args...);
+        if constexpr (SPDLOG_LEVEL_INFO >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->info(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
-    static void error(const FormatString& fmt, const Args&... args)
+    static void warn([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->error(fmt, args...);
+        if constexpr (SPDLOG_LEVEL_WARN >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->warn(fmt, args...);
+        }
     }
 
     // log message should not be localized
     template<typename FormatString, typename... Args>
-    static void critical(const FormatString& fmt, const Args&... args)
+    static void error([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->critical(fmt, args...);
+        if constexpr (SPDLOG_LEVEL_ERROR >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->error(fmt, args...);
+        }
     }
 
-    static void flush()
+    // log message should not be localized
+    template<typename FormatString, typename... Args>
+    static void critical([[maybe_unused]] const FormatString& fmt, [[maybe_unused]] const Args&... args)
     {
-        logger->flush();
+        if constexpr (SPDLOG_LEVEL_CRITICAL >= POWERTOYS_LOGGER_ACTIVE_LEVEL)
+        {
+            logger->critical(fmt, args...);
+        }
     }
+
+    // In asynchronous mode, waits until the queued messages are written
+    static void flush();
 };
+
+// Same as the Logger functions, but the arguments are only evaluated if the level is enabled.
+// Use them where building the arguments costs something, e.g. on hook threads.
+#define LOG_TRACE(...) do { if (Logger::enabled<spdlog::level::trace>()) { Logger::trace(__VA_ARGS__); } } while (0)
+#define LOG_DEBUG(...) do { if (Logger::enabled<spdlog::level::debug>()) { Logger::debug(__VA_ARGS__); } } while (0)
+#define LOG_INFO(...) do { if (Logger::enabled<spdlog::level::info>()) { Logger::info(__VA_ARGS__); } } while (0)
+#define LOG_WARN(...) do { if (Logger::enabled<spdlog::level::warn>()) { Logger::warn(__VA_ARGS__); } } while (0)
+#define LOG_ERROR(...) do { if (Logger::enabled<spdlog::level::err>()) { Logger::error(__VA_ARGS__); } } while (0)
+#define LOG_CRITICAL(...) do { if (Logger::enabled<spdlog::level::critical>()) { Logger::critical(__VA_ARGS__); } } while (0)
@@ -1,7 +1,12 @@
 #pragma once
 
 #include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cwctype>
+#include <memory>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -160,7 +165,9 @@ namespace powertoys_gpo
         return string_value;
     }
 
-    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+    // Reads the policy straight from the registry. Use getConfiguredValue(), which answers from a
+    // cached snapshot of the policy keys.
+    inline gpo_rule_configured_t readConfiguredValue(const std::wstring& registry_value_name)
     {
         HKEY key{};
         DWORD value = 0xFFFFFFFE;
@@ -217,6 +224,311 @@ namespace powertoys_gpo
         }
     }
 
+    namespace details
+    {
+        // Registry value names are case insensitive
+        struct PolicyNameHash
+        {
+            size_t operator()(const std::wstring& name) const noexcept
+            {
+                size_t hash = 14695981039346656037ull;
+                for (wchar_t c : name)
+                {
+                    hash = (hash ^ static_cast<size_t>(std::towupper(c))) * 1099511628211ull;
+                }
+                return hash;
+            }
+        };
+
+        struct PolicyNameEqual
+        {
+            bool operator()(const std::wstring& lhs, const std::wstring& rhs) const noexcept
+            {
+                return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](wchar_t a, wchar_t b) { return std::towupper(a) == std::towupper(b); });
+            }
+        };
+
+        using PolicyValues = std::unordered_map<std::wstring, DWORD, PolicyNameHash, PolicyNameEqual>;
+
+        // The DWORD policy values of both scopes, read in one pass. lookup() gives the same
+        // answer readConfiguredValue() would have given when the snapshot was taken.
+        struct PolicySnapshot
+        {
+            PolicyValues machine_values;
+            PolicyValues user_values;
+            LSTATUS user_key_status = ERROR_FILE_NOT_FOUND;
+
+            bool operator==(const PolicySnapshot&) const = default;
+
+            static LSTATUS readScope(HKEY scope, const std::wstring& policies_path, PolicyValues& values)
+            {
+                HKEY key{};
+                if (auto res = RegOpenKeyExW(scope, policies_path.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+                {
+                    return res;
+                }
+
+                DWORD max_name_length = 0;
+                RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &max_name_length, nullptr, nullptr, nullptr);
+                std::vector<wchar_t> name(static_cast<size_t>(max_name_length) + 1);
+                for (DWORD index = 0;; index++)
+                {
+                    DWORD name_length = static_cast<DWORD>(name.size());
+                    DWORD value = 0xFFFFFFFE;
+                    DWORD value_size = sizeof(value);
+                    auto res = RegEnumValueW(key, index, name.data(), &name_length, nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &value_size);
+                    if (res == ERROR_NO_MORE_ITEMS)
+                    {
+                        break;
+                    }
+
+                    // Values that don't fit a DWORD fail to read in readConfiguredValue() too.
+                    if (res == ERROR_SUCCESS)
+                    {
+                        values.emplace(std::wstring(name.data(), name_length), value);
+                    }
+                }
+
+                RegCloseKey(key);
+                return ERROR_SUCCESS;
+            }
+
+            static std::unique_ptr<const PolicySnapshot> read(const std::wstring& policies_path = POLICIES_PATH)
+            {
+                auto snapshot = std::make_unique<PolicySnapshot>();
+                readScope(POLICIES_SCOPE_MACHINE, policies_path, snapshot->machine_values);
+                snapshot->user_key_status = readScope(POLICIES_SCOPE_USER, policies_path, snapshot->user_values);
+                return snapshot;
+            }
+
+            gpo_rule_configured_t lookup(const std::wstring& registry_value_name) const
+            {
+                DWORD value = 0;
+                if (auto it = machine_values.find(registry_value_name); it != machine_values.end())
+                {
+                    value = it->second;
+                }
+                else if (user_key_status != ERROR_SUCCESS)
+                {
+                    return user_key_status == ERROR_FILE_NOT_FOUND ? gpo_rule_configured_not_configured : gpo_rule_configured_unavailable;
+                }
+                else if (auto user_it = user_values.find(registry_value_name); user_it != user_values.end())
+                {
+                    value = user_it->second;
+                }
+                else
+                {
+                    return gpo_rule_configured_not_configured;
+                }
+
+                switch (value)
+                {
+                case 0:
+                    return gpo_rule_configured_disabled;
+                case 1:
+                    return gpo_rule_configured_enabled;
+                default:
+                    return gpo_rule_configured_wrong_value;
+                }
+            }
+        };
+
+        // Keeps a PolicySnapshot up to date. RegNotifyChangeKeyValue signals an event when anything
+        // under the Policies key of either scope changes, and a thread pool wait on that event reads
+        // a new snapshot. The PowerToys key itself is usually missing, so the parent is watched.
+        // Readers get the current snapshot with a single atomic load of a raw pointer. Snapshots are
+        // never modified and only freed with the watcher, policies rarely change and a read with the
+        // same values isn't published, so the replaced ones are few.
+        //
+        // The thread pool doesn't start a callback once its DLL is being unloaded, so the destructor
+        // only cancels the wait: waiting for a callback in DllMain can deadlock on the loader lock.
+        // An executable calls stop() before exiting, its callbacks can still run during static
+        // destruction.
+        class PolicyWatcher
+        {
+        public:
+            explicit PolicyWatcher(const std::wstring& watched_path = L"SOFTWARE\\Policies", std::wstring policies_key_path = POLICIES_PATH) :
+                policies_path(std::move(policies_key_path))
+            {
+                event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+                if (!event ||
+                    RegOpenKeyExW(POLICIES_SCOPE_MACHINE, watched_path.c_str(), 0, KEY_NOTIFY, &machine_key) != ERROR_SUCCESS ||
+                    RegOpenKeyExW(POLICIES_SCOPE_USER, watched_path.c_str(), 0, KEY_NOTIFY, &user_key) != ERROR_SUCCESS ||
+                    !watch())
+                {
+                    // Without notifications a snapshot could go stale, getConfiguredValue() reads the registry instead.
+                    return;
+                }
+
+                // Keeps the module loaded while a callback runs
+                HMODULE module{};
+                GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCWSTR>(&PolicyWatcher::onPolicyChanged), &module);
+                InitializeThreadpoolEnvironment(&environment);
+                SetThreadpoolCallbackLibrary(&environment, module);
+                wait = CreateThreadpoolWait(&PolicyWatcher::onPolicyChanged, this, &environment);
+                if (!wait)
+                {
+                    return;
+                }
+
+                publish(PolicySnapshot::read(policies_path));
+                SetThreadpoolWait(wait, event, nullptr);
+            }
+
+            ~PolicyWatcher()
+            {
+                if (wait)
+                {
+                    // Not stopped, we may be in DllMain. A callback that is already queued can
+                    // still run, so the handles and snapshots it uses are leaked.
+                    stopping.store(true, std::memory_order_release);
+                    SetThreadpoolWait(wait, nullptr, nullptr);
+                    for (auto& snapshot : snapshots)
+                    {
+                        snapshot.release();
+                    }
+                    return;
+                }
+
+                closeHandles();
+            }
+
+            PolicyWatcher(const PolicyWatcher&) = delete;
+            PolicyWatcher& operator=(const PolicyWatcher&) = delete;
+
+            // Waits for a running callback to finish. Afterwards snapshot() returns nullptr, the
+            // snapshots stay valid until the watcher is destroyed.
+            void stop()
+            {
+                if (wait)
+                {
+                    // A running callback sees the flag and doesn't start waiting again
+                    stopping.store(true, std::memory_order_release);
+                    SetThreadpoolWait(wait, nullptr, nullptr);
+                    WaitForThreadpoolWaitCallbacks(wait, TRUE);
+                    CloseThreadpoolWait(wait);
+                    DestroyThreadpoolEnvironment(&environment);
+                    wait = nullptr;
+                }
+                current.store(nullptr, std::memory_order_release);
+                closeHandles();
+            }
+
+            // nullptr when the policy keys can't be watched
+            const PolicySnapshot* snapshot() const noexcept
+            {
+                return current.load(std::memory_order_acquire);
+            }
+
+        private:
+            // The notification is registered on the event, not the calling thread, so it survives
+            // the thread pool retiring the thread.
+            bool watch()
+            {
+                constexpr DWORD filter = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+                return RegNotifyChangeKeyValue(machine_key, TRUE, filter, event, TRUE) == ERROR_SUCCESS &&
+                       RegNotifyChangeKeyValue(user_key, TRUE, filter, event, TRUE) == ERROR_SUCCESS;
+            }
+
+            // Anything else under the Policies keys changing reads the same values again, readers
+            // keep the snapshot they have then. Only the constructor and the callback publish, and
+            // the wait is armed again at the end of the callback, so they never run at once.
+            void publish(std::unique_ptr<const PolicySnapshot> snapshot)
+            {
+                if (const auto previous = current.load(std::memory_order_acquire); previous && *previous == *snapshot)
+                {
+                    return;
+                }
+                current.store(snapshot.get(), std::memory_order_release);
+                snapshots.push_back(std::move(snapshot));
+            }
+
+            void closeHandles()
+            {
+                if (machine_key)
+                {
+                    RegCloseKey(machine_key);
+                    machine_key = nullptr;
+                }
+                if (user_key)
+                {
+                    RegCloseKey(user_key);
+                    user_key = nullptr;
+                }
+                if (event)
+                {
+                    CloseHandle(event);
+                    event = nullptr;
+                }
+            }
+
+            static void CALLBACK onPolicyChanged(PTP_CALLBACK_INSTANCE, PVOID context, PTP_WAIT wait, TP_WAIT_RESULT)
+            {
+                auto self = static_cast<PolicyWatcher*>(context);
+
+                // Watch again before reading, a change made while reading signals the event again.
+                if (!self->watch())
+                {
+                    self->current.store(nullptr, std::memory_order_release);
+                    return;
+                }
+
+                self->publish(PolicySnapshot::read(self->policies_path));
+                if (!self->stopping.load(std::memory_order_acquire))
+                {
+                    SetThreadpoolWait(wait, self->event, nullptr);
+                }
+            }
+
+            const std::wstring policies_path;
+            HANDLE event{};
+            HKEY machine_key{};
+            HKEY user_key{};
+            TP_CALLBACK_ENVIRON environment{};
+            PTP_WAIT wait{};
+            std::atomic<bool> stopping{ false };
+
+            std::atomic<const PolicySnapshot*> current{};
+            // Every snapshot that was published, readers may still use the replaced ones
+            std::vector<std::unique_ptr<const PolicySnapshot>> snapshots;
+        };
+
+        // Only set once policyWatcher() was called, stopPolicyWatcher() doesn't start one
+        inline std::atomic<bool> policy_watcher_started{ false };
+
+        // One per module that includes this header
+        inline PolicyWatcher& policyWatcher()
+        {
+            static PolicyWatcher watcher;
+            [[maybe_unused]] static const bool started = (policy_watcher_started.store(true, std::memory_order_release), true);
+            return watcher;
+        }
+
+        inline const PolicySnapshot* policySnapshot()
+        {
+            return policyWatcher().snapshot();
+        }
+    }
+
+    // Stops refreshing the cached policies of this module, later queries read the registry.
+    // Executables call it before exiting, see PolicyWatcher.
+    inline void stopPolicyWatcher()
+    {
+        if (details::policy_watcher_started.load(std::memory_order_acquire))
+        {
+            details::policyWatcher().stop();
+        }
+    }
+
+    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+    {
+        if (const auto snapshot = details::policySnapshot())
+        {
+            return snapshot->lookup(registry_value_name);
+        }
+        return readConfiguredValue(registry_value_name);
+    }
+
     inline std::optional<std::wstring> getPolicyListValue(const std::wstring& registry_list_path, const std::wstring& registry_list_value_name)
     {
         // This function returns the value of an entry of a policy list. The user scope is only checked, if the list is not enabled for the machine to not mix the lists.
@@ -275,6 +587,52 @@ namespace powertoys_gpo
             return getConfiguredValue(POLICY_CONFIGURE_ENABLED_GLOBAL_ALL_UTILITIES);
         }
     }
+
+    // True if a policy forces any utility to be enabled. The runner can't map a utility policy to
+    // its module without loading the module, so it loads every module when this is set.
+    inline bool isAnyUtilityForcedEnabled()
+    {
+        if (getConfiguredValue(POLICY_CONFIGURE_ENABLED_GLOBAL_ALL_UTILITIES) == gpo_rule_configured_enabled)
+        {
+            return true;
+        }
+
+        const std::wstring_view utility_policy_prefix = L"ConfigureEnabledUtility";
+        for (HKEY scope : { POLICIES_SCOPE_MACHINE, POLICIES_SCOPE_USER })
+        {
+            HKEY key{};
+            if (RegOpenKeyExW(scope, POLICIES_PATH.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS)
+            {
+                continue;
+            }
+
+            bool found = false;
+            wchar_t name[256];
+            for (DWORD index = 0; !found; index++)
+            {
+                DWORD nameLength = ARRAYSIZE(name);
+                DWORD type = 0;
+                DWORD value = 0;
+                DWORD valueSize = sizeof(value);
+                auto res = RegEnumValueW(key, index, name, &nameLength, nullptr, &type, reinterpret_cast<LPBYTE>(&value), &valueSize);
+                if (res == ERROR_NO_MORE_ITEMS)
+                {
+                    break;
+                }
+
+                // Values that don't fit a DWORD come back as ERROR_MORE_DATA and aren't utility policies.
+                found = res == ERROR_SUCCESS && type == REG_DWORD && value == gpo_rule_configured_enabled && std::wstring_view(name, nameLength).starts_with(utility_policy_prefix);
+            }
+
+            RegCloseKey(key);
+            if (found)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
 #pragma endregion ReadRegistryMethods
 
     // Utility enabled state policies
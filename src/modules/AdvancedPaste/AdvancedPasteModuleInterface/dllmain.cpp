@@ -821,6 +821,22 @@ public:
         Disable(true);
     }
 
+    // Same hotkeys on_hotkey handles
+    virtual bool should_swallow_hotkey(size_t hotkeyId) override
+    {
+        if (!m_enabled)
+        {
+            return false;
+        }
+
+        if (hotkeyId < NUM_DEFAULT_HOTKEYS)
+        {
+            return true;
+        }
+
+        return hotkeyId - NUM_DEFAULT_HOTKEYS < m_additional_actions.size() + m_custom_actions.size();
+    }
+
     virtual bool on_hotkey(size_t hotkeyId) override
     {
         Logger::trace(L"AdvancedPaste hotkey pressed");
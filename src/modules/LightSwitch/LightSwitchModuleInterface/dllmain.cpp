@@ -536,6 +536,11 @@ public:
         return 1;
     }
 
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        return m_enabled;
+    }
+
     virtual bool on_hotkey(size_t hotkeyId) override
     {
         if (m_enabled)
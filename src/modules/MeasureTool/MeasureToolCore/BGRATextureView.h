@@ -123,6 +123,36 @@ struct BGRATextureView
         }
     }
 
+#if !defined(_M_ARM64)
+    // Same test as PixelsClose, but for 4 pixels at once against a broadcasted pixel.
+    // Returns a 4-bit mask where bit i is set if the i-th pixel is NOT close.
+    template<bool perChannel>
+    static inline uint32_t PixelsFarMask(const __m128i pixels4, const __m128i pixel, uint8_t tolerance)
+    {
+        const __m128i distances = distance_epu8(pixels4, pixel);
+
+        if constexpr (perChannel)
+        {
+            // Channels within tolerance saturate to zero, so a pixel is close only if all of its bytes are zero
+            const __m128i exceeded = _mm_subs_epu8(distances, _mm_set1_epi8(static_cast<char>(tolerance)));
+            const __m128i closeLanes = _mm_cmpeq_epi32(exceeded, _mm_setzero_si128());
+            return ~static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(closeLanes))) & 0xF;
+        }
+        else
+        {
+            // Horizontal sum of the 4 channel distances inside each 32-bit lane, truncated to a byte like in PixelsClose
+            const __m128i byteMask = _mm_set1_epi32(0x00FF00FF);
+            const __m128i pairSums = _mm_add_epi32(_mm_and_si128(distances, byteMask),
+                                                   _mm_and_si128(_mm_srli_epi32(distances, 8), byteMask));
+            const __m128i sums = _mm_add_epi32(_mm_and_si128(pairSums, _mm_set1_epi32(0xFFFF)),
+                                               _mm_srli_epi32(pairSums, 16));
+            const __m128i scores = _mm_and_si128(sums, _mm_set1_epi32(std::numeric_limits<uint8_t>::max()));
+            const __m128i farLanes = _mm_cmpgt_epi32(scores, _mm_set1_epi32(tolerance));
+            return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(farLanes)));
+        }
+    }
+#endif
+
 #if defined(DEBUG_TEXTURE)
     void SaveAsBitmap(const char* filename) const;
 #endif
@@ -135,11 +165,28 @@ class MappedTextureView
 
 public:
     BGRATextureView view;
+
+    // Area of the captured frame which is covered by view, and the size of the whole frame.
+    // They differ from the view dimensions only when a region of interest was copied.
+    RECT frameRegion = {};
+    SIZE frameSize = {};
+
     MappedTextureView(winrt::com_ptr<ID3D11Texture2D> _texture,
                       winrt::com_ptr<ID3D11DeviceContext> _context,
                       const size_t textureWidth,
                       const size_t textureHeight) :
-        texture{ std::move(_texture) }, context{ std::move(_context) }
+        MappedTextureView{ std::move(_texture),
+                           std::move(_context),
+                           RECT{ 0, 0, static_cast<LONG>(textureWidth), static_cast<LONG>(textureHeight) },
+                           SIZE{ static_cast<LONG>(textureWidth), static_cast<LONG>(textureHeight) } }
+    {
+    }
+
+    MappedTextureView(winrt::com_ptr<ID3D11Texture2D> _texture,
+                      winrt::com_ptr<ID3D11DeviceContext> _context,
+                      const RECT _frameRegion,
+                      const SIZE _frameSize) :
+        texture{ std::move(_texture) }, context{ std::move(_context) }, frameRegion{ _frameRegion }, frameSize{ _frameSize }
     {
         D3D11_TEXTURE2D_DESC desc;
         texture->GetDesc(&desc);
@@ -149,8 +196,13 @@ public:
 
         view.pixels = static_cast<const uint32_t*>(resource.pData);
         view.pitch = resource.RowPitch / 4;
-        view.width = textureWidth;
-        view.height = textureHeight;
+        view.width = static_cast<size_t>(frameRegion.right - frameRegion.left);
+        view.height = static_cast<size_t>(frameRegion.bottom - frameRegion.top);
+    }
+
+    inline bool CoversWholeFrame() const
+    {
+        return frameRegion.left == 0 && frameRegion.top == 0 && frameRegion.right == frameSize.cx && frameRegion.bottom == frameSize.cy;
     }
 
     MappedTextureView(MappedTextureView&&) = default;
@@ -1,5 +1,7 @@
 #include "pch.h"
 
+#include <bit>
+
 #include "constants.h"
 #include "EdgeDetection.h"
 
@@ -10,51 +12,80 @@ inline long FindEdge(const BGRATextureView& texture, const POINT centerPoint, co
 {
     using namespace consts;
 
-    const size_t maxDim = IsX ? texture.width : texture.height;
+    const long maxDim = static_cast<long>(IsX ? texture.width : texture.height);
+
+    const long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+    const long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
 
-    long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
-    long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+    const auto pixelAt = [&](const long pos) {
+        return IsX ? texture.GetPixel(pos, y) : texture.GetPixel(x, pos);
+    };
 
     const uint32_t startPixel = texture.GetPixel(x, y);
-    while (true)
+
+    // Last position along the scan axis which is known to be close to the start pixel
+    long pos = IsX ? x : y;
+
+#if !defined(_M_ARM64)
+    // Compare 4 pixels per iteration along rows, which are contiguous. Columns are left to the
+    // scalar loop: a strided gather needs the same 4 loads, and a column block only holds one
+    // pixel of the scanned column per row.
+    if constexpr (IsX)
     {
-        long oldX = x;
-        long oldY = y;
-        if constexpr (IsX)
+        const __m128i startPixel4 = _mm_set1_epi32(static_cast<int>(startPixel));
+        const uint32_t* row = texture.pixels + texture.pitch * y;
+        const auto load4 = [&](const long first) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + first));
+        };
+
+        if constexpr (Increment)
         {
-            if constexpr (Increment)
-            {
-                if (++x == maxDim)
-                    break;
-            }
-            else
+            for (long first = pos + 1; first + 4 <= maxDim; first += 4)
             {
-                if (--x == 0)
-                    break;
+                if (const uint32_t farMask = BGRATextureView::PixelsFarMask<PerChannel>(load4(first), startPixel4, tolerance))
+                {
+                    return first + std::countr_zero(farMask) - 1;
+                }
+                pos = first + 3;
             }
         }
         else
         {
-            if constexpr (Increment)
-            {
-                if (++y == maxDim)
-                    break;
-            }
-            else
+            // Pixel at 0 is never compared, same as in the scalar loop below
+            for (long first = pos - 4; first >= 1; first -= 4)
             {
-                if (--y == 0)
-                    break;
+                if (const uint32_t farMask = BGRATextureView::PixelsFarMask<PerChannel>(load4(first), startPixel4, tolerance))
+                {
+                    return first + static_cast<long>(std::bit_width(farMask));
+                }
+                pos = first;
             }
         }
+    }
+#endif
+
+    // Scalar scan of the remaining pixels, or of the whole column
+    while (true)
+    {
+        const long oldPos = pos;
+        if constexpr (Increment)
+        {
+            if (++pos == maxDim)
+                break;
+        }
+        else
+        {
+            if (--pos == 0)
+                break;
+        }
 
-        const uint32_t nextPixel = texture.GetPixel(x, y);
-        if (!texture.PixelsClose<PerChannel>(startPixel, nextPixel, tolerance))
+        if (!texture.PixelsClose<PerChannel>(startPixel, pixelAt(pos), tolerance))
         {
-            return IsX ? oldX : oldY;
+            return oldPos;
         }
     }
 
-    return Increment ? static_cast<long>(IsX ? texture.width : texture.height) - 1 : 0;
+    return Increment ? maxDim - 1 : 0;
 }
 
 template<bool PerChannel>
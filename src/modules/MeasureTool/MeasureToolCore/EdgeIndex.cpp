@@ -0,0 +1,143 @@
+#include "pch.h"
+
+#include "EdgeDetection.h"
+#include "EdgeIndex.h"
+
+namespace
+{
+    // Lines with more runs than length / DENSE_LINE_RATIO (noise, gradients, photos) aren't indexed
+    constexpr size_t DENSE_LINE_RATIO = 4;
+
+    template<bool PerChannel, bool Increment, typename PixelAt>
+    long FindEdgeInRuns(const std::vector<uint32_t>& runStarts,
+                        const long lineLength,
+                        const long startPos,
+                        const PixelAt& pixelAt,
+                        const uint8_t tolerance)
+    {
+        const uint32_t startPixel = pixelAt(startPos);
+
+        // Run which contains the start position. All of its pixels are equal to the start pixel.
+        auto run = std::upper_bound(runStarts.begin(), runStarts.end(), static_cast<uint32_t>(startPos)) - 1;
+
+        if constexpr (Increment)
+        {
+            for (auto next = run + 1; next != runStarts.end(); ++next)
+            {
+                if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, pixelAt(*next), tolerance))
+                {
+                    return static_cast<long>(*next) - 1;
+                }
+            }
+
+            return lineLength - 1;
+        }
+        else
+        {
+            for (; run != runStarts.begin(); --run)
+            {
+                // The pixel at 0 is never compared, same as in DetectEdges
+                const long previous = static_cast<long>(*run) - 1;
+                if (previous == 0)
+                {
+                    break;
+                }
+
+                if (!BGRATextureView::PixelsClose<PerChannel>(startPixel, pixelAt(previous), tolerance))
+                {
+                    return previous + 1;
+                }
+            }
+
+            return 0;
+        }
+    }
+
+    template<bool PerChannel>
+    RECT DetectEdgesInRuns(const BGRATextureView& texture,
+                           const std::vector<uint32_t>& rowRuns,
+                           const std::vector<uint32_t>& columnRuns,
+                           const long x,
+                           const long y,
+                           const uint8_t tolerance)
+    {
+        const long width = static_cast<long>(texture.width);
+        const long height = static_cast<long>(texture.height);
+        const auto rowPixel = [&](const long pos) { return texture.GetPixel(pos, y); };
+        const auto columnPixel = [&](const long pos) { return texture.GetPixel(x, pos); };
+
+        return RECT{ .left = FindEdgeInRuns<PerChannel, false>(rowRuns, width, x, rowPixel, tolerance),
+                     .top = FindEdgeInRuns<PerChannel, false>(columnRuns, height, y, columnPixel, tolerance),
+                     .right = FindEdgeInRuns<PerChannel, true>(rowRuns, width, x, rowPixel, tolerance),
+                     .bottom = FindEdgeInRuns<PerChannel, true>(columnRuns, height, y, columnPixel, tolerance) };
+    }
+}
+
+void EdgeIndex::Build(const BGRATextureView& texture)
+{
+    const size_t maxRowRuns = texture.width / DENSE_LINE_RATIO;
+    const size_t maxColumnRuns = texture.height / DENSE_LINE_RATIO;
+
+    rows.assign(texture.height, {});
+    columns.assign(texture.width, {});
+    std::vector<bool> denseColumns(texture.width, false);
+
+    // Rows and columns are both collected in a single row-major pass, which keeps memory access sequential
+    for (size_t y = 0; y < texture.height; ++y)
+    {
+        auto& rowRuns = rows[y].runStarts;
+        bool denseRow = false;
+        for (size_t x = 0; x < texture.width; ++x)
+        {
+            const uint32_t pixel = texture.GetPixel(x, y);
+
+            if (!denseRow && (x == 0 || pixel != texture.GetPixel(x - 1, y)))
+            {
+                if (rowRuns.size() == maxRowRuns)
+                {
+                    denseRow = true;
+                    rowRuns = {};
+                }
+                else
+                {
+                    rowRuns.push_back(static_cast<uint32_t>(x));
+                }
+            }
+
+            if (!denseColumns[x] && (y == 0 || pixel != texture.GetPixel(x, y - 1)))
+            {
+                auto& columnRuns = columns[x].runStarts;
+                if (columnRuns.size() == maxColumnRuns)
+                {
+                    denseColumns[x] = true;
+                    columnRuns = {};
+                }
+                else
+                {
+                    columnRuns.push_back(static_cast<uint32_t>(y));
+                }
+            }
+        }
+    }
+
+    ready.store(true, std::memory_order_release);
+}
+
+RECT EdgeIndex::DetectEdges(const BGRATextureView& texture,
+                            const POINT centerPoint,
+                            const bool perChannel,
+                            const uint8_t tolerance) const
+{
+    const long x = std::clamp<long>(centerPoint.x, 1, static_cast<long>(texture.width - 2));
+    const long y = std::clamp<long>(centerPoint.y, 1, static_cast<long>(texture.height - 2));
+
+    const auto& rowRuns = rows[y].runStarts;
+    const auto& columnRuns = columns[x].runStarts;
+    if (rowRuns.empty() || columnRuns.empty())
+    {
+        return ::DetectEdges(texture, centerPoint, perChannel, tolerance);
+    }
+
+    return perChannel ? DetectEdgesInRuns<true>(texture, rowRuns, columnRuns, x, y, tolerance) :
+                        DetectEdgesInRuns<false>(texture, rowRuns, columnRuns, x, y, tolerance);
+}
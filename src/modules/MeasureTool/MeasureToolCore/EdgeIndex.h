@@ -0,0 +1,38 @@
+#pragma once
+
+#include "BGRATextureView.h"
+
+#include <atomic>
+#include <vector>
+
+// Run-length index of a static captured frame. Every row and column is split into runs of
+// identical pixels, so edge detection compares a single pixel per run instead of every pixel
+// and finds the run under the cursor with a binary search. The result is the same as DetectEdges.
+class EdgeIndex
+{
+public:
+    // Must be called once, e.g. on a background thread. Until it's done, Ready() returns false.
+    void Build(const BGRATextureView& texture);
+
+    inline bool Ready() const
+    {
+        return ready.load(std::memory_order_acquire);
+    }
+
+    RECT DetectEdges(const BGRATextureView& texture,
+                     const POINT centerPoint,
+                     const bool perChannel,
+                     const uint8_t tolerance) const;
+
+private:
+    struct Line
+    {
+        // Starting positions of runs of identical pixels, the first one is always 0.
+        // Empty if the line has too many runs for the index to be worth it.
+        std::vector<uint32_t> runStarts;
+    };
+
+    std::vector<Line> rows;
+    std::vector<Line> columns;
+    std::atomic_bool ready = false;
+};
@@ -4,6 +4,7 @@
 #include "constants.h"
 #include "CoordinateSystemConversion.h"
 #include "EdgeDetection.h"
+#include "EdgeIndex.h"
 #include "ScreenCapturing.h"
 
 #include <common/Display/monitors.h>
@@ -27,8 +28,21 @@ namespace
 
         return item;
     }
+
+    RECT CaptureRegionAroundPoint(const POINT point, const long halfExtent, const winrt::SizeInt32 frameSize)
+    {
+        const long x = std::clamp<long>(point.x, 0, frameSize.Width - 1);
+        const long y = std::clamp<long>(point.y, 0, frameSize.Height - 1);
+        return RECT{ .left = std::max<long>(x - halfExtent, 0),
+                     .top = std::max<long>(y - halfExtent, 0),
+                     .right = std::min<long>(x + halfExtent, frameSize.Width),
+                     .bottom = std::min<long>(y + halfExtent, frameSize.Height) };
+    }
 }
 
+// Returns false if the texture view is a region of the frame which was too small to process it
+using FrameCallback = std::function<bool(MappedTextureView)>;
+
 class D3DCaptureState final
 {
     DxgiAPI* dxgiAPI = nullptr;
@@ -42,10 +56,14 @@ class D3DCaptureState final
     winrt::Direct3D11CaptureFramePool framePool = nullptr;
     winrt::GraphicsCaptureSession session = nullptr;
 
-    std::function<void(MappedTextureView)> frameCallback;
+    FrameCallback frameCallback;
     Box monitorArea;
     bool continuousCapture = false;
 
+    long captureRegionHalfExtent = consts::CAPTURE_REGION_MIN_HALF_EXTENT;
+    size_t framesSinceCaptureRegionGrew = 0;
+    std::vector<winrt::com_ptr<ID3D11Texture2D>> regionStagingTextures;
+
     D3DCaptureState(DxgiAPI* dxgiAPI,
                     winrt::com_ptr<IDXGISwapChain1> swapChain,
                     winrt::DirectXPixelFormat pixelFormat,
@@ -53,6 +71,8 @@ class D3DCaptureState final
                     const bool continuousCapture);
 
     winrt::com_ptr<ID3D11Texture2D> CopyFrameToCPU(const winrt::com_ptr<ID3D11Texture2D>& texture);
+    winrt::com_ptr<ID3D11Texture2D> CopyFrameRegionToCPU(const winrt::com_ptr<ID3D11Texture2D>& texture, const RECT& region);
+    void CaptureRegionAroundCursor(const winrt::com_ptr<ID3D11Texture2D>& texture, const POINT cursorPos);
 
     void OnFrameArrived(const winrt::Direct3D11CaptureFramePool& sender, const winrt::IInspectable&);
 
@@ -68,7 +88,7 @@ public:
 
     ~D3DCaptureState();
 
-    void StartCapture(std::function<void(MappedTextureView)> _frameCallback);
+    void StartCapture(FrameCallback _frameCallback);
     MappedTextureView CaptureSingleFrame();
 
     void StopCapture();
@@ -105,6 +125,85 @@ winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::CopyFrameToCPU(const winrt::com
     return cpuTexture;
 }
 
+winrt::com_ptr<ID3D11Texture2D> D3DCaptureState::CopyFrameRegionToCPU(const winrt::com_ptr<ID3D11Texture2D>& frameTexture, const RECT& region)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    frameTexture->GetDesc(&desc);
+
+    // Staging textures are sized after the region extent rather than the region itself, so they
+    // can be reused while the cursor moves and regions get clipped by the frame borders.
+    const UINT extent = static_cast<UINT>(captureRegionHalfExtent * 2);
+    desc.Width = std::min(desc.Width, extent);
+    desc.Height = std::min(desc.Height, extent);
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    desc.MiscFlags = 0;
+    desc.BindFlags = 0;
+
+    winrt::com_ptr<ID3D11Texture2D> cpuTexture;
+    for (const auto& stagingTexture : regionStagingTextures)
+    {
+        D3D11_TEXTURE2D_DESC stagingDesc = {};
+        stagingTexture->GetDesc(&stagingDesc);
+        if (stagingDesc.Width == desc.Width && stagingDesc.Height == desc.Height && stagingDesc.Format == desc.Format)
+        {
+            cpuTexture = stagingTexture;
+            break;
+        }
+    }
+
+    if (!cpuTexture)
+    {
+        winrt::check_hresult(dxgiAPI->d3dForCapture.d3dDevice->CreateTexture2D(&desc, nullptr, cpuTexture.put()));
+        regionStagingTextures.push_back(cpuTexture);
+    }
+
+    const D3D11_BOX box = { .left = static_cast<UINT>(region.left),
+                            .top = static_cast<UINT>(region.top),
+                            .front = 0,
+                            .right = static_cast<UINT>(region.right),
+                            .bottom = static_cast<UINT>(region.bottom),
+                            .back = 1 };
+    dxgiAPI->d3dForCapture.d3dContext->CopySubresourceRegion(cpuTexture.get(), 0, 0, 0, 0, frameTexture.get(), 0, &box);
+
+    return cpuTexture;
+}
+
+void D3DCaptureState::CaptureRegionAroundCursor(const winrt::com_ptr<ID3D11Texture2D>& frameTexture, const POINT cursorPos)
+{
+    D3D11_TEXTURE2D_DESC desc = {};
+    frameTexture->GetDesc(&desc);
+    const winrt::SizeInt32 size{ std::min(frameSize.Width, static_cast<int32_t>(desc.Width)),
+                                 std::min(frameSize.Height, static_cast<int32_t>(desc.Height)) };
+    const POINT cursorInFrame{ cursorPos.x - monitorArea.left(), cursorPos.y - monitorArea.top() };
+
+    while (true)
+    {
+        const RECT region = CaptureRegionAroundPoint(cursorInFrame, captureRegionHalfExtent, size);
+        MappedTextureView textureView{ CopyFrameRegionToCPU(frameTexture, region),
+                                       dxgiAPI->d3dForCapture.d3dContext,
+                                       region,
+                                       SIZE{ size.Width, size.Height } };
+        const bool wholeFrame = textureView.CoversWholeFrame();
+
+        if (frameCallback(std::move(textureView)) || wholeFrame)
+        {
+            break;
+        }
+
+        captureRegionHalfExtent *= 2;
+        framesSinceCaptureRegionGrew = 0;
+    }
+
+    // Go back to smaller copies once the bigger region hasn't been needed for a while
+    if (++framesSinceCaptureRegionGrew >= consts::CAPTURE_REGION_SHRINK_AFTER_FRAMES &&
+        captureRegionHalfExtent > consts::CAPTURE_REGION_MIN_HALF_EXTENT)
+    {
+        captureRegionHalfExtent /= 2;
+        framesSinceCaptureRegionGrew = 0;
+    }
+}
+
 template<typename T>
 auto GetDXGIInterfaceFromObject(winrt::IInspectable const& object)
 {
@@ -153,14 +252,27 @@ void D3DCaptureState::OnFrameArrived(const winrt::Direct3D11CaptureFramePool& se
             winrt::check_hresult(swapChain->GetBuffer(0, winrt::guid_of<ID3D11Texture2D>(), texture.put_void()));
             auto surface = frame.Surface();
             auto gpuTexture = GetDXGIInterfaceFromObject<ID3D11Texture2D>(surface);
-            texture = CopyFrameToCPU(gpuTexture);
-            surface.Close();
-            MappedTextureView textureView{ texture,
-                                           dxgiAPI->d3dForCapture.d3dContext,
-                                           static_cast<size_t>(frameSize.Width),
-                                           static_cast<size_t>(frameSize.Height) };
-
-            frameCallback(std::move(textureView));
+            if (continuousCapture)
+            {
+                if (resized)
+                {
+                    regionStagingTextures.clear();
+                }
+
+                CaptureRegionAroundCursor(gpuTexture, cursorPos);
+                surface.Close();
+            }
+            else
+            {
+                texture = CopyFrameToCPU(gpuTexture);
+                surface.Close();
+                MappedTextureView textureView{ texture,
+                                               dxgiAPI->d3dForCapture.d3dContext,
+                                               static_cast<size_t>(frameSize.Width),
+                                               static_cast<size_t>(frameSize.Height) };
+
+                frameCallback(std::move(textureView));
+            }
         }
     }
 
@@ -226,7 +338,7 @@ void D3DCaptureState::StartSessionInPreferredMode()
     session.StartCapture();
 }
 
-void D3DCaptureState::StartCapture(std::function<void(MappedTextureView)> _frameCallback)
+void D3DCaptureState::StartCapture(FrameCallback _frameCallback)
 {
     frameCallback = std::move(_frameCallback);
     StartSessionInPreferredMode();
@@ -239,11 +351,12 @@ MappedTextureView D3DCaptureState::CaptureSingleFrame()
 
     frameCallback = [frameArrivedEvent, &result, this](MappedTextureView tex) {
         if (frameArrivedEvent.is_signaled())
-            return;
+            return true;
 
         StopCapture();
         result.emplace(std::move(tex));
         frameArrivedEvent.SetEvent();
+        return true;
     };
     StartSessionInPreferredMode();
 
@@ -268,14 +381,24 @@ void D3DCaptureState::StopCapture()
     }
 }
 
-void UpdateCaptureState(const CommonState& commonState,
+// Returns false if the texture view covers only a region of the frame and the edges
+// couldn't be found inside of it, so a bigger region should be captured.
+bool UpdateCaptureState(const CommonState& commonState,
                         Serialized<MeasureToolState>& state,
                         HWND window,
-                        const MappedTextureView& textureView)
+                        const MappedTextureView& textureView,
+                        const EdgeIndex* edgeIndex = nullptr)
 {
     const auto cursorPos = convert::FromSystemToWindow(window, commonState.cursorPosSystemSpace);
-    const bool cursorInLeftScreenHalf = cursorPos.x < textureView.view.width / 2;
-    const bool cursorInTopScreenHalf = cursorPos.y < textureView.view.height / 2;
+    const RECT& region = textureView.frameRegion;
+    const bool wholeFrame = textureView.CoversWholeFrame();
+    if (!wholeFrame && !PtInRect(&region, cursorPos))
+    {
+        return false;
+    }
+
+    const bool cursorInLeftScreenHalf = cursorPos.x < textureView.frameSize.cx / 2;
+    const bool cursorInTopScreenHalf = cursorPos.y < textureView.frameSize.cy / 2;
     uint8_t pixelTolerance = {};
     bool perColorChannelEdgeDetection = {};
     state.Access([&](MeasureToolState& state) {
@@ -290,10 +413,25 @@ void UpdateCaptureState(const CommonState& commonState,
     //          at 20x100, bounds should be [20,100]-[24,104]. We don't include [25,105] or
     //          [19,99], since those pixels are blue. Thus, square dims are equal to
     //          [24-20+1,104-100+1]=[5,5].
-    const RECT bounds = DetectEdges(textureView.view,
-                                    cursorPos,
-                                    perColorChannelEdgeDetection,
-                                    pixelTolerance);
+    const POINT cursorInRegion{ cursorPos.x - region.left, cursorPos.y - region.top };
+    const RECT regionBounds = edgeIndex && edgeIndex->Ready() ?
+                                  edgeIndex->DetectEdges(textureView.view, cursorInRegion, perColorChannelEdgeDetection, pixelTolerance) :
+                                  DetectEdges(textureView.view, cursorInRegion, perColorChannelEdgeDetection, pixelTolerance);
+
+    // An edge found on the region border could continue outside of it, unless it's the frame border too
+    if (!wholeFrame &&
+        ((regionBounds.left == 0 && region.left > 0) ||
+         (regionBounds.top == 0 && region.top > 0) ||
+         (regionBounds.right == static_cast<long>(textureView.view.width) - 1 && region.right < textureView.frameSize.cx) ||
+         (regionBounds.bottom == static_cast<long>(textureView.view.height) - 1 && region.bottom < textureView.frameSize.cy)))
+    {
+        return false;
+    }
+
+    const RECT bounds = { .left = regionBounds.left + region.left,
+                          .top = regionBounds.top + region.top,
+                          .right = regionBounds.right + region.left,
+                          .bottom = regionBounds.bottom + region.top };
     auto px2mmRatio = commonState.GetPhysicalPx2MmRatio(window);
 
 #if defined(DEBUG_EDGES)
@@ -314,6 +452,8 @@ void UpdateCaptureState(const CommonState& commonState,
     state.Access([&](MeasureToolState& state) {
         state.perScreen[window].measuredEdges = Measurement{ bounds, px2mmRatio };
     });
+
+    return true;
 }
 
 std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
@@ -348,7 +488,7 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                 if (mouseOnMonitor)
                 {
                     captureState->StartCapture([&, window](MappedTextureView textureView) {
-                        UpdateCaptureState(commonState, state, window, textureView);
+                        return UpdateCaptureState(commonState, state, window, textureView);
                     });
                 }
                 else
@@ -369,6 +509,12 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                 s.perScreen[window].capturedScreenTexture = &textureView;
             });
 
+            // The frame doesn't change anymore, so index it once and make every following cursor move cheap
+            EdgeIndex edgeIndex;
+            auto indexingThread = SpawnLoggedThread(L"Edge indexing thread", [&edgeIndex, &textureView] {
+                edgeIndex.Build(textureView.view);
+            });
+
             while (IsWindow(window) && !commonState.closeOnOtherMonitors)
             {
                 const auto now = std::chrono::high_resolution_clock::now();
@@ -382,7 +528,7 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                     auto path = std::filesystem::temp_directory_path() / buf;
                     textureView.view.SaveAsBitmap(path.string().c_str());
 #endif
-                    UpdateCaptureState(commonState, state, window, textureView);
+                    UpdateCaptureState(commonState, state, window, textureView, &edgeIndex);
                     mouseOnMonitor = true;
                 }
                 else if (mouseOnMonitor)
@@ -399,6 +545,8 @@ std::thread StartCapturingThread(DxgiAPI* dxgiAPI,
                     std::this_thread::sleep_for(consts::TARGET_FRAME_DURATION - frameTime);
                 }
             }
+
+            indexingThread.join();
         }
 
         captureState->StopCapture();
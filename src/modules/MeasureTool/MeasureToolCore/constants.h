@@ -20,5 +20,9 @@ namespace consts
     constexpr inline long CURSOR_OFFSET_AMOUNT_X = 4;
     constexpr inline long CURSOR_OFFSET_AMOUNT_Y = 4;
 
+    /* In continuous mode only a region around the cursor is copied from GPU. It grows when an edge isn't found inside of it. */
+    constexpr inline long CAPTURE_REGION_MIN_HALF_EXTENT = 256;
+    constexpr inline size_t CAPTURE_REGION_SHRINK_AFTER_FRAMES = 120;
+
     constexpr inline LPARAM MOUSEEVENTF_FROMTOUCH = 0xFF515700;
 }
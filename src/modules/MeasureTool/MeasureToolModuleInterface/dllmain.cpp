@@ -252,6 +252,11 @@ public:
         return m_enabled;
     }
 
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        return m_enabled;
+    }
+
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
         if (m_enabled)
@@ -0,0 +1,225 @@
+#include "pch.h"
+
+#include <CursorWrap/MonitorTopology.h>
+#include <CursorWrap/CursorWrapTests.h>
+
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace CursorWrapUnitTests
+{
+    constexpr LONG MonitorWidth = 1920;
+    constexpr LONG MonitorHeight = 1080;
+
+    MonitorInfo MakeMonitor(int id, LONG left, LONG top, LONG width = MonitorWidth, LONG height = MonitorHeight)
+    {
+        return MonitorInfo{ .rect = { left, top, left + width, top + height }, .isPrimary = id == 0, .monitorId = id };
+    }
+
+    // Lays out the monitors of a 3x3 grid case side by side, empty rows and columns are
+    // skipped so that monitors in neighbouring occupied cells touch.
+    std::vector<MonitorInfo> MonitorsFromGrid(const int (&grid)[3][3], std::vector<int>& gridIds)
+    {
+        int rowOffset[3]{};
+        int colOffset[3]{};
+        for (int i = 0, usedRows = 0, usedCols = 0; i < 3; i++)
+        {
+            rowOffset[i] = usedRows;
+            colOffset[i] = usedCols;
+            usedRows += std::any_of(std::begin(grid[i]), std::end(grid[i]), [](int id) { return id != 0; }) ? 1 : 0;
+            usedCols += (grid[0][i] || grid[1][i] || grid[2][i]) ? 1 : 0;
+        }
+
+        std::vector<MonitorInfo> monitors;
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++)
+            {
+                if (grid[row][col] != 0)
+                {
+                    monitors.push_back(MakeMonitor(static_cast<int>(monitors.size()), colOffset[col] * MonitorWidth, rowOffset[row] * MonitorHeight));
+                    gridIds.push_back(grid[row][col]);
+                }
+            }
+        }
+        return monitors;
+    }
+
+    TEST_CLASS(MonitorTopologyTests)
+    {
+    public:
+        TEST_METHOD(SingleMonitor_EveryEdgeWrapsToItself)
+        {
+            // Arrange
+            MonitorTopology topology;
+
+            // Act
+            topology.Initialize({ MakeMonitor(0, 0, 0) });
+
+            // Assert
+            const auto& left = topology.GetEdgeTransition(0, MonitorEdge::Left);
+            const auto& right = topology.GetEdgeTransition(0, MonitorEdge::Right);
+            const auto& top = topology.GetEdgeTransition(0, MonitorEdge::Top);
+            const auto& bottom = topology.GetEdgeTransition(0, MonitorEdge::Bottom);
+            for (const auto* transition : { &left, &right, &top, &bottom })
+            {
+                Assert::IsTrue(transition->wraps);
+                Assert::AreEqual(0, transition->targetMonitor);
+            }
+            Assert::AreEqual(MonitorWidth - 1, left.landing);
+            Assert::AreEqual(0L, right.landing);
+            Assert::AreEqual(MonitorHeight - 1, top.landing);
+            Assert::AreEqual(0L, bottom.landing);
+        }
+
+        TEST_METHOD(HorizontalPair_OuterEdgesWrapToTheOtherMonitor)
+        {
+            // Arrange
+            MonitorTopology topology;
+
+            // Act
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, MonitorWidth, 0) });
+
+            // Assert
+            Assert::IsFalse(topology.GetEdgeTransition(0, MonitorEdge::Right).wraps);
+            Assert::IsFalse(topology.GetEdgeTransition(1, MonitorEdge::Left).wraps);
+
+            const auto& left = topology.GetEdgeTransition(0, MonitorEdge::Left);
+            Assert::IsTrue(left.wraps);
+            Assert::AreEqual(1, left.targetMonitor);
+            Assert::AreEqual(2 * MonitorWidth - 1, left.landing);
+
+            const auto& right = topology.GetEdgeTransition(1, MonitorEdge::Right);
+            Assert::IsTrue(right.wraps);
+            Assert::AreEqual(0, right.targetMonitor);
+            Assert::AreEqual(0L, right.landing);
+
+            // Nothing above or below either monitor, so the vertical edges wrap within the monitor
+            Assert::AreEqual(0, topology.GetEdgeTransition(0, MonitorEdge::Top).targetMonitor);
+            Assert::AreEqual(1, topology.GetEdgeTransition(1, MonitorEdge::Bottom).targetMonitor);
+        }
+
+        TEST_METHOD(VerticalPair_TopMonitorIsPlacedByPositionNotOrder)
+        {
+            // Arrange
+            // Monitor 0 is the primary below monitor 1, which has negative coordinates
+            MonitorTopology topology;
+
+            // Act
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, 0, -MonitorHeight) });
+
+            // Assert
+            Assert::AreEqual(0, topology.GetPosition(1).row);
+            Assert::AreEqual(2, topology.GetPosition(0).row);
+            Assert::IsFalse(topology.GetEdgeTransition(0, MonitorEdge::Top).wraps);
+            Assert::IsFalse(topology.GetEdgeTransition(1, MonitorEdge::Bottom).wraps);
+
+            const auto& top = topology.GetEdgeTransition(1, MonitorEdge::Top);
+            Assert::IsTrue(top.wraps);
+            Assert::AreEqual(0, top.targetMonitor);
+            Assert::AreEqual(MonitorHeight - 1, top.landing);
+
+            const auto& bottom = topology.GetEdgeTransition(0, MonitorEdge::Bottom);
+            Assert::IsTrue(bottom.wraps);
+            Assert::AreEqual(1, bottom.targetMonitor);
+            Assert::AreEqual(-MonitorHeight, bottom.landing);
+        }
+
+        TEST_METHOD(GetWrapDestination_ScalesToTheTargetMonitorSize)
+        {
+            // Arrange
+            // A 1080p monitor next to a taller 1440p one
+            MonitorTopology topology;
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, MonitorWidth, 0, 2560, 1440) });
+            POINT newPos{};
+
+            // Act
+            const bool wrapped = topology.GetWrapDestination({ 0, MonitorHeight / 2 }, newPos);
+
+            // Assert
+            Assert::IsTrue(wrapped);
+            Assert::AreEqual(MonitorWidth + 2560 - 1, newPos.x);
+            Assert::AreEqual(720L, newPos.y);
+        }
+
+        TEST_METHOD(GetWrapDestination_CornerUsesTheVerticalEdge)
+        {
+            // Arrange
+            MonitorTopology topology;
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, MonitorWidth, 0, 2560, 1440) });
+            POINT newPos{};
+
+            // Act
+            const bool wrapped = topology.GetWrapDestination({ MonitorWidth + 2560 - 1, 1439 }, newPos);
+
+            // Assert
+            // Nothing below the 1440p monitor, so its bottom edge wraps to its own top
+            Assert::IsTrue(wrapped);
+            Assert::AreEqual(MonitorWidth + 2560 - 1, newPos.x);
+            Assert::AreEqual(0L, newPos.y);
+        }
+
+        TEST_METHOD(GetWrapDestination_ScalesDownToASmallerMonitor)
+        {
+            // Arrange
+            MonitorTopology topology;
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, MonitorWidth, 0, 2560, 1440) });
+            POINT newPos{};
+
+            // Act
+            const bool wrapped = topology.GetWrapDestination({ MonitorWidth + 2560 - 1, 1438 }, newPos);
+
+            // Assert
+            Assert::IsTrue(wrapped);
+            Assert::AreEqual(0L, newPos.x);
+            Assert::AreEqual(1078L, newPos.y);
+        }
+
+        TEST_METHOD(GetWrapDestination_IgnoresPointsAwayFromWrappingEdges)
+        {
+            // Arrange
+            MonitorTopology topology;
+            topology.Initialize({ MakeMonitor(0, 0, 0), MakeMonitor(1, MonitorWidth, 0) });
+            POINT newPos{ -1, -1 };
+
+            // Act & Assert
+            Assert::IsFalse(topology.GetWrapDestination({ 500, 500 }, newPos));
+            Assert::IsFalse(topology.GetWrapDestination({ MonitorWidth - 1, 500 }, newPos));
+            Assert::IsFalse(topology.GetWrapDestination({ MonitorWidth, 500 }, newPos));
+            Assert::AreEqual(-1L, newPos.x);
+            Assert::AreEqual(-1L, newPos.y);
+        }
+
+        TEST_METHOD(GridCases_EdgesWrapOnlyWithoutANeighbour)
+        {
+            // Direction numbering of the grid cases: 0=top, 1=right, 2=bottom, 3=left
+            constexpr MonitorEdge directionToEdge[4]{ MonitorEdge::Top, MonitorEdge::Right, MonitorEdge::Bottom, MonitorEdge::Left };
+
+            for (const auto& testCase : CursorWrapTestSuite::GetAllTestCases())
+            {
+                // Arrange
+                std::vector<int> gridIds;
+                MonitorTopology topology;
+
+                // Act
+                topology.Initialize(MonitorsFromGrid(testCase.grid, gridIds));
+
+                // Assert
+                for (const auto& scenario : testCase.scenarios)
+                {
+                    const int source = static_cast<int>(std::find(gridIds.begin(), gridIds.end(), scenario.sourceMonitor) - gridIds.begin());
+                    const auto& transition = topology.GetEdgeTransition(source, directionToEdge[scenario.edgeDirection]);
+
+                    // A scenario that moves to another monitor is left to Windows, the others wrap
+                    const std::wstring message(scenario.description.begin(), scenario.description.end());
+                    Assert::AreEqual(scenario.expectedTargetMonitor == -1, transition.wraps, message.c_str());
+                    if (transition.wraps)
+                    {
+                        Assert::IsTrue(transition.targetMonitor >= 0 && transition.targetMonitor < static_cast<int>(gridIds.size()), message.c_str());
+                    }
+                }
+            }
+        }
+    };
+}
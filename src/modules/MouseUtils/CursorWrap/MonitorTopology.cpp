@@ -0,0 +1,446 @@
+#include "pch.h"
+#include "MonitorTopology.h"
+#include "../../../common/logger/logger.h"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+    LONG ScaleCoordinate(LONG value, const EdgeTransition& transition)
+    {
+        LONG scaled = transition.targetStart + static_cast<LONG>(static_cast<LONGLONG>(value - transition.sourceStart) * transition.targetLength / transition.sourceLength);
+        return std::clamp(scaled, transition.targetStart, transition.targetStart + transition.targetLength - 1);
+    }
+}
+
+void MonitorTopology::Initialize(const std::vector<MonitorInfo>& newMonitors)
+{
+    // Clear existing data
+    monitors = newMonitors;
+    for (auto& row : grid)
+    {
+        row.fill(-1);
+    }
+    positions.assign(monitors.size(), { -1, -1, false });
+    edges.assign(monitors.size(), {});
+
+    if (monitors.empty()) return;
+
+#ifdef _DEBUG
+    Logger::info(L"CursorWrap DEBUG: ======= TOPOLOGY INITIALIZATION START =======");
+    Logger::info(L"CursorWrap DEBUG: Initializing topology for {} monitors", monitors.size());
+    for (const auto& monitor : monitors)
+    {
+        Logger::info(L"CursorWrap DEBUG: Monitor {}: bounds=({},{},{},{}), isPrimary={}",
+                    monitor.monitorId, monitor.rect.left, monitor.rect.top,
+                    monitor.rect.right, monitor.rect.bottom, monitor.isPrimary);
+    }
+#endif
+
+    BuildGrid();
+    BuildEdgeTransitions();
+
+#ifdef _DEBUG
+    // *** CRITICAL: Print topology map using OutputDebugString for debug builds ***
+    Logger::info(L"CursorWrap DEBUG: ======= FINAL TOPOLOGY MAP =======");
+    OutputDebugStringA("CursorWrap TOPOLOGY MAP:\n");
+    for (int r = 0; r < 3; r++)
+    {
+        std::string rowStr = "  ";
+        for (int c = 0; c < 3; c++)
+        {
+            if (grid[r][c] >= 0)
+            {
+                rowStr += std::to_string(monitors[grid[r][c]].monitorId + 1) + " "; // Convert to 1-based for display
+            }
+            else
+            {
+                rowStr += ". ";
+            }
+        }
+        rowStr += "\n";
+        OutputDebugStringA(rowStr.c_str());
+
+        // Also log to PowerToys logger
+        std::wstring wRowStr(rowStr.begin(), rowStr.end());
+        Logger::info(wRowStr.c_str());
+    }
+    OutputDebugStringA("======= END TOPOLOGY MAP =======\n");
+
+    // Additional validation logging
+    Logger::info(L"CursorWrap DEBUG: ======= EDGE TRANSITIONS =======");
+    const wchar_t* edgeNames[4] = { L"Left", L"Right", L"Top", L"Bottom" };
+    for (int i = 0; i < static_cast<int>(monitors.size()); i++)
+    {
+        LogicalPosition pos = GetPosition(i);
+        Logger::info(L"CursorWrap DEBUG: Monitor {} -> grid[{}][{}]", monitors[i].monitorId, pos.row, pos.col);
+        for (int edge = 0; edge < 4; edge++)
+        {
+            const auto& transition = edges[i][edge];
+            if (transition.wraps)
+            {
+                Logger::info(L"CursorWrap DEBUG: Monitor {} {} edge wraps to monitor {} at {}",
+                            monitors[i].monitorId, edgeNames[edge], monitors[transition.targetMonitor].monitorId, transition.landing);
+            }
+            else
+            {
+                Logger::info(L"CursorWrap DEBUG: Monitor {} {} edge has an adjacent monitor (Windows will handle)",
+                            monitors[i].monitorId, edgeNames[edge]);
+            }
+        }
+    }
+    Logger::info(L"CursorWrap DEBUG: ======= TOPOLOGY INITIALIZATION COMPLETE =======");
+#endif
+}
+
+void MonitorTopology::Place(int monitor, int row, int col)
+{
+    grid[row][col] = monitor;
+    positions[monitor] = { row, col, true };
+
+#ifdef _DEBUG
+    const auto& rect = monitors[monitor].rect;
+    Logger::info(L"CursorWrap DEBUG: Monitor {} placed at grid[{}][{}] (left={}, top={}, right={}, bottom={})",
+                monitors[monitor].monitorId, row, col, rect.left, rect.top, rect.right, rect.bottom);
+#endif
+}
+
+void MonitorTopology::BuildGrid()
+{
+    // Special handling for 2 monitors - use physical position, not discovery order
+    if (monitors.size() == 2)
+    {
+        // Determine if arrangement is horizontal or vertical by comparing centers
+        POINT center0 = {(monitors[0].rect.left + monitors[0].rect.right) / 2,
+                        (monitors[0].rect.top + monitors[0].rect.bottom) / 2};
+        POINT center1 = {(monitors[1].rect.left + monitors[1].rect.right) / 2,
+                        (monitors[1].rect.top + monitors[1].rect.bottom) / 2};
+
+        int xDiff = abs(center0.x - center1.x);
+        int yDiff = abs(center0.y - center1.y);
+
+        bool isHorizontal = xDiff > yDiff;
+
+#ifdef _DEBUG
+        Logger::info(L"CursorWrap DEBUG: Monitor centers: M0=({}, {}), M1=({}, {})",
+                    center0.x, center0.y, center1.x, center1.y);
+        Logger::info(L"CursorWrap DEBUG: Differences: X={}, Y={}, IsHorizontal={}",
+                    xDiff, yDiff, isHorizontal);
+#endif
+
+        if (isHorizontal)
+        {
+            // Horizontal arrangement - place in middle row [1,0] and [1,2]
+            for (int i = 0; i < 2; i++)
+            {
+                const auto& rect = monitors[i].rect;
+                LONG centerX = (rect.left + rect.right) / 2;
+
+                int row = 1; // Middle row
+                int col = (centerX < (center0.x + center1.x) / 2) ? 0 : 2; // Left or right based on center
+                Place(i, row, col);
+            }
+        }
+        else
+        {
+            // *** VERTICAL ARRANGEMENT - CRITICAL LOGIC ***
+            // Top monitor at row 0, bottom at row 2, both in the middle column
+            int top = center0.y <= center1.y ? 0 : 1;
+            Place(top, 0, 1);
+            Place(1 - top, 2, 1);
+        }
+        return;
+    }
+
+    // For more than 2 monitors, use edge-based alignment algorithm
+    // This ensures monitors with aligned edges (e.g., top edges at same Y) are grouped in same row
+
+    // Helper lambda to check if two ranges overlap or are adjacent (with tolerance)
+    auto rangesOverlapOrTouch = [](int start1, int end1, int start2, int end2, int tolerance = 50) -> bool {
+        // Check if ranges overlap or are within tolerance distance
+        return (start1 <= end2 + tolerance) && (start2 <= end1 + tolerance);
+    };
+
+    // Sort monitors by horizontal position (left edge) for column assignment
+    std::vector<int> monitorsByX;
+    for (int i = 0; i < static_cast<int>(monitors.size()); i++) {
+        monitorsByX.push_back(i);
+    }
+    std::vector<int> monitorsByY = monitorsByX;
+    std::sort(monitorsByX.begin(), monitorsByX.end(), [this](int a, int b) {
+        return monitors[a].rect.left < monitors[b].rect.left;
+    });
+
+    // Sort monitors by vertical position (top edge) for row assignment
+    std::sort(monitorsByY.begin(), monitorsByY.end(), [this](int a, int b) {
+        return monitors[a].rect.top < monitors[b].rect.top;
+    });
+
+    // Assign rows based on vertical overlap - monitors that overlap vertically should be in same row
+    std::vector<int> monitorToRow(monitors.size(), 0);
+    int currentRow = 0;
+
+    for (size_t i = 0; i < monitorsByY.size(); i++) {
+        const auto& monitor = monitors[monitorsByY[i]];
+
+        // Check if this monitor overlaps vertically with any monitor already assigned to current row
+        bool foundOverlap = false;
+        for (size_t j = 0; j < i; j++) {
+            const auto& other = monitors[monitorsByY[j]];
+            if (monitorToRow[monitorsByY[j]] == currentRow) {
+                // Check vertical overlap
+                if (rangesOverlapOrTouch(monitor.rect.top, monitor.rect.bottom,
+                                        other.rect.top, other.rect.bottom)) {
+                    monitorToRow[monitorsByY[i]] = currentRow;
+                    foundOverlap = true;
+                    break;
+                }
+            }
+        }
+
+        if (!foundOverlap) {
+            // Start new row if no overlap found and we have room
+            if (currentRow < 2 && i < monitorsByY.size() - 1) {
+                currentRow++;
+            }
+            monitorToRow[monitorsByY[i]] = currentRow;
+        }
+    }
+
+    // Assign columns based on horizontal position (left-to-right order)
+    // Monitors are already sorted by X coordinate (left edge)
+    std::vector<int> monitorToCol(monitors.size(), 0);
+
+    // For horizontal arrangement, distribute monitors evenly across columns
+    if (monitorsByX.size() == 1) {
+        // Single monitor - place in middle column
+        monitorToCol[monitorsByX[0]] = 1;
+    }
+    else {
+        // Three or more monitors - distribute across grid
+        for (size_t i = 0; i < monitorsByX.size() && i < 3; i++) {
+            monitorToCol[monitorsByX[i]] = static_cast<int>(i);
+        }
+        // If more than 3 monitors, place extras in rightmost column
+        for (size_t i = 3; i < monitorsByX.size(); i++) {
+            monitorToCol[monitorsByX[i]] = 2;
+        }
+    }
+
+    // Place monitors in grid using the computed row/column assignments
+    for (int i = 0; i < static_cast<int>(monitors.size()); i++)
+    {
+        Place(i, monitorToRow[i], monitorToCol[i]);
+    }
+}
+
+void MonitorTopology::BuildEdgeTransitions()
+{
+    for (int i = 0; i < static_cast<int>(monitors.size()); i++)
+    {
+        const RECT& rect = monitors[i].rect;
+        const LogicalPosition pos = positions[i];
+
+        // The monitor at the far end of the current row or column, in the direction opposite to the edge
+        auto farthest = [&](bool vertical, bool fromEnd) {
+            if (!pos.isValid) return -1;
+            for (int step = 0; step < 3; step++)
+            {
+                int index = fromEnd ? 2 - step : step;
+                int candidate = vertical ? GetMonitorAt(index, pos.col) : GetMonitorAt(pos.row, index);
+                if (candidate >= 0) return candidate;
+            }
+            return -1;
+        };
+
+        for (auto edge : { MonitorEdge::Left, MonitorEdge::Right, MonitorEdge::Top, MonitorEdge::Bottom })
+        {
+            EdgeTransition& transition = edges[i][static_cast<int>(edge)];
+
+            // Only wrap when there's NO adjacent monitor in the coordinate space
+            transition.wraps = !HasAdjacentMonitorInCoordinateSpace(rect, edge);
+            if (!transition.wraps) continue;
+
+            const bool vertical = edge == MonitorEdge::Top || edge == MonitorEdge::Bottom;
+            int target = farthest(vertical, edge == MonitorEdge::Top || edge == MonitorEdge::Left);
+            if (target < 0)
+            {
+                // No other monitor in the stack - wrap within current monitor
+                target = i;
+            }
+            transition.targetMonitor = target;
+
+            const RECT& targetRect = monitors[target].rect;
+            switch (edge)
+            {
+            case MonitorEdge::Top:
+                transition.landing = targetRect.bottom - 1;
+                break;
+            case MonitorEdge::Bottom:
+                transition.landing = targetRect.top;
+                break;
+            case MonitorEdge::Left:
+                transition.landing = targetRect.right - 1;
+                break;
+            case MonitorEdge::Right:
+                transition.landing = targetRect.left;
+                break;
+            }
+
+            // Keep the cursor aligned relative to the monitor sizes on the other axis
+            if (vertical)
+            {
+                transition.sourceStart = rect.left;
+                transition.sourceLength = (std::max)(rect.right - rect.left, 1L);
+                transition.targetStart = targetRect.left;
+                transition.targetLength = (std::max)(targetRect.right - targetRect.left, 1L);
+            }
+            else
+            {
+                transition.sourceStart = rect.top;
+                transition.sourceLength = (std::max)(rect.bottom - rect.top, 1L);
+                transition.targetStart = targetRect.top;
+                transition.targetLength = (std::max)(targetRect.bottom - targetRect.top, 1L);
+            }
+        }
+    }
+}
+
+// Helper method to check if there's a monitor adjacent in coordinate space (not grid)
+bool MonitorTopology::HasAdjacentMonitorInCoordinateSpace(const RECT& currentMonitorRect, MonitorEdge edge) const
+{
+    const int tolerance = 50; // Allow small gaps
+
+    for (const auto& monitor : monitors)
+    {
+        bool isAdjacent = false;
+
+        switch (edge)
+        {
+        case MonitorEdge::Left: // Check if another monitor's right edge touches/overlaps our left edge
+            isAdjacent = (abs(monitor.rect.right - currentMonitorRect.left) <= tolerance) &&
+                        (monitor.rect.bottom > currentMonitorRect.top + tolerance) &&
+                        (monitor.rect.top < currentMonitorRect.bottom - tolerance);
+            break;
+
+        case MonitorEdge::Right: // Check if another monitor's left edge touches/overlaps our right edge
+            isAdjacent = (abs(monitor.rect.left - currentMonitorRect.right) <= tolerance) &&
+                        (monitor.rect.bottom > currentMonitorRect.top + tolerance) &&
+                        (monitor.rect.top < currentMonitorRect.bottom - tolerance);
+            break;
+
+        case MonitorEdge::Top: // Check if another monitor's bottom edge touches/overlaps our top edge
+            isAdjacent = (abs(monitor.rect.bottom - currentMonitorRect.top) <= tolerance) &&
+                        (monitor.rect.right > currentMonitorRect.left + tolerance) &&
+                        (monitor.rect.left < currentMonitorRect.right - tolerance);
+            break;
+
+        case MonitorEdge::Bottom: // Check if another monitor's top edge touches/overlaps our bottom edge
+            isAdjacent = (abs(monitor.rect.top - currentMonitorRect.bottom) <= tolerance) &&
+                        (monitor.rect.right > currentMonitorRect.left + tolerance) &&
+                        (monitor.rect.left < currentMonitorRect.right - tolerance);
+            break;
+        }
+
+        if (isAdjacent)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+LogicalPosition MonitorTopology::GetPosition(int monitor) const
+{
+    if (monitor >= 0 && monitor < static_cast<int>(positions.size()))
+    {
+        return positions[monitor];
+    }
+    return {-1, -1, false};
+}
+
+int MonitorTopology::GetMonitorAt(int row, int col) const
+{
+    if (row >= 0 && row < 3 && col >= 0 && col < 3)
+    {
+        return grid[row][col];
+    }
+    return -1;
+}
+
+int MonitorTopology::FindAdjacentMonitor(int current, int deltaRow, int deltaCol) const
+{
+    LogicalPosition currentPos = GetPosition(current);
+    if (!currentPos.isValid) return -1;
+
+    int newRow = currentPos.row + deltaRow;
+    int newCol = currentPos.col + deltaCol;
+
+    return GetMonitorAt(newRow, newCol);
+}
+
+const EdgeTransition& MonitorTopology::GetEdgeTransition(int monitor, MonitorEdge edge) const
+{
+    return edges[monitor][static_cast<int>(edge)];
+}
+
+int MonitorTopology::MonitorFromPoint(const POINT& pt) const
+{
+    int nearest = -1;
+    LONGLONG nearestDistance = 0;
+    for (int i = 0; i < static_cast<int>(monitors.size()); i++)
+    {
+        const RECT& rect = monitors[i].rect;
+        LONGLONG dx = (std::max)({ rect.left - pt.x, 0L, pt.x - (rect.right - 1) });
+        LONGLONG dy = (std::max)({ rect.top - pt.y, 0L, pt.y - (rect.bottom - 1) });
+        LONGLONG distance = dx * dx + dy * dy;
+        if (distance == 0)
+        {
+            return i;
+        }
+        if (nearest < 0 || distance < nearestDistance)
+        {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+bool MonitorTopology::GetWrapDestination(const POINT& pt, POINT& newPos) const
+{
+    const int current = MonitorFromPoint(pt);
+    if (current < 0)
+    {
+        return false;
+    }
+
+    const RECT& rect = monitors[current].rect;
+
+    // Vertical edges take precedence, and an adjacent monitor there stops any wrapping
+    if (pt.y <= rect.top || pt.y >= rect.bottom - 1)
+    {
+        const auto& transition = edges[current][static_cast<int>(pt.y <= rect.top ? MonitorEdge::Top : MonitorEdge::Bottom)];
+        if (!transition.wraps)
+        {
+            return false;
+        }
+        newPos = { ScaleCoordinate(pt.x, transition), transition.landing };
+        return true;
+    }
+
+    if (pt.x <= rect.left || pt.x >= rect.right - 1)
+    {
+        const auto& transition = edges[current][static_cast<int>(pt.x <= rect.left ? MonitorEdge::Left : MonitorEdge::Right)];
+        if (!transition.wraps)
+        {
+            return false;
+        }
+        newPos = { transition.landing, ScaleCoordinate(pt.y, transition) };
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <windows.h>
+
+#include <array>
+#include <vector>
+
+struct MonitorInfo
+{
+    RECT rect;
+    bool isPrimary;
+    int monitorId; // Add monitor ID for easier debugging
+};
+
+// Add structure for logical monitor grid position
+struct LogicalPosition
+{
+    int row;
+    int col;
+    bool isValid;
+};
+
+// Same numbering as the adjacency checks: 0=left, 1=right, 2=top, 3=bottom
+enum class MonitorEdge
+{
+    Left = 0,
+    Right = 1,
+    Top = 2,
+    Bottom = 3,
+};
+
+// What happens when the cursor reaches one edge of a monitor, computed once per topology.
+struct EdgeTransition
+{
+    // False when another monitor touches this edge, Windows moves the cursor there by itself.
+    bool wraps = false;
+
+    // Monitor the cursor wraps to, which can be the monitor itself.
+    int targetMonitor = -1;
+
+    // Coordinate the cursor lands on: x for the left and right edges, y for the top and bottom edges.
+    LONG landing = 0;
+
+    // The other coordinate is scaled from the source range to the target range, then clamped to it.
+    LONG sourceStart = 0;
+    LONG sourceLength = 1;
+    LONG targetStart = 0;
+    LONG targetLength = 1;
+};
+
+// Monitors are referred to by their index in the list given to Initialize, -1 means no monitor.
+// Nothing here calls into Windows, so the topology can be built from synthetic layouts.
+struct MonitorTopology
+{
+    void Initialize(const std::vector<MonitorInfo>& monitors);
+
+    const std::vector<MonitorInfo>& GetMonitors() const { return monitors; }
+    LogicalPosition GetPosition(int monitor) const;
+    int GetMonitorAt(int row, int col) const;
+    int FindAdjacentMonitor(int current, int deltaRow, int deltaCol) const;
+    const EdgeTransition& GetEdgeTransition(int monitor, MonitorEdge edge) const;
+
+    // Same as MonitorFromPoint with MONITOR_DEFAULTTONEAREST
+    int MonitorFromPoint(const POINT& pt) const;
+
+    // Returns true and sets newPos when the point is on an edge that wraps.
+    // Only reads the precomputed tables, it's called from the mouse hook for every move.
+    bool GetWrapDestination(const POINT& pt, POINT& newPos) const;
+
+private:
+    void BuildGrid();
+    void BuildEdgeTransitions();
+    bool HasAdjacentMonitorInCoordinateSpace(const RECT& currentMonitorRect, MonitorEdge edge) const;
+    void Place(int monitor, int row, int col);
+
+    std::vector<MonitorInfo> monitors;
+    std::array<std::array<int, 3>, 3> grid{}; // 3x3 grid of monitors
+    std::vector<LogicalPosition> positions;
+    std::vector<std::array<EdgeTransition, 4>> edges;
+};
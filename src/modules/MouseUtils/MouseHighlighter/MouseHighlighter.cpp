@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "MouseHighlighter.h"
 #include "trace.h"
+#include <interface/mouse_hook_service.h>
 #include <cmath>
 #include <algorithm>
 
@@ -23,6 +24,8 @@ namespace ABI
 
 struct Highlighter
 {
+    explicit Highlighter(MouseHookService* mouseHookService) :
+        m_mouseHookService(mouseHookService) {}
     bool MyRegisterClass(HINSTANCE hInstance);
     static Highlighter* instance;
     void Terminate();
@@ -48,8 +51,9 @@ private:
     void ClearDrawingPoint();
     void ClearDrawing();
     void BringToFront();
-    HHOOK m_mouseHook = NULL;
-    static LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) noexcept;
+    MouseHookService* m_mouseHookService = nullptr;
+    MouseEventRing* m_mouseEvents = nullptr;
+    static void OnMouseEvent(const LowlevelMouseEvent& event) noexcept;
     // Helpers for spotlight overlay
     float GetDpiScale() const;
     void UpdateSpotlightMask(float cx, float cy, float radius, bool show);
@@ -60,6 +64,7 @@ private:
     HWND m_hwnd = NULL;
     HINSTANCE m_hinstance = NULL;
     static constexpr DWORD WM_SWITCH_ACTIVATION_MODE = WM_APP;
+    static constexpr DWORD WM_MOUSE_HOOK_EVENTS = WM_APP + 1;
 
     winrt::DispatcherQueueController m_dispatcherQueueController{ nullptr };
     winrt::Compositor m_compositor{ nullptr };
@@ -321,103 +326,98 @@ void Highlighter::ClearDrawing()
     m_shape.Shapes().Clear();
 }
 
-LRESULT CALLBACK Highlighter::MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) noexcept
+void Highlighter::OnMouseEvent(const LowlevelMouseEvent& event) noexcept
 {
-    if (nCode >= 0)
+    switch (event.message)
     {
-        MSLLHOOKSTRUCT* hookData = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
-        switch (wParam)
+    case WM_LBUTTONDOWN:
+        if (instance->m_leftPointerEnabled)
         {
-        case WM_LBUTTONDOWN:
-            if (instance->m_leftPointerEnabled)
+            if (instance->m_alwaysPointerEnabled && !instance->m_rightButtonPressed)
             {
-                if (instance->m_alwaysPointerEnabled && !instance->m_rightButtonPressed)
-                {
-                    // Clear AlwaysPointer only when it's enabled and RightPointer is not active
-                    instance->ClearDrawingPoint();
-                }
-                if (instance->m_leftButtonPressed)
-                {
-                    // There might be a stray point from the user releasing the mouse button on an elevated window, which wasn't caught by us.
-                    instance->StartDrawingPointFading(MouseButton::Left);
-                }
-
-                instance->AddDrawingPoint(MouseButton::Left);
-                instance->m_leftButtonPressed = true;
-                // start a timer for the scenario, when the user clicks a pinned window which has no focus.
-                // after we drow the highlighting circle the pinned window will jump in front of us,
-                // we have to bring our window back to topmost position
-                if (instance->m_timer_id == 0)
-                {
-                    instance->m_timer_id = SetTimer(instance->m_hwnd, BRING_TO_FRONT_TIMER_ID, 10, nullptr);
-                }
+                // Clear AlwaysPointer only when it's enabled and RightPointer is not active
+                instance->ClearDrawingPoint();
             }
-            break;
-        case WM_RBUTTONDOWN:
-            if (instance->m_rightPointerEnabled)
+            if (instance->m_leftButtonPressed)
             {
-                if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed)
-                {
-                    // Clear AlwaysPointer only when it's enabled and LeftPointer is not active
-                    instance->ClearDrawingPoint();
-                }
-                if (instance->m_rightButtonPressed)
-                {
-                    // There might be a stray point from the user releasing the mouse button on an elevated window, which wasn't caught by us.
-                    instance->StartDrawingPointFading(MouseButton::Right);
-                }
-                instance->AddDrawingPoint(MouseButton::Right);
-                instance->m_rightButtonPressed = true;
-                // same as for the left button, start a timer for reposition ourselves to topmost position
-                if (instance->m_timer_id == 0)
-                {
-                    instance->m_timer_id = SetTimer(instance->m_hwnd, BRING_TO_FRONT_TIMER_ID, 10, nullptr);
-                }
+                // There might be a stray point from the user releasing the mouse button on an elevated window, which wasn't caught by us.
+                instance->StartDrawingPointFading(MouseButton::Left);
             }
-            break;
-        case WM_MOUSEMOVE:
-            if (instance->m_leftButtonPressed)
+
+            instance->AddDrawingPoint(MouseButton::Left);
+            instance->m_leftButtonPressed = true;
+            // start a timer for the scenario, when the user clicks a pinned window which has no focus.
+            // after we drow the highlighting circle the pinned window will jump in front of us,
+            // we have to bring our window back to topmost position
+            if (instance->m_timer_id == 0)
+            {
+                instance->m_timer_id = SetTimer(instance->m_hwnd, BRING_TO_FRONT_TIMER_ID, 10, nullptr);
+            }
+        }
+        break;
+    case WM_RBUTTONDOWN:
+        if (instance->m_rightPointerEnabled)
+        {
+            if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed)
             {
-                instance->UpdateDrawingPointPosition(MouseButton::Left);
+                // Clear AlwaysPointer only when it's enabled and LeftPointer is not active
+                instance->ClearDrawingPoint();
             }
             if (instance->m_rightButtonPressed)
             {
-                instance->UpdateDrawingPointPosition(MouseButton::Right);
+                // There might be a stray point from the user releasing the mouse button on an elevated window, which wasn't caught by us.
+                instance->StartDrawingPointFading(MouseButton::Right);
             }
-            if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed && !instance->m_rightButtonPressed)
+            instance->AddDrawingPoint(MouseButton::Right);
+            instance->m_rightButtonPressed = true;
+            // same as for the left button, start a timer for reposition ourselves to topmost position
+            if (instance->m_timer_id == 0)
             {
-                instance->UpdateDrawingPointPosition(MouseButton::None);
+                instance->m_timer_id = SetTimer(instance->m_hwnd, BRING_TO_FRONT_TIMER_ID, 10, nullptr);
             }
-            break;
-        case WM_LBUTTONUP:
-            if (instance->m_leftButtonPressed)
+        }
+        break;
+    case WM_MOUSEMOVE:
+        if (instance->m_leftButtonPressed)
+        {
+            instance->UpdateDrawingPointPosition(MouseButton::Left);
+        }
+        if (instance->m_rightButtonPressed)
+        {
+            instance->UpdateDrawingPointPosition(MouseButton::Right);
+        }
+        if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed && !instance->m_rightButtonPressed)
+        {
+            instance->UpdateDrawingPointPosition(MouseButton::None);
+        }
+        break;
+    case WM_LBUTTONUP:
+        if (instance->m_leftButtonPressed)
+        {
+            instance->StartDrawingPointFading(MouseButton::Left);
+            instance->m_leftButtonPressed = false;
+            if (instance->m_alwaysPointerEnabled && !instance->m_rightButtonPressed)
             {
-                instance->StartDrawingPointFading(MouseButton::Left);
-                instance->m_leftButtonPressed = false;
-                if (instance->m_alwaysPointerEnabled && !instance->m_rightButtonPressed)
-                {
-                    // Add AlwaysPointer only when it's enabled and RightPointer is not active
-                    instance->AddDrawingPoint(MouseButton::None);
-                }
+                // Add AlwaysPointer only when it's enabled and RightPointer is not active
+                instance->AddDrawingPoint(MouseButton::None);
             }
-            break;
-        case WM_RBUTTONUP:
-            if (instance->m_rightButtonPressed)
+        }
+        break;
+    case WM_RBUTTONUP:
+        if (instance->m_rightButtonPressed)
+        {
+            instance->StartDrawingPointFading(MouseButton::Right);
+            instance->m_rightButtonPressed = false;
+            if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed)
             {
-                instance->StartDrawingPointFading(MouseButton::Right);
-                instance->m_rightButtonPressed = false;
-                if (instance->m_alwaysPointerEnabled && !instance->m_leftButtonPressed)
-                {
-                    // Add AlwaysPointer only when it's enabled and LeftPointer is not active
-                    instance->AddDrawingPoint(MouseButton::None);
-                }
+                // Add AlwaysPointer only when it's enabled and LeftPointer is not active
+                instance->AddDrawingPoint(MouseButton::None);
             }
-            break;
-        default:
-            break;
         }
+        break;
+    default:
+        break;
     }
-    return CallNextHookEx(0, nCode, wParam, lParam);
 }
 
 void Highlighter::StartDrawing()
@@ -439,7 +439,14 @@ void Highlighter::StartDrawing()
 
     instance->AddDrawingPoint(Highlighter::MouseButton::None);
 
-    m_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseHookProc, m_hinstance, 0);
+    if (m_mouseHookService)
+    {
+        m_mouseEvents = m_mouseHookService->Subscribe({ .name = L"MouseHighlighter", .notifyWindow = m_hwnd, .notifyMessage = WM_MOUSE_HOOK_EVENTS });
+    }
+    if (!m_mouseEvents)
+    {
+        Logger::error("Couldn't subscribe to the mouse hook.");
+    }
 }
 
 void Highlighter::StopDrawing()
@@ -456,9 +463,12 @@ void Highlighter::StopDrawing()
         m_overlay.IsVisible(false);
     }
     ShowWindow(m_hwnd, SW_HIDE);
-    UnhookWindowsHookEx(m_mouseHook);
+    if (m_mouseEvents)
+    {
+        m_mouseHookService->Unsubscribe(m_mouseEvents);
+        m_mouseEvents = nullptr;
+    }
     ClearDrawing();
-    m_mouseHook = NULL;
 }
 
 void Highlighter::SwitchActivationMode()
@@ -535,6 +545,12 @@ LRESULT CALLBACK Highlighter::WndProc(HWND hWnd, UINT message, WPARAM wParam, LP
             instance->StartDrawing();
         }
         break;
+    case WM_MOUSE_HOOK_EVENTS:
+        if (instance->m_mouseEvents)
+        {
+            instance->m_mouseEvents->Drain(OnMouseEvent);
+        }
+        break;
     case WM_DESTROY:
         instance->DestroyHighlighter();
         break;
@@ -677,7 +693,7 @@ bool MouseHighlighterIsEnabled()
     return (Highlighter::instance != nullptr);
 }
 
-int MouseHighlighterMain(HINSTANCE hInstance, MouseHighlighterSettings settings)
+int MouseHighlighterMain(HINSTANCE hInstance, MouseHighlighterSettings settings, MouseHookService* mouseHookService)
 {
     Logger::info("Starting a highlighter instance.");
     if (Highlighter::instance != nullptr)
@@ -687,7 +703,7 @@ int MouseHighlighterMain(HINSTANCE hInstance, MouseHighlighterSettings settings)
     }
 
     // Perform application initialization:
-    Highlighter highlighter;
+    Highlighter highlighter(mouseHookService);
     Highlighter::instance = &highlighter;
     highlighter.ApplySettings(settings);
     if (!highlighter.MyRegisterClass(hInstance))
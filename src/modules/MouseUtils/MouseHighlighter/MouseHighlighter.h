@@ -1,6 +1,8 @@
 #pragma once
 #include "pch.h"
 
+class MouseHookService;
+
 const winrt::Windows::UI::Color MOUSE_HIGHLIGHTER_DEFAULT_LEFT_BUTTON_COLOR = winrt::Windows::UI::ColorHelper::FromArgb(166, 255, 255, 0);
 const winrt::Windows::UI::Color MOUSE_HIGHLIGHTER_DEFAULT_RIGHT_BUTTON_COLOR = winrt::Windows::UI::ColorHelper::FromArgb(166, 0, 0, 255);
 const winrt::Windows::UI::Color MOUSE_HIGHLIGHTER_DEFAULT_ALWAYS_COLOR = winrt::Windows::UI::ColorHelper::FromArgb(0, 255, 0, 0);
@@ -21,7 +23,7 @@ struct MouseHighlighterSettings
     bool spotlightMode = false;
 };
 
-int MouseHighlighterMain(HINSTANCE hinst, MouseHighlighterSettings settings);
+int MouseHighlighterMain(HINSTANCE hinst, MouseHighlighterSettings settings, MouseHookService* mouseHookService);
 void MouseHighlighterDisable();
 bool MouseHighlighterIsEnabled();
 void MouseHighlighterSwitch();
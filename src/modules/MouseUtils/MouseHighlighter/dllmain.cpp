@@ -66,6 +66,9 @@ private:
     // Event-driven trigger support
     EventWaiter m_triggerEventWaiter;
 
+    // The runner's shared low level mouse hook
+    MouseHookService* m_mouseHookService = nullptr;
+
 public:
     // Constructor
     MouseHighlighter()
@@ -133,12 +136,17 @@ public:
         }
     }
 
+    virtual void set_mouse_hook_service(MouseHookService* service) override
+    {
+        m_mouseHookService = service;
+    }
+
     // Enable the powertoy
     virtual void enable()
     {
         m_enabled = true;
         Trace::EnableMouseHighlighter(true);
-        std::thread([=]() { MouseHighlighterMain(m_hModule, m_highlightSettings); }).detach();
+        std::thread([=]() { MouseHighlighterMain(m_hModule, m_highlightSettings, m_mouseHookService); }).detach();
 
         // Start listening for external trigger event so we can invoke the same logic as the hotkey.
         m_triggerEventWaiter.start(CommonSharedConstants::MOUSE_HIGHLIGHTER_TRIGGER_EVENT, [this](DWORD) {
@@ -258,6 +258,11 @@ public:
         Trace::EnableJumpTool(false);
     }
 
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        return m_enabled;
+    }
+
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
         if (m_enabled)
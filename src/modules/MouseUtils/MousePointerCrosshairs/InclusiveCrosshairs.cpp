@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "InclusiveCrosshairs.h"
 #include "trace.h"
+#include <interface/mouse_hook_service.h>
 
 #ifdef COMPOSITION
 namespace winrt
@@ -21,6 +22,8 @@ namespace ABI
 
 struct InclusiveCrosshairs
 {
+    explicit InclusiveCrosshairs(MouseHookService* mouseHookService) :
+        m_mouseHookService(mouseHookService) {}
     bool MyRegisterClass(HINSTANCE hInstance);
     static InclusiveCrosshairs* instance;
     void Terminate();
@@ -80,14 +83,13 @@ public:
                 if (instance != nullptr)
                 {
                     instance->m_externalControl = enabled;
-                    if (enabled && instance->m_mouseHook)
+                    if (enabled)
                     {
-                        UnhookWindowsHookEx(instance->m_mouseHook);
-                        instance->m_mouseHook = NULL;
+                        instance->UnsubscribeMouseEvents();
                     }
-                    else if (!enabled && instance->m_drawing && !instance->m_mouseHook)
+                    else if (instance->m_drawing)
                     {
-                        instance->m_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseHookProc, instance->m_hinstance, 0);
+                        instance->SubscribeMouseEvents();
                     }
                 }
             });
@@ -122,8 +124,11 @@ private:
     void StopDrawing();
     bool CreateInclusiveCrosshairs();
     void UpdateCrosshairsPosition();
-    HHOOK m_mouseHook = NULL;
-    static LRESULT CALLBACK MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) noexcept;
+    void SubscribeMouseEvents();
+    void UnsubscribeMouseEvents();
+    void OnMouseEvents();
+    MouseHookService* m_mouseHookService = nullptr;
+    MouseEventRing* m_mouseEvents = nullptr;
 
     static constexpr auto m_className = L"MousePointerCrosshairs";
     static constexpr auto m_windowTitle = L"PowerToys Mouse Pointer Crosshairs";
@@ -132,6 +137,7 @@ private:
     HWND m_hwnd = NULL;
     HINSTANCE m_hinstance = NULL;
     static constexpr DWORD WM_SWITCH_ACTIVATION_MODE = WM_APP;
+    static constexpr DWORD WM_MOUSE_HOOK_EVENTS = WM_APP + 1;
 
     winrt::DispatcherQueueController m_dispatcherQueueController{ nullptr };
     winrt::Compositor m_compositor{ nullptr };
@@ -359,20 +365,41 @@ void InclusiveCrosshairs::UpdateCrosshairsPosition()
     }
 }
 
-LRESULT CALLBACK InclusiveCrosshairs::MouseHookProc(int nCode, WPARAM wParam, LPARAM lParam) noexcept
+void InclusiveCrosshairs::SubscribeMouseEvents()
 {
-    if (nCode >= 0)
+    if (m_mouseEvents || !m_mouseHookService)
     {
-        MSLLHOOKSTRUCT* hookData = reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
-        if (instance && !instance->m_externalControl)
-        {
-            if (wParam == WM_MOUSEMOVE)
-            {
-                instance->UpdateCrosshairsPosition();
-            }
-        }
+        return;
+    }
+
+    m_mouseEvents = m_mouseHookService->Subscribe({ .name = L"MousePointerCrosshairs", .notifyWindow = m_hwnd, .notifyMessage = WM_MOUSE_HOOK_EVENTS });
+    if (!m_mouseEvents)
+    {
+        Logger::error("Couldn't subscribe to the mouse hook.");
+    }
+}
+
+void InclusiveCrosshairs::UnsubscribeMouseEvents()
+{
+    if (m_mouseEvents)
+    {
+        m_mouseHookService->Unsubscribe(m_mouseEvents);
+        m_mouseEvents = nullptr;
+    }
+}
+
+void InclusiveCrosshairs::OnMouseEvents()
+{
+    bool moved = false;
+    m_mouseEvents->Drain([&moved](const LowlevelMouseEvent& event) {
+        moved |= event.message == WM_MOUSEMOVE;
+    });
+
+    // The crosshairs follow the cursor, so one update covers every queued move
+    if (moved && !m_externalControl)
+    {
+        UpdateCrosshairsPosition();
     }
-    return CallNextHookEx(0, nCode, wParam, lParam);
 }
 
 void InclusiveCrosshairs::StartDrawing()
@@ -400,7 +427,10 @@ void InclusiveCrosshairs::StartDrawing()
     }
 
     m_drawing = true;
-    m_mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseHookProc, m_hinstance, 0);
+    if (!m_externalControl)
+    {
+        SubscribeMouseEvents();
+    }
 }
 
 void InclusiveCrosshairs::StopDrawing()
@@ -408,8 +438,7 @@ void InclusiveCrosshairs::StopDrawing()
     Logger::info("Stop drawing crosshairs.");
     m_drawing = false;
     ShowWindow(m_hwnd, SW_HIDE);
-    UnhookWindowsHookEx(m_mouseHook);
-    m_mouseHook = NULL;
+    UnsubscribeMouseEvents();
     KillTimer(m_hwnd, AUTO_HIDE_TIMER_ID);
 }
 
@@ -512,6 +541,12 @@ LRESULT CALLBACK InclusiveCrosshairs::WndProc(HWND hWnd, UINT message, WPARAM wP
             instance->StartDrawing();
         }
         break;
+    case WM_MOUSE_HOOK_EVENTS:
+        if (instance->m_mouseEvents)
+        {
+            instance->OnMouseEvents();
+        }
+        break;
     case WM_DESTROY:
         instance->DestroyInclusiveCrosshairs();
         break;
@@ -656,7 +691,7 @@ void InclusiveCrosshairsSetOrientation(CrosshairsOrientation orientation)
     InclusiveCrosshairs::SetCrosshairsOrientation(orientation);
 }
 
-int InclusiveCrosshairsMain(HINSTANCE hInstance, InclusiveCrosshairsSettings& settings)
+int InclusiveCrosshairsMain(HINSTANCE hInstance, InclusiveCrosshairsSettings& settings, MouseHookService* mouseHookService)
 {
     Logger::info("Starting a crosshairs instance.");
     if (InclusiveCrosshairs::instance != nullptr)
@@ -666,7 +701,7 @@ int InclusiveCrosshairsMain(HINSTANCE hInstance, InclusiveCrosshairsSettings& se
     }
 
     // Perform application initialization:
-    InclusiveCrosshairs crosshairs;
+    InclusiveCrosshairs crosshairs(mouseHookService);
     InclusiveCrosshairs::instance = &crosshairs;
     crosshairs.ApplySettings(settings, false);
     if (!crosshairs.MyRegisterClass(hInstance))
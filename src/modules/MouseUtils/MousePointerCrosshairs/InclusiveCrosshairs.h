@@ -1,6 +1,8 @@
 #pragma once
 #include "pch.h"
 
+class MouseHookService;
+
 constexpr int INCLUSIVE_MOUSE_DEFAULT_CROSSHAIRS_OPACITY = 75;
 const winrt::Windows::UI::Color INCLUSIVE_MOUSE_DEFAULT_CROSSHAIRS_COLOR = winrt::Windows::UI::ColorHelper::FromArgb(255, 255, 0, 0);
 const winrt::Windows::UI::Color INCLUSIVE_MOUSE_DEFAULT_CROSSHAIRS_BORDER_COLOR = winrt::Windows::UI::ColorHelper::FromArgb(255, 255, 255, 255);
@@ -35,7 +37,7 @@ struct InclusiveCrosshairsSettings
     bool autoActivate = INCLUSIVE_MOUSE_DEFAULT_AUTO_ACTIVATE;
 };
 
-int InclusiveCrosshairsMain(HINSTANCE hinst, InclusiveCrosshairsSettings& settings);
+int InclusiveCrosshairsMain(HINSTANCE hinst, InclusiveCrosshairsSettings& settings, MouseHookService* mouseHookService);
 void InclusiveCrosshairsDisable();
 bool InclusiveCrosshairsIsEnabled();
 void InclusiveCrosshairsSwitch();
@@ -128,6 +128,9 @@ private:
     // Event-driven trigger support
     EventWaiter m_triggerEventWaiter;
 
+    // The runner's shared low level mouse hook
+    MouseHookService* m_mouseHookService = nullptr;
+
 public:
     // Constructor
     MousePointerCrosshairs()
@@ -199,12 +202,17 @@ public:
         }
     }
 
+    virtual void set_mouse_hook_service(MouseHookService* service) override
+    {
+        m_mouseHookService = service;
+    }
+
     // Enable the powertoy
     virtual void enable()
     {
         m_enabled = true;
         Trace::EnableMousePointerCrosshairs(true);
-        std::thread([=]() { InclusiveCrosshairsMain(m_hModule, m_inclusiveCrosshairsSettings); }).detach();
+        std::thread([=]() { InclusiveCrosshairsMain(m_hModule, m_inclusiveCrosshairsSettings, m_mouseHookService); }).detach();
 
         // Start listening for external trigger event so we can invoke the same logic as the activation hotkey.
         m_triggerEventWaiter.start(CommonSharedConstants::MOUSE_CROSSHAIRS_TRIGGER_EVENT, [this](DWORD) {
@@ -249,6 +257,12 @@ public:
         return 2;
     }
 
+    // Crosshairs and gliding cursor activation, the hotkeys on_hotkey handles
+    virtual bool should_swallow_hotkey(size_t hotkeyId) override
+    {
+        return m_enabled && (hotkeyId == 0 || hotkeyId == 1);
+    }
+
     virtual bool on_hotkey(size_t hotkeyId) override
     {
         if (!m_enabled)
@@ -261,6 +261,11 @@ public:
         Trace::EnablePowerOCR(false);
     }
 
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        return m_enabled;
+    }
+
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
         if (m_enabled)
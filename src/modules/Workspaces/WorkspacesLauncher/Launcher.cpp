@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Launcher.h"
 
+#include <common/SettingsAPI/settings_objects.h>
 #include <common/utils/json.h>
 
 #include <workspaces-common/MonitorUtils.h>
@@ -10,6 +11,53 @@
 #include <AppLauncher.h>
 #include <WorkspacesLib/AppUtils.h>
 
+namespace NonLocalizable
+{
+    const wchar_t ModuleKey[] = L"Workspaces";
+    const wchar_t LaunchConcurrencyID[] = L"launch-concurrency";
+}
+
+namespace
+{
+    constexpr int DefaultLaunchConcurrency = 4;
+    constexpr int MaxLaunchConcurrency = 16;
+
+    // Packaged apps are looked up through the package manager or activated by the shell, which takes
+    // much longer than starting an executable
+    int LaunchCost(const WorkspacesData::WorkspacesProject::Application& app)
+    {
+        if (!app.packageFullName.empty())
+        {
+            return 2;
+        }
+
+        if (!app.appUserModelId.empty() || !app.pwaAppId.empty())
+        {
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int ReadLaunchConcurrency()
+    {
+        try
+        {
+            auto settings = PowerToysSettings::PowerToyValues::load_from_settings_file(NonLocalizable::ModuleKey);
+            if (auto value = settings.get_int_value(NonLocalizable::LaunchConcurrencyID); value.has_value())
+            {
+                return std::clamp(value.value(), 1, MaxLaunchConcurrency);
+            }
+        }
+        catch (const std::exception&)
+        {
+            Logger::warn(L"An exception occurred while loading the settings file");
+        }
+
+        return DefaultLaunchConcurrency;
+    }
+}
+
 Launcher::Launcher(const WorkspacesData::WorkspacesProject& project, 
     std::vector<WorkspacesData::WorkspacesProject>& workspaces,
     InvokePoint invokePoint) :
@@ -96,15 +144,59 @@ Launcher::~Launcher()
 }
 
 void Launcher::Launch() // Launching thread
+{
+    // Instances of the same app are launched one after another, different apps at the same time
+    std::vector<std::vector<WorkspacesData::WorkspacesProject::Application>> appGroups;
+    for (const auto& app : m_project.apps)
+    {
+        auto appState = m_launchingStatus.Get(app);
+        if (!appState.has_value() || appState.value().state != LaunchingState::Waiting)
+        {
+            continue;
+        }
+
+        auto group = std::find_if(appGroups.begin(), appGroups.end(), [&](const auto& val) { return val.front().name == app.name || val.front().path == app.path; });
+        if (group != appGroups.end())
+        {
+            group->push_back(app);
+        }
+        else
+        {
+            appGroups.push_back({ app });
+        }
+    }
+
+    // Start the slow launches first, so they don't hold up the end of the launch
+    std::stable_sort(appGroups.begin(), appGroups.end(), [](const auto& lhs, const auto& rhs) { return LaunchCost(lhs.front()) > LaunchCost(rhs.front()); });
+
+    const size_t concurrency = (std::min)(static_cast<size_t>(ReadLaunchConcurrency()), appGroups.size());
+    Logger::info(L"Launching {} apps, {} at a time", m_project.apps.size(), concurrency);
+
+    std::atomic<size_t> nextGroup = 0;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < concurrency; i++)
+    {
+        threads.emplace_back([&]() {
+            for (size_t group = nextGroup++; group < appGroups.size(); group = nextGroup++)
+            {
+                LaunchInstances(appGroups[group]);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void Launcher::LaunchInstances(const std::vector<WorkspacesData::WorkspacesProject::Application>& instances) // Launching thread
 {
     const long maxWaitTimeMs = 3000;
     const long ms = 100;
 
-    // Launch apps
-    for (auto appState = m_launchingStatus.GetNext(LaunchingState::Waiting);appState.has_value();appState = m_launchingStatus.GetNext(LaunchingState::Waiting))
+    for (const auto& app : instances)
     {
-        auto app = appState.value().application;
-        
         long waitingTime = 0;
         bool additionalWait = false;
         while (!m_launchingStatus.AllInstancesOfTheAppLaunchedAndMoved(app) && waitingTime < maxWaitTimeMs)
@@ -128,37 +220,55 @@ void Launcher::Launch() // Launching thread
             Logger::info(L"Waiting time for launching next {} instance expired", app.name);
         }
 
-        bool launched{ false };
+        // canceled while waiting
+        auto appState = m_launchingStatus.Get(app);
+        if (!appState.has_value() || appState.value().state != LaunchingState::Waiting)
         {
-            std::lock_guard lock(m_launchErrorsMutex);
-            launched = AppLauncher::Launch(app, m_launchErrors);
+            continue;
         }
 
-        if (launched)
-        {
-            m_launchingStatus.Update(app, LaunchingState::Launched);
-        }
-        else
-        {
-            Logger::error(L"Failed to launch {}", app.name);
-            m_launchingStatus.Update(app, LaunchingState::Failed);
-            m_launchedSuccessfully = false;
-        }
+        LaunchApp(app);
+    }
+}
 
-        auto status = m_launchingStatus.Get(app); // updated after launch status 
-        if (status.has_value())
-        {
-            {
-                std::lock_guard lock(m_windowArrangerHelperMutex);
-                m_windowArrangerHelper->UpdateLaunchStatus(status.value());
-            }
-        }
+void Launcher::LaunchApp(const WorkspacesData::WorkspacesProject::Application& app) // Launching thread
+{
+    AppLauncher::ErrorList launchErrors{};
+    const auto launchStart = std::chrono::steady_clock::now();
+    bool launched = AppLauncher::Launch(app, launchErrors);
+    const auto launchTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - launchStart);
+
+    if (!launchErrors.empty())
+    {
+        std::lock_guard lock(m_launchErrorsMutex);
+        m_launchErrors.insert(m_launchErrors.end(), launchErrors.begin(), launchErrors.end());
+    }
+
+    if (launched)
+    {
+        Logger::trace(L"Launched {} in {} ms", app.name, launchTime.count());
+        m_launchingStatus.Update(app, LaunchingState::Launched, launchTime);
+    }
+    else
+    {
+        Logger::error(L"Failed to launch {}", app.name);
+        m_launchingStatus.Update(app, LaunchingState::Failed, launchTime);
+        m_launchedSuccessfully = false;
+    }
 
+    auto status = m_launchingStatus.Get(app); // updated after launch status
+    if (status.has_value())
+    {
         {
-            std::lock_guard lock(m_uiHelperMutex);
-            m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
-        };
+            std::lock_guard lock(m_windowArrangerHelperMutex);
+            m_windowArrangerHelper->UpdateLaunchStatus(status.value());
+        }
     }
+
+    {
+        std::lock_guard lock(m_uiHelperMutex);
+        m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
+    };
 }
 
 void Launcher::handleWindowArrangerMessage(const std::wstring& msg) // WorkspacesArranger IPC thread
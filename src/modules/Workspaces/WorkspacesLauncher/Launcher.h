@@ -32,6 +32,8 @@ private:
     std::mutex m_launchErrorsMutex;
 
     void Launch();
+    void LaunchInstances(const std::vector<WorkspacesData::WorkspacesProject::Application>& instances);
+    void LaunchApp(const WorkspacesData::WorkspacesProject::Application& app);
     void handleWindowArrangerMessage(const std::wstring& msg);
     void handleUIMessage(const std::wstring& msg);
 };
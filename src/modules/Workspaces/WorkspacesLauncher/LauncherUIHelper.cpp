@@ -66,7 +66,7 @@ void LauncherUIHelper::UpdateLaunchStatus(WorkspacesData::LaunchingAppStateMap l
     appData.launcherProcessID = GetCurrentProcessId();
     for (auto& [app, data] : launchedApps)
     {
-        appData.appsStateList.insert({ app, { app, nullptr, data.state } });
+        appData.appsStateList.insert({ app, { app, nullptr, data.state, data.launchTime } });
     }
 
     m_ipcHelper.send(WorkspacesData::AppLaunchDataJSON::ToJson(appData).ToString().c_str());
@@ -16,6 +16,9 @@ namespace WorkspacesLauncherUI.Data
 
             [JsonPropertyName("state")]
             public LaunchingState State { get; set; }
+
+            [JsonPropertyName("launchTime")]
+            public int LaunchTime { get; set; }
         }
     }
 }
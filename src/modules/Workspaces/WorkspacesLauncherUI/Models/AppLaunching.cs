@@ -23,6 +23,9 @@ namespace WorkspacesLauncherUI.Models
 
         public LaunchingState LaunchState { get; set; }
 
+        // Milliseconds the launcher took to start the app
+        public int LaunchTime { get; set; }
+
         public string StateGlyph
         {
             get => LaunchState switch
@@ -63,6 +63,7 @@ namespace WorkspacesLauncherUI.ViewModels
                     Aumid = app.Application.AppUserModelId,
                     PwaAppId = app.Application.PwaAppId,
                     LaunchState = app.State,
+                    LaunchTime = app.LaunchTime,
                 });
             }
 
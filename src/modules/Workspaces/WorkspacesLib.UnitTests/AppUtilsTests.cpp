@@ -235,5 +235,86 @@ namespace WorkspacesLibUnitTests
             // But it should not crash and should return a valid list
             Assert::IsTrue(apps.size() >= 0);
         }
+
+        TEST_METHOD(GetApp_MatchesInstallFolder)
+        {
+            // Arrange
+            Utils::Apps::AppList apps({
+                Utils::Apps::AppData{ .name = L"Other", .installPath = L"C:\\Program Files\\Other\\other.exe" },
+                Utils::Apps::AppData{ .name = L"Packaged", .installPath = L"C:\\Program Files\\WindowsApps\\Packaged_1.0\\" },
+            });
+            const std::wstring appPath = L"c:\\program files\\windowsapps\\packaged_1.0\\bin\\Packaged.exe";
+
+            // Act
+            auto result = Utils::Apps::GetApp(appPath, 0, apps);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(std::wstring(L"Packaged"), result->name);
+            Assert::AreEqual(appPath, result->installPath);
+        }
+
+        TEST_METHOD(GetApp_MatchesExePathIgnoringCase)
+        {
+            // Arrange
+            Utils::Apps::AppList apps({
+                Utils::Apps::AppData{ .name = L"Tool", .installPath = L"C:\\Tools\\Tool.exe" },
+            });
+
+            // Act
+            auto result = Utils::Apps::GetApp(L"c:\\tools\\TOOL.EXE", 0, apps);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(std::wstring(L"C:\\Tools\\Tool.exe"), result->installPath);
+        }
+
+        TEST_METHOD(GetApp_MatchesFileNameInAnotherFolder)
+        {
+            // Arrange
+            Utils::Apps::AppList apps({
+                Utils::Apps::AppData{ .name = L"Editor", .installPath = L"C:\\Editor\\app-1\\editor.exe" },
+            });
+
+            // Act
+            auto result = Utils::Apps::GetApp(L"C:\\Editor\\app-2\\Editor.exe", 0, apps);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(std::wstring(L"Editor"), result->name);
+            Assert::AreEqual(std::wstring(L"C:\\Editor\\app-1\\editor.exe"), result->installPath);
+        }
+
+        TEST_METHOD(GetApp_MatchesName)
+        {
+            // Arrange
+            Utils::Apps::AppList apps({
+                Utils::Apps::AppData{ .name = L"Chat", .installPath = L"C:\\Launchers\\chat-launcher.exe" },
+            });
+            const std::wstring appPath = L"C:\\Users\\user\\AppData\\Local\\chat\\app-4\\chat.exe";
+
+            // Act
+            auto result = Utils::Apps::GetApp(appPath, 0, apps);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(std::wstring(L"Chat"), result->name);
+            Assert::AreEqual(appPath, result->installPath);
+        }
+
+        TEST_METHOD(GetApp_DoesNotMatchFolderWithSamePrefix)
+        {
+            // Arrange
+            Utils::Apps::AppList apps({
+                Utils::Apps::AppData{ .name = L"App", .installPath = L"C:\\App" },
+            });
+
+            // Act
+            auto result = Utils::Apps::GetApp(L"C:\\Apple\\orchard.exe", 0, apps);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(std::wstring(L"orchard"), result->name);
+        }
     };
 }
\ No newline at end of file
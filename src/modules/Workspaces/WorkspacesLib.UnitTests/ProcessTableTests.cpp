@@ -0,0 +1,66 @@
+#include "pch.h"
+#include <WorkspacesLib/ProcessTable.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace WorkspacesLibUnitTests
+{
+    TEST_CLASS(ProcessTableTests)
+    {
+    public:
+        TEST_METHOD(GetProcessPath_CurrentProcess_ReturnsModulePath)
+        {
+            // Arrange
+            Utils::ProcessTable processes;
+            std::wstring modulePath(MAX_PATH, L'\0');
+            modulePath.resize(GetModuleFileNameW(nullptr, modulePath.data(), static_cast<DWORD>(modulePath.size())));
+
+            // Act
+            std::wstring result = processes.GetProcessPath(GetCurrentProcessId());
+
+            // Assert
+            Assert::AreEqual(modulePath, result);
+        }
+
+        TEST_METHOD(GetParentPid_CurrentProcess_ReturnsRunningParent)
+        {
+            // Arrange
+            Utils::ProcessTable processes;
+
+            // Act
+            DWORD result = processes.GetParentPid(GetCurrentProcessId());
+
+            // Assert
+            Assert::AreNotEqual(DWORD{ 0 }, result);
+        }
+
+        TEST_METHOD(GetParentPid_UnknownProcess_ReturnsZero)
+        {
+            // Arrange
+            Utils::ProcessTable processes;
+
+            // Act
+            // Process ids are multiples of 4
+            DWORD result = processes.GetParentPid(3);
+
+            // Assert
+            Assert::AreEqual(DWORD{ 0 }, result);
+            Assert::IsTrue(processes.GetProcessPath(3).empty());
+        }
+
+        TEST_METHOD(Invalidate_KeepsLookupsWorking)
+        {
+            // Arrange
+            Utils::ProcessTable processes;
+            DWORD parentPid = processes.GetParentPid(GetCurrentProcessId());
+            std::wstring path = processes.GetProcessPath(GetCurrentProcessId());
+
+            // Act
+            processes.Invalidate();
+
+            // Assert
+            Assert::AreEqual(parentPid, processes.GetParentPid(GetCurrentProcessId()));
+            Assert::AreEqual(path, processes.GetProcessPath(GetCurrentProcessId()));
+        }
+    };
+}
@@ -190,5 +190,40 @@ namespace WorkspacesLibUnitTests
             // Act & Assert
             Assert::IsTrue(pos1 != pos2);
         }
+
+        TEST_METHOD(AppLaunchInfo_ToJsonFromJson_KeepsLaunchTime)
+        {
+            // Arrange
+            WorkspacesData::LaunchingAppState state;
+            state.application.name = L"Test App";
+            state.application.path = L"C:\\Test\\app.exe";
+            state.state = LaunchingState::Launched;
+            state.launchTime = std::chrono::milliseconds(250);
+
+            // Act
+            auto result = WorkspacesData::AppLaunchInfoJSON::FromJson(WorkspacesData::AppLaunchInfoJSON::ToJson(state));
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::IsTrue(result->application == state.application);
+            Assert::AreEqual(static_cast<int>(LaunchingState::Launched), static_cast<int>(result->state));
+            Assert::AreEqual(250ll, static_cast<long long>(result->launchTime.count()));
+        }
+
+        TEST_METHOD(AppLaunchInfo_FromJson_WithoutLaunchTime)
+        {
+            // Arrange
+            WorkspacesData::LaunchingAppState state;
+            state.application.name = L"Test App";
+            auto json = WorkspacesData::AppLaunchInfoJSON::ToJson(state);
+            json.Remove(L"launchTime");
+
+            // Act
+            auto result = WorkspacesData::AppLaunchInfoJSON::FromJson(json);
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(0ll, static_cast<long long>(result->launchTime.count()));
+        }
     };
 }
\ No newline at end of file
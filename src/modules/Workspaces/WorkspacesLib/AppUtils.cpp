@@ -5,11 +5,11 @@
 #include <atlbase.h>
 #include <propvarutil.h>
 #include <ShlObj.h>
-#include <TlHelp32.h>
 
 #include <filesystem>
 
 #include <common/logger/logger.h>
+#include <common/utils/json.h>
 #include <common/utils/process_path.h>
 #include <common/utils/winapi_error.h>
 
@@ -37,11 +37,31 @@ namespace Utils
             constexpr const wchar_t* ChromeFilename = L"chrome.exe";
 
             constexpr const wchar_t* SteamUrlProtocol = L"steam:";
+
+            constexpr const wchar_t* PackageRepositoryKey = L"Software\\Classes\\Local Settings\\Software\\Microsoft\\Windows\\CurrentVersion\\AppModel\\Repository\\Packages";
+
+            constexpr const wchar_t* CacheStampID = L"stamp";
+            constexpr const wchar_t* CacheAppsID = L"apps";
+            constexpr const wchar_t* CacheNameID = L"name";
+            constexpr const wchar_t* CacheInstallPathID = L"install-path";
+            constexpr const wchar_t* CachePackageFullNameID = L"package-full-name";
+            constexpr const wchar_t* CacheAppUserModelIdID = L"app-user-model-id";
+            constexpr const wchar_t* CacheProtocolPathID = L"protocol-path";
+            constexpr const wchar_t* CacheCanLaunchElevatedID = L"can-launch-elevated";
+        }
+
+        // Bump when AppData or the way it's read from the Apps folder changes
+        constexpr int AppsCacheVersion = 1;
+
+        std::wstring ToUpper(std::wstring value)
+        {
+            std::transform(value.begin(), value.end(), value.begin(), towupper);
+            return value;
         }
 
-        AppList IterateAppsFolder()
+        std::vector<AppData> IterateAppsFolder()
         {
-            AppList result{};
+            std::vector<AppData> result{};
 
             // get apps folder
             CComPtr<IShellItem> folder;
@@ -216,37 +236,216 @@ namespace Utils
             return currentFolderUpper;
         }
 
-        AppList GetAppsList()
+        // Changes whenever an app is installed, updated or removed. The Apps folder is built from
+        // the Start menu shortcuts and the registered packages, the stamp covers both: every entry
+        // below the Start menu folders with the latest write time, and the package repository key.
+        std::wstring GetAppsStamp()
         {
-            return IterateAppsFolder();
+            int64_t latestWrite = 0;
+            uint64_t entries = 0;
+            for (const auto& folderId : { FOLDERID_Programs, FOLDERID_CommonPrograms })
+            {
+                CComHeapPtr<wchar_t> folder;
+                if (FAILED(SHGetKnownFolderPath(folderId, KF_FLAG_DEFAULT, nullptr, &folder)))
+                {
+                    continue;
+                }
+
+                std::error_code error;
+                for (auto it = std::filesystem::recursive_directory_iterator(folder.m_pData, std::filesystem::directory_options::skip_permission_denied, error);
+                     !error && it != std::filesystem::recursive_directory_iterator();
+                     it.increment(error))
+                {
+                    entries++;
+                    const auto time = it->last_write_time(error);
+                    if (!error)
+                    {
+                        latestWrite = (std::max)(latestWrite, static_cast<int64_t>(time.time_since_epoch().count()));
+                    }
+                    error.clear();
+                }
+            }
+
+            DWORD packages = 0;
+            FILETIME packagesWrite{};
+            HKEY key{};
+            if (RegOpenKeyExW(HKEY_CURRENT_USER, NonLocalizable::PackageRepositoryKey, 0, KEY_READ, &key) == ERROR_SUCCESS)
+            {
+                RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, &packages, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &packagesWrite);
+                RegCloseKey(key);
+            }
+
+            const uint64_t packagesWriteTime = (static_cast<uint64_t>(packagesWrite.dwHighDateTime) << 32) | packagesWrite.dwLowDateTime;
+            return std::to_wstring(AppsCacheVersion) + L":" + std::to_wstring(entries) + L":" + std::to_wstring(latestWrite) + L":" + std::to_wstring(packages) + L":" + std::to_wstring(packagesWriteTime);
         }
 
-        DWORD GetParentPid(DWORD pid)
+        std::optional<std::vector<AppData>> ReadAppsCache(const std::wstring& stamp)
         {
-            DWORD res = 0;
-            HANDLE h = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-            PROCESSENTRY32 pe = { 0 };
-            pe.dwSize = sizeof(PROCESSENTRY32);
+            auto cache = json::from_file(WorkspacesData::InstalledAppsCacheFile());
+            if (!cache.has_value())
+            {
+                return std::nullopt;
+            }
 
-            if (Process32First(h, &pe))
+            try
             {
-                do
+                if (cache->GetNamedString(NonLocalizable::CacheStampID, L"") != stamp)
                 {
-                    if (pe.th32ProcessID == pid)
-                    {
-                        res = pe.th32ParentProcessID;
-                    }
-                } while (Process32Next(h, &pe));
+                    return std::nullopt;
+                }
+
+                std::vector<AppData> apps;
+                for (const auto& element : cache->GetNamedArray(NonLocalizable::CacheAppsID))
+                {
+                    auto app = element.GetObjectW();
+                    apps.push_back(AppData{
+                        .name = std::wstring(app.GetNamedString(NonLocalizable::CacheNameID)),
+                        .installPath = std::wstring(app.GetNamedString(NonLocalizable::CacheInstallPathID, L"")),
+                        .packageFullName = std::wstring(app.GetNamedString(NonLocalizable::CachePackageFullNameID, L"")),
+                        .appUserModelId = std::wstring(app.GetNamedString(NonLocalizable::CacheAppUserModelIdID, L"")),
+                        .protocolPath = std::wstring(app.GetNamedString(NonLocalizable::CacheProtocolPathID, L"")),
+                        .canLaunchElevated = app.GetNamedBoolean(NonLocalizable::CacheCanLaunchElevatedID, false),
+                    });
+                }
+
+                return apps;
+            }
+            catch (const winrt::hresult_error&)
+            {
+                Logger::warn(L"Installed apps cache is malformed");
+                return std::nullopt;
+            }
+        }
+
+        void WriteAppsCache(const std::wstring& stamp, const std::vector<AppData>& apps)
+        {
+            json::JsonArray appsJson;
+            for (const auto& app : apps)
+            {
+                json::JsonObject appJson;
+                appJson.SetNamedValue(NonLocalizable::CacheNameID, json::value(app.name));
+                appJson.SetNamedValue(NonLocalizable::CacheInstallPathID, json::value(app.installPath));
+                appJson.SetNamedValue(NonLocalizable::CachePackageFullNameID, json::value(app.packageFullName));
+                appJson.SetNamedValue(NonLocalizable::CacheAppUserModelIdID, json::value(app.appUserModelId));
+                appJson.SetNamedValue(NonLocalizable::CacheProtocolPathID, json::value(app.protocolPath));
+                appJson.SetNamedValue(NonLocalizable::CacheCanLaunchElevatedID, json::value(app.canLaunchElevated));
+                appsJson.Append(appJson);
             }
 
-            CloseHandle(h);
-            return res;
+            json::JsonObject cache;
+            cache.SetNamedValue(NonLocalizable::CacheStampID, json::value(stamp));
+            cache.SetNamedValue(NonLocalizable::CacheAppsID, appsJson);
+
+            // The launcher and the arranger can run at the same time, readers must never see a partial file
+            const std::wstring file = WorkspacesData::InstalledAppsCacheFile();
+            const std::wstring tempFile = file + L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+            json::to_file(tempFile, cache);
+            if (!MoveFileExW(tempFile.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING))
+            {
+                Logger::warn(L"Failed to write the installed apps cache: {}", get_last_error_or_default(GetLastError()));
+                DeleteFileW(tempFile.c_str());
+            }
         }
 
-        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps)
+        AppList::AppList(std::vector<AppData> apps) :
+            m_apps(std::move(apps))
+        {
+            for (size_t i = 0; i < m_apps.size(); i++)
+            {
+                const auto& app = m_apps[i];
+                m_byName.try_emplace(ToUpper(app.name), i);
+                if (app.installPath.empty())
+                {
+                    continue;
+                }
+
+                const std::wstring installPathUpper = ToUpper(app.installPath);
+                const std::filesystem::path path(installPathUpper);
+                m_byInstallFolder.try_emplace(path.parent_path().wstring(), i);
+                if (auto fileName = path.filename().wstring(); !fileName.empty())
+                {
+                    m_byFileName.insert_or_assign(std::move(fileName), i);
+                }
+
+                std::wstring_view trimmed(installPathUpper);
+                while (trimmed.ends_with(L'\\') || trimmed.ends_with(L'/'))
+                {
+                    trimmed.remove_suffix(1);
+                }
+                m_byInstallPath.try_emplace(std::wstring(trimmed), i);
+            }
+        }
+
+        std::optional<size_t> AppList::FindByInstallPath(const std::wstring& pathUpper) const
+        {
+            // The path itself, then every parent folder. The app listed first wins, as when the
+            // list was scanned in order.
+            std::optional<size_t> result;
+            std::wstring_view path(pathUpper);
+            size_t length = path.find_last_not_of(L"\\/");
+            length = length == std::wstring_view::npos ? 0 : length + 1;
+            while (length > 0)
+            {
+                if (auto it = m_byInstallPath.find(std::wstring(path.substr(0, length))); it != m_byInstallPath.end() && (!result.has_value() || it->second < result.value()))
+                {
+                    result = it->second;
+                }
+
+                const size_t separator = path.find_last_of(L"\\/", length - 1);
+                length = separator == std::wstring_view::npos ? 0 : separator;
+            }
+
+            return result;
+        }
+
+        std::optional<size_t> AppList::FindByFileName(const std::wstring& fileNameUpper) const
+        {
+            if (auto it = m_byFileName.find(fileNameUpper); it != m_byFileName.end())
+            {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+        std::optional<size_t> AppList::FindByName(const std::wstring& nameUpper) const
+        {
+            if (auto it = m_byName.find(nameUpper); it != m_byName.end())
+            {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+        std::optional<size_t> AppList::FindByInstallFolder(const std::wstring& folderUpper) const
+        {
+            if (auto it = m_byInstallFolder.find(folderUpper); it != m_byInstallFolder.end())
+            {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+        AppList GetAppsList()
+        {
+            const std::wstring stamp = GetAppsStamp();
+            if (auto apps = ReadAppsCache(stamp); apps.has_value())
+            {
+                Logger::trace(L"Read {} installed apps from the cache", apps->size());
+                return AppList(std::move(apps.value()));
+            }
+
+            auto apps = IterateAppsFolder();
+            if (!apps.empty())
+            {
+                WriteAppsCache(stamp, apps);
+            }
+
+            return AppList(std::move(apps));
+        }
+
+        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps, ProcessTable& processes)
         {
-            std::wstring appPathUpper(appPath);
-            std::transform(appPathUpper.begin(), appPathUpper.end(), appPathUpper.begin(), towupper);
+            const std::wstring appPathUpper = ToUpper(appPath);
 
             // filter out ApplicationFrameHost.exe
             if (appPathUpper.ends_with(NonLocalizable::ApplicationFrameHost))
@@ -282,65 +481,42 @@ namespace Utils
                 }
             }
 
-            // search in apps list
-            std::optional<AppData> appDataPlanB{ std::nullopt };
-            for (const auto& appData : apps)
+            // search in apps list, matching the install path or one of its parent folders
+            if (auto index = apps.FindByInstallPath(appPathUpper); index.has_value())
             {
-                if (!appData.installPath.empty())
-                {
-                    std::wstring installPathUpper(appData.installPath);
-                    std::transform(installPathUpper.begin(), installPathUpper.end(), installPathUpper.begin(), towupper);
-
-                    if (appPathUpper.contains(installPathUpper))
-                    {
-                        // Update the install path to keep .exe in the path
-                        if (!installPathUpper.ends_with(NonLocalizable::Exe))
-                        {
-                            auto settingsAppData = appData;
-                            settingsAppData.installPath = appPath;
-                            return settingsAppData;
-                        }
-
-                        return appData;
-                    }
+                const auto& appData = apps[index.value()];
 
-                    // edge case, some apps (e.g., Gitkraken) have different .exe files in the subfolders.
-                    // apps list contains only one path, so in this case app is not found
-                    // remember the match and return it in case the loop is over and there are no direct matches
-                    if (std::filesystem::path(appPath).filename() == std::filesystem::path(appData.installPath).filename())
-                    {
-                        appDataPlanB = appData;
-                    }
+                // Update the install path to keep .exe in the path
+                if (!ToUpper(appData.installPath).ends_with(NonLocalizable::Exe))
+                {
+                    auto settingsAppData = appData;
+                    settingsAppData.installPath = appPath;
+                    return settingsAppData;
                 }
+
+                return appData;
             }
 
-            if (appDataPlanB.has_value())
+            // edge case, some apps (e.g., Gitkraken) have different .exe files in the subfolders.
+            // apps list contains only one path, so in this case app is not found by its path
+            const std::filesystem::path appPathUpperPath(appPathUpper);
+            if (auto index = apps.FindByFileName(appPathUpperPath.filename().wstring()); index.has_value())
             {
-                return appDataPlanB.value();
+                return apps[index.value()];
             }
 
             // try by name if path not found
             // apps list could contain a different path from that one we get from the process (for electron)
-            std::wstring exeName = std::filesystem::path(appPath).stem();
-            std::wstring exeNameUpper(exeName);
-            std::transform(exeNameUpper.begin(), exeNameUpper.end(), exeNameUpper.begin(), towupper);
-
-            for (const auto& appData : apps)
+            if (auto index = apps.FindByName(appPathUpperPath.stem().wstring()); index.has_value())
             {
-                std::wstring appNameUpper(appData.name);
-                std::transform(appNameUpper.begin(), appNameUpper.end(), appNameUpper.begin(), towupper);
-
-                if (appNameUpper == exeNameUpper)
-                {
-                    auto result = appData;
-                    result.installPath = appPath;
-                    return result;
-                }
+                auto result = apps[index.value()];
+                result.installPath = appPath;
+                return result;
             }
 
             // try with parent process (fix for Steam)
-            auto parentPid = GetParentPid(pid);
-            auto parentProcessPath = get_process_path(parentPid);
+            auto parentPid = processes.GetParentPid(pid);
+            auto parentProcessPath = processes.GetProcessPath(parentPid);
 
             if (!parentProcessPath.empty())
             {
@@ -351,18 +527,9 @@ namespace Utils
                 {
                     Logger::info(L"original process is in the subfolder of the parent process");
 
-                    for (const auto& appData : apps)
+                    if (auto index = apps.FindByInstallFolder(parentDirUpper); index.has_value())
                     {
-                        if (!appData.installPath.empty())
-                        {
-                            std::wstring installDirUpper = std::filesystem::path(appData.installPath).parent_path().c_str();
-                            std::transform(installDirUpper.begin(), installDirUpper.end(), installDirUpper.begin(), towupper);
-
-                            if (installDirUpper == parentDirUpper)
-                            {
-                                return appData;
-                            }
-                        }
+                        return apps[index.value()];
                     }
                 }
             }
@@ -373,14 +540,26 @@ namespace Utils
             };
         }
 
-        std::optional<AppData> GetApp(HWND window, const AppList& apps)
+        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps)
+        {
+            ProcessTable processes;
+            return GetApp(appPath, pid, apps, processes);
+        }
+
+        std::optional<AppData> GetApp(HWND window, const AppList& apps, ProcessTable& processes)
         {
             std::wstring processPath = get_process_path(window);
 
             DWORD pid{};
             GetWindowThreadProcessId(window, &pid);
 
-            return Utils::Apps::GetApp(processPath, pid, apps);
+            return Utils::Apps::GetApp(processPath, pid, apps, processes);
+        }
+
+        std::optional<AppData> GetApp(HWND window, const AppList& apps)
+        {
+            ProcessTable processes;
+            return GetApp(window, apps, processes);
         }
 
         bool UpdateAppVersion(WorkspacesData::WorkspacesProject::Application& app, const AppList& installedApps)
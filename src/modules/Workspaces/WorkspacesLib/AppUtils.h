@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+
+#include <WorkspacesLib/ProcessTable.h>
 #include <WorkspacesLib/WorkspacesData.h>
 
 namespace Utils
@@ -21,13 +24,49 @@ namespace Utils
             bool IsSteamGame() const;
         };
 
-        using AppList = std::vector<AppData>;
+        // The installed apps with hash indexes for GetApp. The keys are upper-cased once here,
+        // so matching a process path doesn't copy and upper-case every installed app.
+        class AppList
+        {
+        public:
+            AppList() = default;
+            AppList(std::vector<AppData> apps);
+
+            std::vector<AppData>::const_iterator begin() const noexcept { return m_apps.begin(); }
+            std::vector<AppData>::const_iterator end() const noexcept { return m_apps.end(); }
+            size_t size() const noexcept { return m_apps.size(); }
+            bool empty() const noexcept { return m_apps.empty(); }
+            const AppData& operator[](size_t index) const noexcept { return m_apps[index]; }
+
+            // First app installed at the upper-cased path or at one of its parent folders
+            std::optional<size_t> FindByInstallPath(const std::wstring& pathUpper) const;
+            // Last app whose install path has the upper-cased file name
+            std::optional<size_t> FindByFileName(const std::wstring& fileNameUpper) const;
+            // First app with the upper-cased name
+            std::optional<size_t> FindByName(const std::wstring& nameUpper) const;
+            // First app installed in the upper-cased folder
+            std::optional<size_t> FindByInstallFolder(const std::wstring& folderUpper) const;
+
+        private:
+            std::vector<AppData> m_apps;
+            std::unordered_map<std::wstring, size_t> m_byInstallPath;
+            std::unordered_map<std::wstring, size_t> m_byFileName;
+            std::unordered_map<std::wstring, size_t> m_byName;
+            std::unordered_map<std::wstring, size_t> m_byInstallFolder;
+        };
 
         const std::wstring& GetCurrentFolder();
         const std::wstring& GetCurrentFolderUpper();
 
+        // Reads the apps from the cache file shared by the launcher, the arranger and the snapshot
+        // tool. The shell Apps folder is only enumerated again when packages or Start menu entries
+        // changed since the cache was written.
         AppList GetAppsList();
+        // The process table is shared by the lookups of a pass, the overloads without it take their
+        // own snapshot when they need the parent process.
+        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps, ProcessTable& processes);
         std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps);
+        std::optional<AppData> GetApp(HWND window, const AppList& apps, ProcessTable& processes);
         std::optional<AppData> GetApp(HWND window, const AppList& apps);
 
         bool UpdateAppVersion(WorkspacesData::WorkspacesProject::Application& app, const AppList& installedApps);
@@ -60,7 +60,7 @@ bool LaunchingStatus::AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData:
     return true;
 }
 
-const WorkspacesData::LaunchingAppStateMap& LaunchingStatus::Get() noexcept
+WorkspacesData::LaunchingAppStateMap LaunchingStatus::Get() noexcept
 {
     std::shared_lock lock(m_mutex);
     return m_appsState;
@@ -118,6 +118,19 @@ void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Applicatio
     m_appsState[app].state = state;
 }
 
+void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Application& app, LaunchingState state, std::chrono::milliseconds launchTime)
+{
+    std::unique_lock lock(m_mutex);
+    if (!m_appsState.contains(app))
+    {
+        Logger::error(L"Error updating state: app {} is not tracked in the project", app.name);
+        return;
+    }
+
+    m_appsState[app].state = state;
+    m_appsState[app].launchTime = launchTime;
+}
+
 void LaunchingStatus::Update(const WorkspacesData::WorkspacesProject::Application& app, HWND window, LaunchingState state)
 {
     std::unique_lock lock(m_mutex);
@@ -14,13 +14,14 @@ public:
     bool AllLaunchedAndMoved() noexcept;
     bool AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
 
-    const WorkspacesData::LaunchingAppStateMap& Get() noexcept;
+    WorkspacesData::LaunchingAppStateMap Get() noexcept;
     std::optional<WorkspacesData::LaunchingAppState> Get(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
     std::optional<WorkspacesData::LaunchingAppState> GetNext(LaunchingState state) noexcept;
     
     bool IsWindowProcessed(HWND window) noexcept;
 
     void Update(const WorkspacesData::WorkspacesProject::Application& app, LaunchingState state);
+    void Update(const WorkspacesData::WorkspacesProject::Application& app, LaunchingState state, std::chrono::milliseconds launchTime);
     void Update(const WorkspacesData::WorkspacesProject::Application& app, HWND window, LaunchingState state);
     void Cancel();
     
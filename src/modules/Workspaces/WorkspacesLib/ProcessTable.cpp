@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "ProcessTable.h"
+
+#include <TlHelp32.h>
+
+#include <common/logger/logger.h>
+#include <common/utils/process_path.h>
+#include <common/utils/winapi_error.h>
+
+namespace Utils
+{
+    // A missing pid refreshes the table at most this often, so lookups of exited processes don't
+    // take a snapshot each
+    constexpr auto MinRefreshInterval = std::chrono::milliseconds(100);
+
+    void ProcessTable::Invalidate()
+    {
+        m_stale = true;
+    }
+
+    DWORD ProcessTable::GetParentPid(DWORD pid)
+    {
+        Process* process = Find(pid);
+        return process ? process->parentPid : 0;
+    }
+
+    std::wstring ProcessTable::GetProcessPath(DWORD pid)
+    {
+        Process* process = Find(pid);
+        if (!process)
+        {
+            return get_process_path(pid);
+        }
+
+        if (!process->path.has_value())
+        {
+            process->path = get_process_path(pid);
+        }
+
+        return process->path.value();
+    }
+
+    void ProcessTable::Refresh()
+    {
+        m_stale = false;
+        m_refreshTime = std::chrono::steady_clock::now();
+
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE)
+        {
+            Logger::error(L"Failed to take a process snapshot: {}", get_last_error_or_default(GetLastError()));
+            return;
+        }
+
+        std::unordered_map<DWORD, Process> processes;
+        processes.reserve(m_processes.size());
+
+        PROCESSENTRY32 pe = { 0 };
+        pe.dwSize = sizeof(PROCESSENTRY32);
+        if (Process32First(snapshot, &pe))
+        {
+            do
+            {
+                Process process{ .parentPid = pe.th32ParentProcessID, .exeFile = pe.szExeFile };
+
+                // Keep the image path unless the pid was reused by another process
+                if (auto it = m_processes.find(pe.th32ProcessID); it != m_processes.end() && it->second.parentPid == process.parentPid && it->second.exeFile == process.exeFile)
+                {
+                    process.path = std::move(it->second.path);
+                }
+
+                processes.emplace(pe.th32ProcessID, std::move(process));
+            } while (Process32Next(snapshot, &pe));
+        }
+
+        CloseHandle(snapshot);
+        m_processes = std::move(processes);
+    }
+
+    ProcessTable::Process* ProcessTable::Find(DWORD pid)
+    {
+        if (m_stale)
+        {
+            Refresh();
+        }
+
+        auto it = m_processes.find(pid);
+        if (it == m_processes.end() && std::chrono::steady_clock::now() - m_refreshTime >= MinRefreshInterval)
+        {
+            Refresh();
+            it = m_processes.find(pid);
+        }
+
+        return it != m_processes.end() ? &it->second : nullptr;
+    }
+}
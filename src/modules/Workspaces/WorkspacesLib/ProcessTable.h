@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace Utils
+{
+    // Parent pids and image paths of the running processes, read from one Toolhelp snapshot and
+    // shared by the lookups of a snapshot or arrange pass. The snapshot is only taken when a
+    // lookup needs it, image paths are queried on first use.
+    class ProcessTable
+    {
+    public:
+        ProcessTable() = default;
+        ~ProcessTable() = default;
+
+        // Takes a new snapshot on the next lookup. Processes that are still running keep their
+        // cached image path.
+        void Invalidate();
+
+        // Parent of the process, 0 if it isn't running. A process started after the snapshot
+        // refreshes the table.
+        DWORD GetParentPid(DWORD pid);
+
+        // Image path of the process, empty if it can't be queried
+        std::wstring GetProcessPath(DWORD pid);
+
+    private:
+        struct Process
+        {
+            DWORD parentPid = 0;
+            std::wstring exeFile;
+            std::optional<std::wstring> path;
+        };
+
+        void Refresh();
+        Process* Find(DWORD pid);
+
+        std::unordered_map<DWORD, Process> m_processes;
+        bool m_stale = true;
+        std::chrono::steady_clock::time_point m_refreshTime{};
+    };
+}
@@ -23,6 +23,12 @@ namespace WorkspacesData
         return settingsFolderPath + L"\\temp-workspaces.json";
     }
 
+    std::wstring InstalledAppsCacheFile()
+    {
+        std::wstring settingsFolderPath = PTSettingsHelper::get_module_save_folder_location(NonLocalizable::ModuleKey);
+        return settingsFolderPath + L"\\installed-apps.json";
+    }
+
     RECT WorkspacesProject::Application::Position::toRect() const noexcept
     {
         return RECT{ .left = x, .top = y, .right = x + width, .bottom = y + height };
@@ -440,6 +446,7 @@ namespace WorkspacesData
         {
             const static wchar_t* ApplicationID = L"application";
             const static wchar_t* StateID = L"state";
+            const static wchar_t* LaunchTimeID = L"launchTime";
         }
 
         json::JsonObject ToJson(const LaunchingAppState& data)
@@ -447,6 +454,7 @@ namespace WorkspacesData
             json::JsonObject json{};
             json.SetNamedValue(NonLocalizable::ApplicationID, WorkspacesProjectJSON::ApplicationJSON::ToJson(data.application));
             json.SetNamedValue(NonLocalizable::StateID, json::value(static_cast<int>(data.state)));
+            json.SetNamedValue(NonLocalizable::LaunchTimeID, json::value(static_cast<int>(data.launchTime.count())));
             return json;
         }
 
@@ -464,6 +472,7 @@ namespace WorkspacesData
 
                 result.application = app.value();
                 result.state = static_cast<LaunchingState>(json.GetNamedNumber(NonLocalizable::StateID));
+                result.launchTime = std::chrono::milliseconds(static_cast<int>(json.GetNamedNumber(NonLocalizable::LaunchTimeID, 0)));
             }
             catch (const winrt::hresult_error&)
             {
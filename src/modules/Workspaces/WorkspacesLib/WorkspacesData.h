@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include <common/utils/json.h>
 
 #include <WorkspacesLib/LaunchingStateEnum.h>
@@ -8,6 +10,7 @@ namespace WorkspacesData
 {
     std::wstring WorkspacesFile();
     std::wstring TempWorkspacesFile();
+    std::wstring InstalledAppsCacheFile();
 
     struct WorkspacesProject
     {
@@ -90,6 +93,8 @@ namespace WorkspacesData
         WorkspacesData::WorkspacesProject::Application application;
         HWND window{};
         LaunchingState state{ LaunchingState::Waiting };
+        // How long starting the app took, zero until it's launched
+        std::chrono::milliseconds launchTime{};
     };
 
     using LaunchingAppStateMap = std::map<WorkspacesData::WorkspacesProject::Application, LaunchingAppState>;
@@ -49,6 +49,7 @@ namespace SnapshotUtils
         std::vector<WorkspacesData::WorkspacesProject::Application> apps{};
 
         auto installedApps = Utils::Apps::GetAppsList();
+        Utils::ProcessTable processes{};
         auto windows = WindowEnumerator::Enumerate(WindowFilter::Filter);
 
         for (const auto window : windows)
@@ -112,13 +113,13 @@ namespace SnapshotUtils
                     // searching for the window with the same title but different PID
                     if (pid != otherPid && title == WindowUtils::GetWindowTitle(otherWindow))
                     {
-                        processPath = get_process_path(otherPid);
+                        processPath = processes.GetProcessPath(otherPid);
                         break;
                     }
                 }
             }
 
-            auto data = Utils::Apps::GetApp(processPath, pid, installedApps);
+            auto data = Utils::Apps::GetApp(processPath, pid, installedApps, processes);
             if (!data.has_value() || data->name.empty())
             {
                 Logger::info(L"Installed app not found:{},{}", reinterpret_cast<void*>(window), processPath);
@@ -20,6 +20,31 @@ namespace NonLocalizable
     const std::wstring ApplicationFrameHost = L"ApplicationFrameHost.exe";
 }
 
+namespace
+{
+    // Packaged apps are hosted by ApplicationFrameHost.exe, the app's own process owns a child
+    // window of the frame. The child only shows up once the app has started.
+    DWORD GetHostedAppProcessId(HWND frame, DWORD framePid)
+    {
+        std::pair<DWORD, DWORD> pids{ framePid, 0 };
+        EnumChildWindows(
+            frame,
+            [](HWND child, LPARAM param) -> BOOL {
+                auto& [hostPid, appPid] = *reinterpret_cast<std::pair<DWORD, DWORD>*>(param);
+                DWORD pid{};
+                GetWindowThreadProcessId(child, &pid);
+                if (pid != hostPid)
+                {
+                    appPid = pid;
+                    return FALSE;
+                }
+                return TRUE;
+            },
+            reinterpret_cast<LPARAM>(&pids));
+        return pids.second;
+    }
+}
+
 namespace PlacementHelper
 {
     // When calculating the coordinates difference (== 'distance') between 2 windows, there are additional values added to the real distance
@@ -194,13 +219,13 @@ std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const Workspa
                 // searching for the window with the same title but different PID
                 if (pid != otherPid && title == WindowUtils::GetWindowTitle(otherWindow))
                 {
-                    processPath = get_process_path(otherPid);
+                    processPath = m_processes.GetProcessPath(otherPid);
                     break;
                 }
             }
         }
 
-        auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps);
+        auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps, m_processes);
 
         if (!data->IsSteamGame() && !WindowUtils::HasThickFrame(window))
         {
@@ -274,11 +299,19 @@ std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const Workspa
 WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     m_project(project),
     m_windowsBefore(WindowEnumerator::Enumerate(WindowFilter::Filter)),
+    m_knownWindows(m_windowsBefore.begin(), m_windowsBefore.end()),
     m_monitors(MonitorUtils::IdentifyMonitors()),
     m_installedApps(Utils::Apps::GetAppsList()),
     m_ipcHelper(IPCHelperStrings::WindowArrangerPipeName, IPCHelperStrings::LauncherArrangerPipeName, std::bind(&WindowArranger::receiveIpcMessage, this, std::placeholders::_1)),
-    m_launchingStatus(m_project)
+    m_launchingStatus(m_project),
+    m_windowCreationHandler(std::bind(&WindowArranger::onWindowCreated, this, std::placeholders::_1))
 {
+    // Windows created while the installed apps were read, before the hooks were installed
+    for (HWND window : WindowEnumerator::Enumerate(WindowFilter::Filter))
+    {
+        onWindowCreated(window);
+    }
+
     if (project.moveExistingWindows)
     {
         Logger::info(L"Moving existing windows");
@@ -343,58 +376,101 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
 
     m_ipcHelper.send(L"ready");
 
-    const long maxLaunchingWaitingTime = 10000, maxRepositionWaitingTime = 3000, ms = 300;
-    long waitingTime{ 0 };
+    const auto maxLaunchingWaitingTime = std::chrono::milliseconds(10000), maxRepositionWaitingTime = std::chrono::milliseconds(3000);
 
-    // process launching windows
-    while (!m_launchingStatus.AllLaunched() && waitingTime < maxLaunchingWaitingTime)
-    {
-        if (processWindows(false))
-        {
-            waitingTime = 0;
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-        waitingTime += ms;
-    }
-
-    if (waitingTime >= maxLaunchingWaitingTime)
+    // process launching windows, the timeout restarts whenever a window is placed
+    if (!waitForWindows(maxLaunchingWaitingTime, true, [this] { return m_launchingStatus.AllLaunched(); }))
     {
         Logger::info(L"Launching timeout expired");
     }
 
     Logger::info(L"Finished moving new windows");
 
+    // Apps that hand over to a running instance don't create a new window, so the windows that
+    // existed before launching are candidates from now on
+    m_includeKnownWindows = true;
+    m_unmatchedWindows.insert(m_windowsBefore.begin(), m_windowsBefore.end());
+
     // wait for 3 seconds after all apps launched
-    waitingTime = 0;
-    while (!m_launchingStatus.AllLaunchedAndMoved() && waitingTime < maxRepositionWaitingTime)
+    if (!waitForWindows(maxRepositionWaitingTime, false, [this] { return m_launchingStatus.AllLaunchedAndMoved(); }))
     {
-        processWindows(true);
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-        waitingTime += ms;
+        Logger::info(L"Repositioning timeout expired");
     }
+}
 
-    if (waitingTime >= maxRepositionWaitingTime)
+void WindowArranger::onWindowCreated(HWND window)
+{
+    if (!m_includeKnownWindows && m_knownWindows.contains(window))
     {
-        Logger::info(L"Repositioning timeout expired");
+        return;
     }
+
+    m_newWindows.insert(window);
 }
 
-bool WindowArranger::processWindows(bool processAll)
+bool WindowArranger::waitForWindows(std::chrono::milliseconds timeout, bool restartTimeoutOnProgress, const std::function<bool()>& done)
 {
-    bool processedAnyWindow = false;
-    std::vector<HWND> windows = WindowEnumerator::Enumerate(WindowFilter::Filter);
-
-    if (!processAll)
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;)
     {
-        std::vector<HWND> windowsDiff{};
-        std::copy_if(windows.begin(), windows.end(), std::back_inserter(windowsDiff), [&](HWND window) { return std::find(m_windowsBefore.begin(), m_windowsBefore.end(), window) == m_windowsBefore.end(); });
-        windows = windowsDiff;
+        if (processWindows() && restartTimeoutOnProgress)
+        {
+            deadline = std::chrono::steady_clock::now() + timeout;
+        }
+
+        if (done())
+        {
+            return true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        // Window events arrive as messages, app states through the event
+        HANDLE statusChanged = m_launchingStatusChanged.get();
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        MsgWaitForMultipleObjectsEx(1, &statusChanged, static_cast<DWORD>(remaining.count()), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
     }
+}
+
+bool WindowArranger::processWindows()
+{
+    // Unmatched windows are retried on every pass: an app state may have changed, or a window
+    // that couldn't be resolved yet, like a packaged app still starting, can be now
+    std::unordered_set<HWND> windows = std::move(m_newWindows);
+    m_newWindows.clear();
+    windows.merge(m_unmatchedWindows);
+    m_unmatchedWindows.clear();
+
+    m_processes.Invalidate();
 
+    bool processedAnyWindow = false;
     for (HWND window : windows)
     {
-        processedAnyWindow |= processWindow(window);
+        // Hidden windows are reported again when they're shown or uncloaked
+        if (!WindowFilter::Filter(window) || m_launchingStatus.IsWindowProcessed(window))
+        {
+            continue;
+        }
+
+        if (processWindow(window))
+        {
+            processedAnyWindow = true;
+        }
+        else
+        {
+            m_unmatchedWindows.insert(window);
+        }
     }
 
     return processedAnyWindow;
@@ -413,16 +489,7 @@ bool WindowArranger::processWindow(HWND window)
         return false;
     }
 
-    std::wstring processPath = get_process_path(window);
-    if (processPath.empty())
-    {
-        return false;
-    }
-
-    DWORD pid{};
-    GetWindowThreadProcessId(window, &pid);
-
-    auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps);
+    const auto& data = getWindowApp(window);
     if (!data.has_value())
     {
         return false;
@@ -437,7 +504,7 @@ bool WindowArranger::processWindow(HWND window)
 
     if (iter == apps.end())
     {
-        Logger::info(L"Skip {}", processPath);
+        Logger::info(L"Skip {}", data.value().installPath);
         return false;
     }
 
@@ -458,6 +525,41 @@ bool WindowArranger::processWindow(HWND window)
     return true;
 }
 
+const std::optional<Utils::Apps::AppData>& WindowArranger::getWindowApp(HWND window)
+{
+    if (auto it = m_windowApps.find(window); it != m_windowApps.end())
+    {
+        return it->second;
+    }
+
+    // Windows that can't be resolved yet aren't cached, they're tried again on the next pass
+    static const std::optional<Utils::Apps::AppData> noApp;
+    std::wstring processPath = get_process_path(window);
+    if (processPath.empty())
+    {
+        return noApp;
+    }
+
+    DWORD pid{};
+    GetWindowThreadProcessId(window, &pid);
+    if (processPath.ends_with(NonLocalizable::ApplicationFrameHost))
+    {
+        pid = GetHostedAppProcessId(window, pid);
+        processPath = pid ? m_processes.GetProcessPath(pid) : std::wstring{};
+        if (processPath.empty())
+        {
+            return noApp;
+        }
+    }
+
+    auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps, m_processes);
+    if (!data.has_value())
+    {
+        return noApp;
+    }
+    return m_windowApps.emplace(window, std::move(data)).first->second;
+}
+
 bool WindowArranger::moveWindow(HWND window, const WorkspacesData::WorkspacesProject::Application& app)
 {
     auto snapMonitorIter = std::find_if(m_project.monitors.begin(), m_project.monitors.end(), [&](const WorkspacesData::WorkspacesProject::Monitor& val) { return val.number == app.monitor; });
@@ -523,6 +625,7 @@ void WindowArranger::receiveIpcMessage(const std::wstring& message)
         if (data.has_value())
         {
             m_launchingStatus.Update(data.value().application, data.value().state);
+            m_launchingStatusChanged.SetEvent();
         }
         else
         {
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+
+#include <wil/resource.h>
+
 #include <WindowCreationHandler.h>
 
 #include <WorkspacesLib/AppUtils.h>
@@ -23,17 +28,34 @@ public:
 private:
     const WorkspacesData::WorkspacesProject m_project;
     const std::vector<HWND> m_windowsBefore;
+    const std::unordered_set<HWND> m_knownWindows;
     const std::vector<WorkspacesData::WorkspacesProject::Monitor> m_monitors;
     const Utils::Apps::AppList m_installedApps;
-    //const WindowCreationHandler m_windowCreationHandler;
+    // Signaled by the IPC thread when the launcher reports a new app state
+    wil::unique_event m_launchingStatusChanged{ wil::EventOptions::None };
     IPCHelper m_ipcHelper;
     LaunchingStatus m_launchingStatus;
+    WindowCreationHandler m_windowCreationHandler;
+
+    // Windows reported by m_windowCreationHandler since the last pass
+    std::unordered_set<HWND> m_newWindows;
+    // Windows that didn't match a launched app yet, tried again on every pass
+    std::unordered_set<HWND> m_unmatchedWindows;
+    // Windows that existed before launching are only considered once every app is launched
+    bool m_includeKnownWindows = false;
+    // The app of a window never changes, so it's kept once resolved
+    std::unordered_map<HWND, std::optional<Utils::Apps::AppData>> m_windowApps;
+    // Parent processes for GetApp, read again on every pass
+    Utils::ProcessTable m_processes;
+
     std::optional<WindowWithDistance> GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& movedWindows, Utils::PwaHelper& pwaHelper);
     bool TryMoveWindow(const WorkspacesData::WorkspacesProject::Application& app, HWND windowToMove);
 
-    //void onWindowCreated(HWND window);
-    bool processWindows(bool processAll);
+    void onWindowCreated(HWND window);
+    bool waitForWindows(std::chrono::milliseconds timeout, bool restartTimeoutOnProgress, const std::function<bool()>& done);
+    bool processWindows();
     bool processWindow(HWND window);
+    const std::optional<Utils::Apps::AppData>& getWindowApp(HWND window);
     bool moveWindow(HWND window, const WorkspacesData::WorkspacesProject::Application& app);
 
     void receiveIpcMessage(const std::wstring& message);
@@ -20,10 +20,11 @@ WindowCreationHandler::~WindowCreationHandler()
 
 void WindowCreationHandler::InitHooks()
 {
-    std::array<DWORD, 3> events_to_subscribe = {
+    std::array<DWORD, 4> events_to_subscribe = {
         EVENT_OBJECT_UNCLOAKED,
         EVENT_OBJECT_SHOW,
-        EVENT_OBJECT_CREATE
+        EVENT_OBJECT_CREATE,
+        EVENT_OBJECT_NAMECHANGE
     };
     for (const auto event : events_to_subscribe)
     {
@@ -39,13 +40,20 @@ void WindowCreationHandler::InitHooks()
     }
 }
 
-void WindowCreationHandler::HandleWinHookEvent(DWORD event, HWND window) noexcept
+void WindowCreationHandler::HandleWinHookEvent(DWORD event, HWND window, LONG object, LONG child) noexcept
 {
+    // Name changes fire for every control and tab title, only the window itself is interesting
+    if (object != OBJID_WINDOW || child != CHILDID_SELF || !window || GetAncestor(window, GA_ROOT) != window)
+    {
+        return;
+    }
+
     switch (event)
     {
-    //case EVENT_OBJECT_UNCLOAKED:
-    //case EVENT_OBJECT_SHOW:
+    case EVENT_OBJECT_UNCLOAKED:
+    case EVENT_OBJECT_SHOW:
     case EVENT_OBJECT_CREATE:
+    case EVENT_OBJECT_NAMECHANGE:
     {
         if (m_windowCreatedCallback)
         {
@@ -1,5 +1,7 @@
 #pragma once
 
+// Calls back on the thread that created it, from its message loop, when a top level window is
+// created, shown, uncloaked or renamed. Those are the moments a window can become relevant.
 class WindowCreationHandler
 {
 public:
@@ -12,7 +14,7 @@ private:
     std::function<void(HWND)> m_windowCreatedCallback;
 
     void InitHooks();
-    void HandleWinHookEvent(DWORD event, HWND window) noexcept;
+    void HandleWinHookEvent(DWORD event, HWND window, LONG object, LONG child) noexcept;
 
     static void CALLBACK WinHookProc(HWINEVENTHOOK winEventHook,
                                      DWORD event,
@@ -24,7 +26,7 @@ private:
     {
         if (s_instance)
         {
-            s_instance->HandleWinHookEvent(event, window);
+            s_instance->HandleWinHookEvent(event, window, object, child);
         }
     }
 };
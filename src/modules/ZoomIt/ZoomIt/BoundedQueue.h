@@ -0,0 +1,110 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Blocking queue with a fixed capacity for passing work between threads
+//
+//==============================================================================
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+//----------------------------------------------------------------------------
+//
+// BoundedQueue
+//
+// Push blocks while the queue is full, which pushes back on the producer,
+// and Pop blocks until an item arrives. After Close, pushes fail and Pop
+// returns the remaining items before returning nothing.
+//
+//----------------------------------------------------------------------------
+template<typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : m_capacity(capacity) {}
+
+    bool Push(T item)
+    {
+        std::unique_lock lock(m_lock);
+        if (m_items.size() >= m_capacity && !m_closed)
+        {
+            m_blockedPushes++;
+            m_notFull.wait(lock, [&] { return m_items.size() < m_capacity || m_closed; });
+        }
+        return PushLocked(std::move(item));
+    }
+
+    bool TryPush(T item)
+    {
+        std::scoped_lock lock(m_lock);
+        if (m_items.size() >= m_capacity)
+        {
+            return false;
+        }
+        return PushLocked(std::move(item));
+    }
+
+    std::optional<T> Pop()
+    {
+        std::unique_lock lock(m_lock);
+        m_notEmpty.wait(lock, [&] { return !m_items.empty() || m_closed; });
+        if (m_items.empty())
+        {
+            return std::nullopt;
+        }
+        T item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return item;
+    }
+
+    void Close()
+    {
+        {
+            std::scoped_lock lock(m_lock);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+    size_t MaxDepth() const
+    {
+        std::scoped_lock lock(m_lock);
+        return m_maxDepth;
+    }
+
+    uint64_t BlockedPushes() const
+    {
+        std::scoped_lock lock(m_lock);
+        return m_blockedPushes;
+    }
+
+private:
+    bool PushLocked(T&& item)
+    {
+        if (m_closed)
+        {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        m_maxDepth = (std::max)(m_maxDepth, m_items.size());
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    const size_t m_capacity;
+    mutable std::mutex m_lock;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<T> m_items;
+    bool m_closed = false;
+    size_t m_maxDepth = 0;
+    uint64_t m_blockedPushes = 0;
+};
@@ -0,0 +1,514 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Tile based undo history for the drawing canvas
+//
+//==============================================================================
+#include "pch.h"
+#include "zoomit.h"
+#include "DrawUndoHistory.h"
+
+namespace
+{
+    constexpr int TILE_SIZE = 64;
+
+    // Tiles are compressed as runs of identical pixels and literal pixels,
+    // each introduced by a 16-bit count with the top bit set for runs.
+    constexpr size_t MAX_RUN = 0x7FFF;
+    constexpr size_t MIN_RUN = 3;
+    constexpr WORD RUN_FLAG = 0x8000;
+
+    void AppendCount( std::vector<BYTE>& out, size_t count, WORD flags )
+    {
+        const WORD control = static_cast<WORD>( count ) | flags;
+        out.push_back( static_cast<BYTE>( control & 0xFF ) );
+        out.push_back( static_cast<BYTE>( control >> 8 ) );
+    }
+
+    void AppendPixels( std::vector<BYTE>& out, const DWORD* pixels, size_t count )
+    {
+        const BYTE* bytes = reinterpret_cast<const BYTE*>( pixels );
+        out.insert( out.end(), bytes, bytes + count * sizeof( DWORD ) );
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // CompressPixels
+    //
+    //----------------------------------------------------------------------------
+    void CompressPixels( const DWORD* pixels, size_t count, std::vector<BYTE>& out )
+    {
+        size_t i = 0;
+        while( i < count )
+        {
+            size_t run = 1;
+            while( i + run < count && run < MAX_RUN && pixels[i + run] == pixels[i] )
+            {
+                run++;
+            }
+            if( run >= MIN_RUN )
+            {
+                AppendCount( out, run, RUN_FLAG );
+                AppendPixels( out, pixels + i, 1 );
+                i += run;
+                continue;
+            }
+
+            // Collect literal pixels up to the start of the next run
+            const size_t start = i;
+            while( i < count && i - start < MAX_RUN )
+            {
+                if( i + MIN_RUN <= count && pixels[i] == pixels[i + 1] && pixels[i] == pixels[i + 2] )
+                {
+                    break;
+                }
+                i++;
+            }
+            AppendCount( out, i - start, 0 );
+            AppendPixels( out, pixels + start, i - start );
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // DecompressPixels
+    //
+    //----------------------------------------------------------------------------
+    void DecompressPixels( const std::vector<BYTE>& data, DWORD* pixels, size_t count )
+    {
+        size_t offset = 0;
+        size_t written = 0;
+        while( offset + sizeof( WORD ) <= data.size() && written < count )
+        {
+            const WORD control = static_cast<WORD>( data[offset] | ( data[offset + 1] << 8 ) );
+            offset += sizeof( WORD );
+            const size_t length = min( static_cast<size_t>( control & ~RUN_FLAG ), count - written );
+            if( control & RUN_FLAG )
+            {
+                DWORD pixel;
+                memcpy( &pixel, data.data() + offset, sizeof( pixel ) );
+                offset += sizeof( pixel );
+                std::fill_n( pixels + written, length, pixel );
+            }
+            else
+            {
+                memcpy( pixels + written, data.data() + offset, length * sizeof( DWORD ) );
+                offset += length * sizeof( DWORD );
+            }
+            written += length;
+        }
+    }
+
+    uint64_t HashBytes( const std::vector<BYTE>& data, bool compressed )
+    {
+        uint64_t hash = compressed ? 0xcbf29ce484222325ull : 0x84222325cbf29ce4ull;
+        for( BYTE value : data )
+        {
+            hash = ( hash ^ value ) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // CreateTopDownDIB
+    //
+    // Creates a 32bpp top-down DIB section selected into a new memory DC.
+    //
+    //----------------------------------------------------------------------------
+    bool CreateTopDownDIB( HDC hdc, int width, int height, HDC* memoryDc, HBITMAP* bitmap, HGDIOBJ* prevBitmap, DWORD** pixels )
+    {
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+        bmi.bmiHeader.biWidth = width;
+        bmi.bmiHeader.biHeight = -height;
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = nullptr;
+        *bitmap = CreateDIBSection( hdc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0 );
+        if( *bitmap == NULL )
+        {
+            return false;
+        }
+        *memoryDc = CreateCompatibleDC( hdc );
+        *prevBitmap = SelectObject( *memoryDc, *bitmap );
+        *pixels = static_cast<DWORD*>( bits );
+        return true;
+    }
+
+    void DeleteDIB( HDC* memoryDc, HBITMAP* bitmap, HGDIOBJ prevBitmap, DWORD** pixels )
+    {
+        if( *memoryDc )
+        {
+            SelectObject( *memoryDc, prevBitmap );
+            DeleteDC( *memoryDc );
+            *memoryDc = nullptr;
+        }
+        if( *bitmap )
+        {
+            DeleteObject( *bitmap );
+            *bitmap = nullptr;
+        }
+        *pixels = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::~DrawUndoHistory
+//
+//----------------------------------------------------------------------------
+DrawUndoHistory::~DrawUndoHistory()
+{
+    Clear();
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::CreateBitmaps
+//
+//----------------------------------------------------------------------------
+bool DrawUndoHistory::CreateBitmaps( HDC hdc, int width, int height )
+{
+    if( !CreateTopDownDIB( hdc, width, height, &m_shadowDc, &m_shadowBitmap, &m_shadowPrevBitmap, &m_shadowPixels ) ||
+        !CreateTopDownDIB( hdc, width, TILE_SIZE, &m_bandDc, &m_bandBitmap, &m_bandPrevBitmap, &m_bandPixels ) )
+    {
+        OutputDebugStringW( L"Failed to create undo bitmaps\n" );
+        DeleteBitmaps();
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_tilesX = ( width + TILE_SIZE - 1 ) / TILE_SIZE;
+    m_tilesY = ( height + TILE_SIZE - 1 ) / TILE_SIZE;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::DeleteBitmaps
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::DeleteBitmaps()
+{
+    DeleteDIB( &m_shadowDc, &m_shadowBitmap, m_shadowPrevBitmap, &m_shadowPixels );
+    DeleteDIB( &m_bandDc, &m_bandBitmap, m_bandPrevBitmap, &m_bandPixels );
+    m_width = m_height = 0;
+    m_tilesX = m_tilesY = 0;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::TileRect
+//
+//----------------------------------------------------------------------------
+RECT DrawUndoHistory::TileRect( UINT index ) const
+{
+    const int left = static_cast<int>( index % m_tilesX ) * TILE_SIZE;
+    const int top = static_cast<int>( index / m_tilesX ) * TILE_SIZE;
+    return { left, top, min( left + TILE_SIZE, m_width ), min( top + TILE_SIZE, m_height ) };
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::ForEachChangedTile
+//
+// Reads the canvas one band of tiles at a time and calls back for each tile
+// that differs from the shadow bitmap. While the callback runs, the band
+// holds the canvas rows of the tile.
+//
+//----------------------------------------------------------------------------
+template<typename TileCallback>
+void DrawUndoHistory::ForEachChangedTile( HDC hdc, TileCallback&& onChangedTile )
+{
+    for( UINT tileY = 0; tileY < m_tilesY; tileY++ )
+    {
+        const int top = static_cast<int>( tileY ) * TILE_SIZE;
+        const int rows = min( TILE_SIZE, m_height - top );
+        BitBlt( m_bandDc, 0, 0, m_width, rows, hdc, 0, top, SRCCOPY );
+        GdiFlush();
+
+        for( UINT tileX = 0; tileX < m_tilesX; tileX++ )
+        {
+            const UINT index = tileY * m_tilesX + tileX;
+            const RECT rc = TileRect( index );
+            const size_t rowBytes = static_cast<size_t>( rc.right - rc.left ) * sizeof( DWORD );
+            for( int row = 0; row < rows; row++ )
+            {
+                if( memcmp( m_bandPixels + static_cast<size_t>( row ) * m_width + rc.left,
+                            m_shadowPixels + static_cast<size_t>( top + row ) * m_width + rc.left, rowBytes ) != 0 )
+                {
+                    onChangedTile( index, rc );
+                    break;
+                }
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::StoreTile
+//
+// Compresses a tile of the shadow bitmap, returning an identical tile that's
+// already stored if there is one.
+//
+//----------------------------------------------------------------------------
+DrawUndoHistory::TileRef DrawUndoHistory::StoreTile( const RECT& rc )
+{
+    const int width = rc.right - rc.left;
+    const int height = rc.bottom - rc.top;
+    m_tileScratch.resize( static_cast<size_t>( width ) * height );
+    for( int row = 0; row < height; row++ )
+    {
+        memcpy( m_tileScratch.data() + static_cast<size_t>( row ) * width,
+                m_shadowPixels + static_cast<size_t>( rc.top + row ) * m_width + rc.left,
+                width * sizeof( DWORD ) );
+    }
+
+    auto tile = std::make_shared<TileBlob>();
+    CompressPixels( m_tileScratch.data(), m_tileScratch.size(), tile->data );
+    tile->compressed = tile->data.size() < m_tileScratch.size() * sizeof( DWORD );
+    if( !tile->compressed )
+    {
+        tile->data.assign( reinterpret_cast<const BYTE*>( m_tileScratch.data() ),
+                           reinterpret_cast<const BYTE*>( m_tileScratch.data() + m_tileScratch.size() ) );
+    }
+    tile->data.shrink_to_fit();
+    tile->hash = HashBytes( tile->data, tile->compressed );
+
+    auto& bucket = m_tilePool[tile->hash];
+    for( const auto& existing : bucket )
+    {
+        if( existing->compressed == tile->compressed && existing->data == tile->data )
+        {
+            return existing;
+        }
+    }
+    bucket.push_back( tile );
+    m_tileMemory += sizeof( TileBlob ) + tile->data.size();
+    return tile;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::LoadTile
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::LoadTile( const TileBlob& tile, DWORD* pixels, size_t count ) const
+{
+    if( tile.compressed )
+    {
+        DecompressPixels( tile.data, pixels, count );
+    }
+    else
+    {
+        memcpy( pixels, tile.data.data(), min( tile.data.size(), count * sizeof( DWORD ) ) );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::DropOldest
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::DropOldest()
+{
+    m_states.pop_front();
+    PurgeTiles();
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::PurgeTiles
+//
+// Frees tiles that no state refers to anymore.
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::PurgeTiles()
+{
+    for( auto bucket = m_tilePool.begin(); bucket != m_tilePool.end(); )
+    {
+        auto& tiles = bucket->second;
+        for( auto tile = tiles.begin(); tile != tiles.end(); )
+        {
+            if( tile->use_count() == 1 )
+            {
+                m_tileMemory -= sizeof( TileBlob ) + ( *tile )->data.size();
+                tile = tiles.erase( tile );
+            }
+            else
+            {
+                ++tile;
+            }
+        }
+        bucket = tiles.empty() ? m_tilePool.erase( bucket ) : std::next( bucket );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Push
+//
+// The tiles that changed since the last push are saved, as they were, with
+// the previous state, and the shadow bitmap is brought up to date.
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::Push( HDC hdc, int width, int height )
+{
+    if( !m_states.empty() && ( width != m_width || height != m_height ) )
+    {
+        Clear();
+    }
+
+    if( m_states.empty() )
+    {
+        if( !m_shadowDc && !CreateBitmaps( hdc, width, height ) )
+        {
+            return;
+        }
+        BitBlt( m_shadowDc, 0, 0, width, height, hdc, 0, 0, SRCCOPY | CAPTUREBLT );
+        GdiFlush();
+        m_states.emplace_back();
+        return;
+    }
+
+    auto& previous = m_states.back();
+    ForEachChangedTile( hdc, [&]( UINT index, const RECT& rc ) {
+        previous.tiles.emplace_back( index, StoreTile( rc ) );
+        for( int y = rc.top; y < rc.bottom; y++ )
+        {
+            memcpy( m_shadowPixels + static_cast<size_t>( y ) * m_width + rc.left,
+                    m_bandPixels + static_cast<size_t>( y - rc.top ) * m_width + rc.left,
+                    static_cast<size_t>( rc.right - rc.left ) * sizeof( DWORD ) );
+        }
+    } );
+    m_states.emplace_back();
+
+    while( m_states.size() > static_cast<size_t>( MAX_UNDO_HISTORY ) ||
+           ( m_tileMemory > m_memoryBudget && m_states.size() > 1 ) )
+    {
+        DropOldest();
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Pop
+//
+// Only the tiles that differ from the shadow bitmap are copied back to the
+// canvas. The shadow bitmap then takes on the state below it.
+//
+//----------------------------------------------------------------------------
+BOOLEAN DrawUndoHistory::Pop( HDC hdc, int width, int height )
+{
+    if( m_states.empty() )
+    {
+        return FALSE;
+    }
+    if( width != m_width || height != m_height )
+    {
+        Clear();
+        return FALSE;
+    }
+
+    ForEachChangedTile( hdc, [&]( UINT, const RECT& rc ) {
+        BitBlt( hdc, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top,
+                m_shadowDc, rc.left, rc.top, SRCCOPY | CAPTUREBLT );
+    } );
+    m_states.pop_back();
+    if( m_states.empty() )
+    {
+        Clear();
+        return TRUE;
+    }
+
+    auto& current = m_states.back();
+    for( const auto& [index, tile] : current.tiles )
+    {
+        const RECT rc = TileRect( index );
+        const int tileWidth = rc.right - rc.left;
+        m_tileScratch.resize( static_cast<size_t>( tileWidth ) * ( rc.bottom - rc.top ) );
+        LoadTile( *tile, m_tileScratch.data(), m_tileScratch.size() );
+        for( int y = rc.top; y < rc.bottom; y++ )
+        {
+            memcpy( m_shadowPixels + static_cast<size_t>( y ) * m_width + rc.left,
+                    m_tileScratch.data() + static_cast<size_t>( y - rc.top ) * tileWidth,
+                    tileWidth * sizeof( DWORD ) );
+        }
+    }
+    current.tiles.clear();
+    PurgeTiles();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::Clear
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::Clear()
+{
+    m_states.clear();
+    m_tilePool.clear();
+    m_tileMemory = 0;
+    DeleteBitmaps();
+}
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory::ReadOldest
+//
+// A tile of the oldest state is the copy saved by the oldest state that
+// changed it, or the shadow bitmap's if none did.
+//
+//----------------------------------------------------------------------------
+void DrawUndoHistory::ReadOldest( const RECT& rc, DWORD* pixels ) const
+{
+    RECT canvas = { 0, 0, m_width, m_height };
+    RECT clipped;
+    if( m_states.empty() || !IntersectRect( &clipped, &rc, &canvas ) )
+    {
+        return;
+    }
+
+    const int destWidth = rc.right - rc.left;
+    std::vector<DWORD> tilePixels;
+    for( int tileY = clipped.top / TILE_SIZE; tileY <= ( clipped.bottom - 1 ) / TILE_SIZE; tileY++ )
+    {
+        for( int tileX = clipped.left / TILE_SIZE; tileX <= ( clipped.right - 1 ) / TILE_SIZE; tileX++ )
+        {
+            const UINT index = tileY * m_tilesX + tileX;
+            const RECT tileRc = TileRect( index );
+
+            const DWORD* source = m_shadowPixels + static_cast<size_t>( tileRc.top ) * m_width + tileRc.left;
+            int sourceStride = m_width;
+            for( const auto& state : m_states )
+            {
+                auto saved = std::lower_bound( state.tiles.begin(), state.tiles.end(), index,
+                                               []( const auto& entry, UINT value ) { return entry.first < value; } );
+                if( saved != state.tiles.end() && saved->first == index )
+                {
+                    sourceStride = tileRc.right - tileRc.left;
+                    tilePixels.resize( static_cast<size_t>( sourceStride ) * ( tileRc.bottom - tileRc.top ) );
+                    LoadTile( *saved->second, tilePixels.data(), tilePixels.size() );
+                    source = tilePixels.data();
+                    break;
+                }
+            }
+
+            RECT part;
+            IntersectRect( &part, &tileRc, &clipped );
+            for( int y = part.top; y < part.bottom; y++ )
+            {
+                memcpy( pixels + static_cast<size_t>( y - rc.top ) * destWidth + ( part.left - rc.left ),
+                        source + static_cast<size_t>( y - tileRc.top ) * sourceStride + ( part.left - tileRc.left ),
+                        static_cast<size_t>( part.right - part.left ) * sizeof( DWORD ) );
+            }
+        }
+    }
+}
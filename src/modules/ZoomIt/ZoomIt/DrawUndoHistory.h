@@ -0,0 +1,103 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Tile based undo history for the drawing canvas
+//
+//==============================================================================
+#pragma once
+
+#include "pch.h"
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+//----------------------------------------------------------------------------
+//
+// DrawUndoHistory
+//
+// Keeps the most recently pushed canvas in a single DIB section. Every older
+// state only stores the 64x64 tiles in which it differs from the next newer
+// state, so an action costs memory in proportion to what it drew. Tiles are
+// run length compressed and identical tiles are shared. The oldest states
+// are discarded when the history exceeds its memory budget.
+//
+//----------------------------------------------------------------------------
+class DrawUndoHistory
+{
+public:
+    DrawUndoHistory() = default;
+    ~DrawUndoHistory();
+    DrawUndoHistory( const DrawUndoHistory& ) = delete;
+    DrawUndoHistory& operator=( const DrawUndoHistory& ) = delete;
+
+    void SetMemoryBudget( size_t bytes ) { m_memoryBudget = bytes; }
+
+    // Saves the canvas so that the next Pop restores it.
+    void Push( HDC hdc, int width, int height );
+
+    // Restores the canvas to the most recently pushed state and removes it
+    // from the history. Returns FALSE if there's nothing to undo.
+    BOOLEAN Pop( HDC hdc, int width, int height );
+
+    void Clear();
+    bool Empty() const { return m_states.empty(); }
+
+    // Memory DC holding the most recently pushed canvas
+    HDC TopDc() const { return m_shadowDc; }
+
+    // Copies a rectangle of the oldest state still in the history into a
+    // top-down 32bpp buffer. Pixels outside of the canvas are left alone.
+    void ReadOldest( const RECT& rc, DWORD* pixels ) const;
+
+    size_t TileMemory() const { return m_tileMemory; }
+
+private:
+    struct TileBlob
+    {
+        uint64_t hash;
+        bool compressed;
+        std::vector<BYTE> data;
+    };
+    using TileRef = std::shared_ptr<const TileBlob>;
+
+    // Tiles, sorted by index, in which a state differs from the next newer
+    // one. The newest state has none, it's the shadow bitmap.
+    struct UndoState
+    {
+        std::vector<std::pair<UINT, TileRef>> tiles;
+    };
+
+    bool CreateBitmaps( HDC hdc, int width, int height );
+    void DeleteBitmaps();
+    template<typename TileCallback> void ForEachChangedTile( HDC hdc, TileCallback&& onChangedTile );
+    RECT TileRect( UINT index ) const;
+    TileRef StoreTile( const RECT& rc );
+    void LoadTile( const TileBlob& tile, DWORD* pixels, size_t count ) const;
+    void DropOldest();
+    void PurgeTiles();
+
+    HDC m_shadowDc = nullptr;
+    HBITMAP m_shadowBitmap = nullptr;
+    HGDIOBJ m_shadowPrevBitmap = nullptr;
+    DWORD* m_shadowPixels = nullptr;
+
+    // Band of tile rows the canvas is read through for comparison
+    HDC m_bandDc = nullptr;
+    HBITMAP m_bandBitmap = nullptr;
+    HGDIOBJ m_bandPrevBitmap = nullptr;
+    DWORD* m_bandPixels = nullptr;
+
+    int m_width = 0;
+    int m_height = 0;
+    UINT m_tilesX = 0;
+    UINT m_tilesY = 0;
+
+    std::deque<UndoState> m_states;
+    std::unordered_map<uint64_t, std::vector<TileRef>> m_tilePool;
+    std::vector<DWORD> m_tileScratch;
+    size_t m_tileMemory = 0;
+    size_t m_memoryBudget = 256 * 1024 * 1024;
+};
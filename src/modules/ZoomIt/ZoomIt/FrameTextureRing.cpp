@@ -0,0 +1,97 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Fixed size ring of reusable textures for recorded frames
+//
+//==============================================================================
+#include "pch.h"
+#include "FrameTextureRing.h"
+
+//----------------------------------------------------------------------------
+//
+// FrameTextureRing::FrameTextureRing
+//
+//----------------------------------------------------------------------------
+FrameTextureRing::FrameTextureRing(winrt::com_ptr<ID3D11Device> const& device, uint32_t capacity) :
+    m_device(device),
+    m_entries(capacity)
+{
+}
+
+//----------------------------------------------------------------------------
+//
+// FrameTextureRing::TryAcquire
+//
+// Returns a free texture matching the description, or nothing if all of the
+// ring's textures are in use.
+//
+//----------------------------------------------------------------------------
+std::optional<FrameTextureRing::Slot> FrameTextureRing::TryAcquire(D3D11_TEXTURE2D_DESC const& desc)
+{
+    std::scoped_lock lock(m_lock);
+
+    // Prefer a texture that already has the right description
+    Entry* freeEntry = nullptr;
+    for (auto& entry : m_entries)
+    {
+        if (!entry.inUse)
+        {
+            if (entry.texture && memcmp(&entry.desc, &desc, sizeof(desc)) == 0)
+            {
+                freeEntry = &entry;
+                break;
+            }
+            if (!freeEntry)
+            {
+                freeEntry = &entry;
+            }
+        }
+    }
+    if (!freeEntry)
+    {
+        m_statistics.exhausted++;
+        return std::nullopt;
+    }
+
+    if (!freeEntry->texture || memcmp(&freeEntry->desc, &desc, sizeof(desc)) != 0)
+    {
+        freeEntry->texture = nullptr;
+        winrt::check_hresult(m_device->CreateTexture2D(&desc, nullptr, freeEntry->texture.put()));
+        freeEntry->desc = desc;
+        m_statistics.created++;
+    }
+
+    freeEntry->inUse = true;
+    m_inUse++;
+    m_statistics.acquired++;
+    m_statistics.maxInUse = max(m_statistics.maxInUse, m_inUse);
+    return Slot{ static_cast<uint32_t>(freeEntry - m_entries.data()), freeEntry->texture };
+}
+
+//----------------------------------------------------------------------------
+//
+// FrameTextureRing::Release
+//
+//----------------------------------------------------------------------------
+void FrameTextureRing::Release(uint32_t index)
+{
+    std::scoped_lock lock(m_lock);
+    if (index < m_entries.size() && m_entries[index].inUse)
+    {
+        m_entries[index].inUse = false;
+        m_inUse--;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// FrameTextureRing::Statistics
+//
+//----------------------------------------------------------------------------
+FrameTextureRingStatistics FrameTextureRing::Statistics() const
+{
+    std::scoped_lock lock(m_lock);
+    return m_statistics;
+}
@@ -0,0 +1,64 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Fixed size ring of reusable textures for recorded frames
+//
+//==============================================================================
+#pragma once
+
+#include <winrt/base.h>
+#include <d3d11_4.h>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+struct FrameTextureRingStatistics
+{
+    uint64_t acquired = 0;
+    uint64_t exhausted = 0;
+    uint64_t created = 0;
+    uint32_t maxInUse = 0;
+};
+
+//----------------------------------------------------------------------------
+//
+// FrameTextureRing
+//
+// Hands out textures for frames in flight between recording stages, so a
+// frame doesn't cost a texture allocation. Textures are created on first use
+// and recreated when the requested description changes. When every texture
+// is still in use the ring is exhausted, which is the recording's signal that
+// a later stage can't keep up.
+//
+//----------------------------------------------------------------------------
+class FrameTextureRing
+{
+public:
+    struct Slot
+    {
+        uint32_t index;
+        winrt::com_ptr<ID3D11Texture2D> texture;
+    };
+
+    FrameTextureRing(winrt::com_ptr<ID3D11Device> const& device, uint32_t capacity);
+
+    std::optional<Slot> TryAcquire(D3D11_TEXTURE2D_DESC const& desc);
+    void Release(uint32_t index);
+    FrameTextureRingStatistics Statistics() const;
+
+private:
+    struct Entry
+    {
+        winrt::com_ptr<ID3D11Texture2D> texture;
+        D3D11_TEXTURE2D_DESC desc{};
+        bool inUse = false;
+    };
+
+    winrt::com_ptr<ID3D11Device> m_device;
+    mutable std::mutex m_lock;
+    std::vector<Entry> m_entries;
+    uint32_t m_inUse = 0;
+    FrameTextureRingStatistics m_statistics;
+};
@@ -0,0 +1,651 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Streaming GIF encoder for 32bpp BGRA frames
+//
+//==============================================================================
+#include "pch.h"
+#include "GifEncoder.h"
+
+namespace
+{
+    // Colors are binned by their top 5 bits per channel for the histogram and
+    // for the color lookup table.
+    constexpr uint32_t COLOR_BITS = 5;
+    constexpr uint32_t COLOR_BINS = 1 << (COLOR_BITS * 3);
+    constexpr uint16_t UNMAPPED_COLOR = 0xFFFF;
+
+    // Index 255 is kept free for pixels that didn't change since the last frame.
+    constexpr uint32_t MAX_PALETTE_COLORS = 255;
+    constexpr uint8_t TRANSPARENT_INDEX = 255;
+
+    // Roughly how many pixels are sampled per frame to build the histogram.
+    constexpr uint32_t HISTOGRAM_SAMPLES = 1 << 16;
+
+    // A palette is reused while the average error of a frame stays within a
+    // quarter (plus a few levels) of the error the palette had on the frame it
+    // was built for, and no more than 2 in 1000 sampled pixels are farther from
+    // the palette than the worst color of that frame, or 12 levels per channel.
+    constexpr uint32_t PALETTE_ERROR_SLACK = 3 * 4 * 4;
+    constexpr uint32_t PALETTE_MIN_COLOR_ERROR = 3 * 12 * 12;
+    constexpr uint64_t PALETTE_MAX_POOR_PERMILLE = 2;
+
+    constexpr uint8_t LZW_MIN_CODE_SIZE = 8;
+    constexpr uint32_t LZW_MAX_CODE_SIZE = 12;
+    constexpr uint32_t LZW_MAX_CODES = 1 << LZW_MAX_CODE_SIZE;
+    constexpr uint32_t LZW_HASH_BITS = 13;
+    constexpr uint32_t LZW_HASH_SIZE = 1 << LZW_HASH_BITS;
+    constexpr size_t GIF_MAX_SUB_BLOCK = 255;
+
+    // Leave the frame in place, so the next one only has to draw what changed.
+    constexpr uint8_t DISPOSAL_DO_NOT_DISPOSE = 1;
+
+    uint32_t ColorBin(const uint8_t* bgra)
+    {
+        return (static_cast<uint32_t>(bgra[2] >> 3) << 10) |
+               (static_cast<uint32_t>(bgra[1] >> 3) << 5) |
+               static_cast<uint32_t>(bgra[0] >> 3);
+    }
+
+    uint32_t BinChannel(uint32_t bin, int channel)
+    {
+        return (bin >> (channel * COLOR_BITS)) & ((1 << COLOR_BITS) - 1);
+    }
+
+    uint32_t ExpandChannel(uint32_t value)
+    {
+        return (value << 3) | (value >> 2);
+    }
+
+    uint32_t ColorDistance(uint32_t color, uint32_t red, uint32_t green, uint32_t blue)
+    {
+        const int dr = static_cast<int>((color >> 16) & 0xFF) - static_cast<int>(red);
+        const int dg = static_cast<int>((color >> 8) & 0xFF) - static_cast<int>(green);
+        const int db = static_cast<int>(color & 0xFF) - static_cast<int>(blue);
+        return static_cast<uint32_t>(dr * dr + dg * dg + db * db);
+    }
+
+    void AppendWord(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value & 0xFF));
+        out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // LzwWriter
+    //
+    // Packs variable length codes LSB first into GIF data sub-blocks.
+    //
+    //----------------------------------------------------------------------------
+    class LzwWriter
+    {
+    public:
+        explicit LzwWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+        void WriteCode(uint32_t code, uint32_t codeSize)
+        {
+            m_bits |= code << m_bitCount;
+            m_bitCount += codeSize;
+            while (m_bitCount >= 8)
+            {
+                WriteByte(static_cast<uint8_t>(m_bits & 0xFF));
+                m_bits >>= 8;
+                m_bitCount -= 8;
+            }
+        }
+
+        void Finish()
+        {
+            if (m_bitCount > 0)
+            {
+                WriteByte(static_cast<uint8_t>(m_bits & 0xFF));
+            }
+            FlushBlock();
+            m_out.push_back(0);
+        }
+
+    private:
+        void WriteByte(uint8_t value)
+        {
+            m_block[m_blockSize++] = value;
+            if (m_blockSize == GIF_MAX_SUB_BLOCK)
+            {
+                FlushBlock();
+            }
+        }
+
+        void FlushBlock()
+        {
+            if (m_blockSize > 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_blockSize));
+                m_out.insert(m_out.end(), m_block, m_block + m_blockSize);
+                m_blockSize = 0;
+            }
+        }
+
+        std::vector<uint8_t>& m_out;
+        uint32_t m_bits = 0;
+        uint32_t m_bitCount = 0;
+        uint8_t m_block[GIF_MAX_SUB_BLOCK] = {};
+        size_t m_blockSize = 0;
+    };
+
+    //----------------------------------------------------------------------------
+    //
+    // AppendLzwData
+    //
+    // LZW compresses 8-bit palette indices into GIF image data. The string
+    // table is an open addressing hash of (prefix code, next index) pairs,
+    // which is cheap to reset each time the 12-bit code space fills up.
+    //
+    //----------------------------------------------------------------------------
+    void AppendLzwData(std::vector<uint8_t>& out, const uint8_t* indices, size_t count)
+    {
+        constexpr uint32_t clearCode = 1 << LZW_MIN_CODE_SIZE;
+        constexpr uint32_t endCode = clearCode + 1;
+
+        std::vector<int32_t> keys(LZW_HASH_SIZE, -1);
+        std::vector<uint16_t> codes(LZW_HASH_SIZE);
+        auto slotFor = [&](int32_t key) {
+            uint32_t slot = (static_cast<uint32_t>(key) * 2654435761u) >> (32 - LZW_HASH_BITS);
+            while (keys[slot] != -1 && keys[slot] != key)
+            {
+                slot = (slot + 1) & (LZW_HASH_SIZE - 1);
+            }
+            return slot;
+        };
+
+        out.push_back(LZW_MIN_CODE_SIZE);
+        LzwWriter writer(out);
+
+        uint32_t codeSize = LZW_MIN_CODE_SIZE + 1;
+        uint32_t nextCode = endCode + 1;
+        writer.WriteCode(clearCode, codeSize);
+
+        uint32_t prefix = indices[0];
+        for (size_t i = 1; i < count; i++)
+        {
+            const int32_t key = static_cast<int32_t>((prefix << 8) | indices[i]);
+            const uint32_t slot = slotFor(key);
+            if (keys[slot] == key)
+            {
+                prefix = codes[slot];
+                continue;
+            }
+
+            writer.WriteCode(prefix, codeSize);
+            keys[slot] = key;
+            codes[slot] = static_cast<uint16_t>(nextCode++);
+            if (nextCode == LZW_MAX_CODES)
+            {
+                writer.WriteCode(clearCode, codeSize);
+                std::fill(keys.begin(), keys.end(), -1);
+                codeSize = LZW_MIN_CODE_SIZE + 1;
+                nextCode = endCode + 1;
+            }
+            else if (nextCode > (1u << codeSize))
+            {
+                codeSize++;
+            }
+            prefix = indices[i];
+        }
+
+        writer.WriteCode(prefix, codeSize);
+
+        // The decoder adds the entry the loop would have added next after reading the last
+        // prefix, so the end code has to follow the same code size increment
+        if (nextCode == (1u << codeSize))
+        {
+            codeSize++;
+        }
+        writer.WriteCode(endCode, codeSize);
+        writer.Finish();
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::GifEncoder
+//
+//----------------------------------------------------------------------------
+GifEncoder::GifEncoder(uint32_t width, uint32_t height, WriteCallback write) :
+    m_width(width),
+    m_height(height),
+    m_write(std::move(write))
+{
+    m_histogram.counts.assign(COLOR_BINS, 0);
+    m_histogram.sums.assign(COLOR_BINS * 3, 0);
+    m_colorLookup.assign(COLOR_BINS, UNMAPPED_COLOR);
+
+    std::vector<uint8_t> header{ 'G', 'I', 'F', '8', '9', 'a' };
+    AppendWord(header, m_width);
+    AppendWord(header, m_height);
+    // No global color table, every frame carries its own
+    header.insert(header.end(), { 0, 0, 0 });
+
+    // NETSCAPE2.0 application extension with a loop count of 0 (forever)
+    header.insert(header.end(), { 0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0' });
+    header.insert(header.end(), { 3, 1, 0, 0, 0 });
+    Write(header);
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::BuildHistogram
+//
+// Counts the colors of a grid of sampled pixels, remembering the sum of the
+// exact colors in each bin so palette entries aren't snapped to bin centers.
+//
+//----------------------------------------------------------------------------
+void GifEncoder::BuildHistogram(const uint8_t* pixels, uint32_t rowPitch)
+{
+    for (auto bin : m_histogram.bins)
+    {
+        m_histogram.counts[bin] = 0;
+        m_histogram.sums[bin * 3] = 0;
+        m_histogram.sums[bin * 3 + 1] = 0;
+        m_histogram.sums[bin * 3 + 2] = 0;
+    }
+    m_histogram.bins.clear();
+    m_histogram.total = 0;
+
+    const uint64_t pixelCount = static_cast<uint64_t>(m_width) * m_height;
+    const uint32_t step = max(1u, static_cast<uint32_t>(std::sqrt(static_cast<double>(pixelCount) / HISTOGRAM_SAMPLES)));
+    for (uint32_t y = step / 2; y < m_height; y += step)
+    {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * rowPitch;
+        for (uint32_t x = step / 2; x < m_width; x += step)
+        {
+            const uint8_t* pixel = row + x * 4;
+            const uint32_t bin = ColorBin(pixel);
+            if (m_histogram.counts[bin]++ == 0)
+            {
+                m_histogram.bins.push_back(static_cast<uint16_t>(bin));
+            }
+            m_histogram.sums[bin * 3] += pixel[2];
+            m_histogram.sums[bin * 3 + 1] += pixel[1];
+            m_histogram.sums[bin * 3 + 2] += pixel[0];
+            m_histogram.total++;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::MeasurePaletteError
+//
+// Returns the pixel weighted average distance of the histogram colors from
+// their closest palette colors, along with the largest such distance.
+//
+//----------------------------------------------------------------------------
+GifEncoder::PaletteError GifEncoder::MeasurePaletteError(uint32_t poorDistance)
+{
+    PaletteError error;
+    uint64_t totalDistance = 0;
+    for (auto bin : m_histogram.bins)
+    {
+        const uint32_t count = m_histogram.counts[bin];
+        const uint32_t color = m_palette[LookupColor(bin)];
+        const uint32_t distance = ColorDistance(color,
+                                                static_cast<uint32_t>(m_histogram.sums[bin * 3] / count),
+                                                static_cast<uint32_t>(m_histogram.sums[bin * 3 + 1] / count),
+                                                static_cast<uint32_t>(m_histogram.sums[bin * 3 + 2] / count));
+        totalDistance += static_cast<uint64_t>(distance) * count;
+        error.worst = max(error.worst, distance);
+        if (distance > poorDistance)
+        {
+            error.poorlyMatched += count;
+        }
+    }
+    error.average = m_histogram.total ? static_cast<uint32_t>(totalDistance / m_histogram.total) : 0;
+    return error;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::PaletteFitsHistogram
+//
+// Screen recordings mostly keep the same colors from frame to frame, so the
+// last palette (and its lookup table) is kept unless the frame would be
+// drawn noticeably worse than the frame the palette was built for.
+//
+//----------------------------------------------------------------------------
+bool GifEncoder::PaletteFitsHistogram()
+{
+    if (m_palette.empty())
+    {
+        return false;
+    }
+
+    const auto error = MeasurePaletteError(max(m_paletteError.worst, PALETTE_MIN_COLOR_ERROR));
+    return error.average <= m_paletteError.average + m_paletteError.average / 4 + PALETTE_ERROR_SLACK &&
+           error.poorlyMatched * 1000 <= m_histogram.total * PALETTE_MAX_POOR_PERMILLE;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::BuildPalette
+//
+// Median cut over the histogram bins: the box with the most pixels times
+// its widest channel range is split at the weighted median of that channel
+// until there are enough boxes, and each box becomes the average of its colors.
+//
+//----------------------------------------------------------------------------
+void GifEncoder::BuildPalette()
+{
+    struct ColorBox
+    {
+        size_t begin;
+        size_t end;
+        uint64_t count;
+        int channel;
+        uint32_t range;
+    };
+
+    std::vector<uint16_t> bins = m_histogram.bins;
+    auto makeBox = [&](size_t begin, size_t end) {
+        ColorBox box{ begin, end, 0, 0, 0 };
+        uint32_t low[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+        uint32_t high[3] = {};
+        for (size_t i = begin; i < end; i++)
+        {
+            box.count += m_histogram.counts[bins[i]];
+            for (int channel = 0; channel < 3; channel++)
+            {
+                low[channel] = min(low[channel], BinChannel(bins[i], channel));
+                high[channel] = max(high[channel], BinChannel(bins[i], channel));
+            }
+        }
+        for (int channel = 0; channel < 3; channel++)
+        {
+            if (high[channel] - low[channel] > box.range)
+            {
+                box.range = high[channel] - low[channel];
+                box.channel = channel;
+            }
+        }
+        return box;
+    };
+
+    std::vector<ColorBox> boxes;
+    if (!bins.empty())
+    {
+        boxes.push_back(makeBox(0, bins.size()));
+    }
+    while (boxes.size() < MAX_PALETTE_COLORS)
+    {
+        auto split = boxes.end();
+        uint64_t bestScore = 0;
+        for (auto box = boxes.begin(); box != boxes.end(); ++box)
+        {
+            const uint64_t score = box->count * box->range;
+            if (score > bestScore)
+            {
+                bestScore = score;
+                split = box;
+            }
+        }
+        if (split == boxes.end())
+        {
+            break;
+        }
+
+        const ColorBox box = *split;
+        std::sort(bins.begin() + box.begin, bins.begin() + box.end, [&](uint16_t a, uint16_t b) {
+            return BinChannel(a, box.channel) < BinChannel(b, box.channel);
+        });
+        size_t median = box.begin + 1;
+        uint64_t below = m_histogram.counts[bins[box.begin]];
+        while (median < box.end - 1 && below * 2 < box.count)
+        {
+            below += m_histogram.counts[bins[median++]];
+        }
+        *split = makeBox(box.begin, median);
+        boxes.push_back(makeBox(median, box.end));
+    }
+
+    m_palette.clear();
+    for (const auto& box : boxes)
+    {
+        uint64_t sums[3] = {};
+        for (size_t i = box.begin; i < box.end; i++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                sums[channel] += m_histogram.sums[bins[i] * 3 + channel];
+            }
+        }
+        m_palette.push_back(static_cast<uint32_t>(sums[0] / box.count) << 16 |
+                            static_cast<uint32_t>(sums[1] / box.count) << 8 |
+                            static_cast<uint32_t>(sums[2] / box.count));
+    }
+    if (m_palette.empty())
+    {
+        m_palette.push_back(0);
+    }
+
+    std::fill(m_colorLookup.begin(), m_colorLookup.end(), UNMAPPED_COLOR);
+    m_paletteError = MeasurePaletteError(UINT32_MAX);
+    m_palettesBuilt++;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::LookupColor
+//
+// Returns the palette index closest to a color bin, searching the palette
+// only the first time the bin is seen with the current palette.
+//
+//----------------------------------------------------------------------------
+uint8_t GifEncoder::LookupColor(uint32_t bin)
+{
+    if (m_colorLookup[bin] == UNMAPPED_COLOR)
+    {
+        const uint32_t red = ExpandChannel(BinChannel(bin, 2));
+        const uint32_t green = ExpandChannel(BinChannel(bin, 1));
+        const uint32_t blue = ExpandChannel(BinChannel(bin, 0));
+        uint32_t bestDistance = UINT32_MAX;
+        for (size_t i = 0; i < m_palette.size() && bestDistance > 0; i++)
+        {
+            const uint32_t distance = ColorDistance(m_palette[i], red, green, blue);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                m_colorLookup[bin] = static_cast<uint16_t>(i);
+            }
+        }
+    }
+    return static_cast<uint8_t>(m_colorLookup[bin]);
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::AddFrame
+//
+//----------------------------------------------------------------------------
+void GifEncoder::AddFrame(const uint8_t* pixels, uint32_t rowPitch, uint16_t delay)
+{
+    if (m_finished)
+    {
+        return;
+    }
+
+    BuildHistogram(pixels, rowPitch);
+    if (!PaletteFitsHistogram())
+    {
+        BuildPalette();
+    }
+
+    // Map the frame to the palette and find the rectangle that looks
+    // different from what the previous frames left on screen.
+    const bool firstFrame = m_displayed.empty();
+    if (firstFrame)
+    {
+        m_displayed.resize(static_cast<size_t>(m_width) * m_height);
+    }
+    m_indices.resize(static_cast<size_t>(m_width) * m_height);
+
+    uint32_t left = m_width, top = m_height, right = 0, bottom = 0;
+    for (uint32_t y = 0; y < m_height; y++)
+    {
+        const uint8_t* row = pixels + static_cast<size_t>(y) * rowPitch;
+        uint8_t* indices = m_indices.data() + static_cast<size_t>(y) * m_width;
+        const uint32_t* displayed = m_displayed.data() + static_cast<size_t>(y) * m_width;
+        for (uint32_t x = 0; x < m_width; x++)
+        {
+            const uint8_t index = LookupColor(ColorBin(row + x * 4));
+            indices[x] = index;
+            if (firstFrame || m_palette[index] != displayed[x])
+            {
+                left = min(left, x);
+                right = max(right, x + 1);
+                top = min(top, y);
+                bottom = y + 1;
+            }
+        }
+    }
+
+    if (left >= right)
+    {
+        AddDelay(delay);
+        return;
+    }
+
+    // Pack the changed rectangle to the front of the index buffer. Pixels
+    // that already show the right color become transparent, which compresses
+    // much better than repeating them.
+    FlushPendingFrame();
+    uint8_t* packed = m_indices.data();
+    for (uint32_t y = top; y < bottom; y++)
+    {
+        for (uint32_t x = left; x < right; x++)
+        {
+            const size_t i = static_cast<size_t>(y) * m_width + x;
+            const uint32_t color = m_palette[m_indices[i]];
+            if (!firstFrame && color == m_displayed[i])
+            {
+                *packed++ = TRANSPARENT_INDEX;
+            }
+            else
+            {
+                m_displayed[i] = color;
+                *packed++ = m_indices[i];
+            }
+        }
+    }
+    EncodeImage(left, top, right - left, bottom - top, m_indices.data(), !firstFrame);
+    m_pendingDelay = delay;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::AddDelay
+//
+// Adds to the delay of the buffered frame. Once that would overflow the
+// 16-bit delay field, the time goes to an empty 1x1 transparent frame.
+//
+//----------------------------------------------------------------------------
+void GifEncoder::AddDelay(uint16_t delay)
+{
+    if (!m_hasPendingFrame)
+    {
+        return;
+    }
+    if (static_cast<uint32_t>(m_pendingDelay) + delay <= UINT16_MAX)
+    {
+        m_pendingDelay = static_cast<uint16_t>(m_pendingDelay + delay);
+        return;
+    }
+
+    FlushPendingFrame();
+    const uint8_t transparent = TRANSPARENT_INDEX;
+    EncodeImage(0, 0, 1, 1, &transparent, true);
+    m_pendingDelay = delay;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::EncodeImage
+//
+// Encodes the image descriptor, local color table and compressed indices of
+// a frame into the pending frame buffer. The graphic control extension is
+// written in front of it once the frame's delay is known.
+//
+//----------------------------------------------------------------------------
+void GifEncoder::EncodeImage(uint32_t left, uint32_t top, uint32_t width, uint32_t height, const uint8_t* indices, bool transparent)
+{
+    auto& frame = m_pendingFrame;
+    frame.clear();
+    frame.push_back(0x2C);
+    AppendWord(frame, left);
+    AppendWord(frame, top);
+    AppendWord(frame, width);
+    AppendWord(frame, height);
+    // Local color table with 2^(7+1) entries
+    frame.push_back(0x80 | 7);
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        const uint32_t color = i < m_palette.size() ? m_palette[i] : 0;
+        frame.push_back(static_cast<uint8_t>((color >> 16) & 0xFF));
+        frame.push_back(static_cast<uint8_t>((color >> 8) & 0xFF));
+        frame.push_back(static_cast<uint8_t>(color & 0xFF));
+    }
+    AppendLzwData(frame, indices, static_cast<size_t>(width) * height);
+
+    m_pendingTransparent = transparent;
+    m_hasPendingFrame = true;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::FlushPendingFrame
+//
+//----------------------------------------------------------------------------
+void GifEncoder::FlushPendingFrame()
+{
+    if (!m_hasPendingFrame)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> control{ 0x21, 0xF9, 4 };
+    control.push_back(static_cast<uint8_t>((DISPOSAL_DO_NOT_DISPOSE << 2) | (m_pendingTransparent ? 1 : 0)));
+    AppendWord(control, m_pendingDelay);
+    control.push_back(TRANSPARENT_INDEX);
+    control.push_back(0);
+    Write(control);
+    Write(m_pendingFrame);
+
+    m_hasPendingFrame = false;
+    m_framesWritten++;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::Finish
+//
+//----------------------------------------------------------------------------
+void GifEncoder::Finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    FlushPendingFrame();
+    Write({ 0x3B });
+    m_finished = true;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder::Write
+//
+//----------------------------------------------------------------------------
+void GifEncoder::Write(const std::vector<uint8_t>& data)
+{
+    m_write(data.data(), data.size());
+}
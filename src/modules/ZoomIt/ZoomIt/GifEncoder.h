@@ -0,0 +1,92 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Streaming GIF encoder for 32bpp BGRA frames
+//
+//==============================================================================
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//----------------------------------------------------------------------------
+//
+// GifEncoder
+//
+// Writes an infinitely looping animated GIF. Frames are quantized with a
+// median cut palette that is reused while it still fits the frame contents,
+// and each frame only stores the rectangle that changed since the previous
+// one, with unchanged pixels inside of it made transparent. Frames that don't
+// change anything are merged into the previous frame by extending its delay.
+//
+//----------------------------------------------------------------------------
+class GifEncoder
+{
+public:
+    using WriteCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    GifEncoder(uint32_t width, uint32_t height, WriteCallback write);
+
+    // Adds a width x height frame of 32bpp BGRA pixels that is shown for the
+    // given number of hundredths of a second.
+    void AddFrame(const uint8_t* pixels, uint32_t rowPitch, uint16_t delay);
+
+    // Writes the buffered frame and the GIF trailer. No frames can be added
+    // afterwards.
+    void Finish();
+
+    uint32_t Width() const { return m_width; }
+    uint32_t Height() const { return m_height; }
+    uint32_t FramesWritten() const { return m_framesWritten; }
+    uint32_t PalettesBuilt() const { return m_palettesBuilt; }
+
+private:
+    struct Histogram
+    {
+        std::vector<uint32_t> counts;
+        std::vector<uint64_t> sums;
+        std::vector<uint16_t> bins;
+        uint64_t total = 0;
+    };
+
+    struct PaletteError
+    {
+        uint32_t average = 0;
+        uint32_t worst = 0;
+        uint64_t poorlyMatched = 0;
+    };
+
+    void BuildHistogram(const uint8_t* pixels, uint32_t rowPitch);
+    PaletteError MeasurePaletteError(uint32_t poorDistance);
+    bool PaletteFitsHistogram();
+    void BuildPalette();
+    uint8_t LookupColor(uint32_t bin);
+    void AddDelay(uint16_t delay);
+    void EncodeImage(uint32_t left, uint32_t top, uint32_t width, uint32_t height, const uint8_t* indices, bool transparent);
+    void FlushPendingFrame();
+    void Write(const std::vector<uint8_t>& data);
+
+    uint32_t m_width;
+    uint32_t m_height;
+    WriteCallback m_write;
+    bool m_finished = false;
+
+    Histogram m_histogram;
+    std::vector<uint32_t> m_palette;
+    PaletteError m_paletteError;
+    std::vector<uint16_t> m_colorLookup;
+    std::vector<uint32_t> m_displayed;
+    std::vector<uint8_t> m_indices;
+    uint32_t m_palettesBuilt = 0;
+
+    // The last frame is held back until the next one differs from it, so that
+    // its delay can grow to cover identical frames.
+    std::vector<uint8_t> m_pendingFrame;
+    uint16_t m_pendingDelay = 0;
+    bool m_pendingTransparent = false;
+    bool m_hasPendingFrame = false;
+    uint32_t m_framesWritten = 0;
+};
@@ -3,7 +3,7 @@
 // Zoomit
 // Sysinternals - www.sysinternals.com
 //
-// GIF recording support using Windows Imaging Component (WIC)
+// GIF recording support
 //
 //==============================================================================
 #include "pch.h"
@@ -121,93 +121,14 @@ GifRecordingSession::GifRecordingSession(
 
     m_frameDelay = (frameRate > 0) ? (100 / frameRate) : 15;
 
-    // Initialize WIC
-    winrt::check_hresult(CoCreateInstance(
-        CLSID_WICImagingFactory,
-        nullptr,
-        CLSCTX_INPROC_SERVER,
-        IID_PPV_ARGS(m_wicFactory.put())));
-
-    // Create WIC stream from IRandomAccessStream
-    winrt::check_hresult(m_wicFactory->CreateStream(m_wicStream.put()));
+    // Frames are read back and encoded on their own threads
+    m_d3dContext.as<ID3D11Multithread>()->SetMultithreadProtected(true);
+    m_readbackRing = std::make_shared<FrameTextureRing>(m_d3dDevice, c_readbackTextures);
 
     // Get the IStream from the IRandomAccessStream
-    winrt::com_ptr<IStream> streamInterop;
     winrt::check_hresult(CreateStreamOverRandomAccessStream(
         winrt::get_unknown(stream),
-        IID_PPV_ARGS(streamInterop.put())));
-    winrt::check_hresult(m_wicStream->InitializeFromIStream(streamInterop.get()));
-
-    // Create GIF encoder
-    winrt::check_hresult(m_wicFactory->CreateEncoder(
-        GUID_ContainerFormatGif,
-        nullptr,
-        m_gifEncoder.put()));
-
-    winrt::check_hresult(m_gifEncoder->Initialize(m_wicStream.get(), WICBitmapEncoderNoCache));
-
-    // Set global GIF metadata for looping (NETSCAPE2.0 application extension)
-    try
-    {
-        winrt::com_ptr<IWICMetadataQueryWriter> encoderMetadataWriter;
-        if (SUCCEEDED(m_gifEncoder->GetMetadataQueryWriter(encoderMetadataWriter.put())) && encoderMetadataWriter)
-        {
-            OutputDebugStringW(L"Setting NETSCAPE2.0 looping extension on encoder...\n");
-
-            // Set application extension
-            PROPVARIANT propValue;
-            PropVariantInit(&propValue);
-            propValue.vt = VT_UI1 | VT_VECTOR;
-            propValue.caub.cElems = 11;
-            propValue.caub.pElems = static_cast<UCHAR*>(CoTaskMemAlloc(11));
-            if (propValue.caub.pElems != nullptr)
-            {
-                memcpy(propValue.caub.pElems, "NETSCAPE2.0", 11);
-                HRESULT hr = encoderMetadataWriter->SetMetadataByName(L"/appext/application", &propValue);
-                if (SUCCEEDED(hr))
-                {
-                    OutputDebugStringW(L"Encoder application extension set successfully\n");
-                }
-                else
-                {
-                    OutputDebugStringW(L"Failed to set encoder application extension\n");
-                }
-                PropVariantClear(&propValue);
-
-                // Set loop count (0 = infinite)
-                PropVariantInit(&propValue);
-                propValue.vt = VT_UI1 | VT_VECTOR;
-                propValue.caub.cElems = 5;
-                propValue.caub.pElems = static_cast<UCHAR*>(CoTaskMemAlloc(5));
-                if (propValue.caub.pElems != nullptr)
-                {
-                    propValue.caub.pElems[0] = 3;
-                    propValue.caub.pElems[1] = 1;
-                    propValue.caub.pElems[2] = 0;
-                    propValue.caub.pElems[3] = 0;
-                    propValue.caub.pElems[4] = 0;
-                    hr = encoderMetadataWriter->SetMetadataByName(L"/appext/data", &propValue);
-                    if (SUCCEEDED(hr))
-                    {
-                        OutputDebugStringW(L"Encoder loop count set successfully\n");
-                    }
-                    else
-                    {
-                        OutputDebugStringW(L"Failed to set encoder loop count\n");
-                    }
-                    PropVariantClear(&propValue);
-                }
-            }
-        }
-        else
-        {
-            OutputDebugStringW(L"Failed to get encoder metadata writer\n");
-        }
-    }
-    catch (...)
-    {
-        OutputDebugStringW(L"Warning: Failed to set GIF encoder looping metadata\n");
-    }
+        IID_PPV_ARGS(m_outputStream.put())));
 }
 
 //----------------------------------------------------------------------------
@@ -237,69 +158,126 @@ std::shared_ptr<GifRecordingSession> GifRecordingSession::Create(
 
 //----------------------------------------------------------------------------
 //
-// GifRecordingSession::EncodeFrame
+// GifRecordingSession::Statistics
 //
 //----------------------------------------------------------------------------
-HRESULT GifRecordingSession::EncodeFrame(ID3D11Texture2D* frameTexture)
+GifRecordingStatistics GifRecordingSession::Statistics() const
 {
-    try
+    GifRecordingStatistics statistics;
+    statistics.capturedFrames = m_capturedFrames;
+    statistics.droppedFrames = m_droppedFrames;
+    statistics.encodedFrames = m_encodedFrames;
+    statistics.encoderStalls = m_encodeQueue.BlockedPushes();
+    statistics.maxEncodeQueueDepth = m_encodeQueue.MaxDepth();
+    statistics.readback = m_readbackRing->Statistics();
+    return statistics;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::TakeBuffer
+//
+// Returns a pixel buffer of the given size, reusing one the encoder is done
+// with when possible.
+//
+//----------------------------------------------------------------------------
+std::vector<uint8_t> GifRecordingSession::TakeBuffer(size_t size)
+{
+    std::vector<uint8_t> buffer;
     {
-        // Create a staging texture for CPU access
-        D3D11_TEXTURE2D_DESC frameDesc;
-        frameTexture->GetDesc(&frameDesc);
+        std::scoped_lock lock(m_freeBuffersLock);
+        if (!m_freeBuffers.empty())
+        {
+            buffer = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::ReturnBuffer
+//
+//----------------------------------------------------------------------------
+void GifRecordingSession::ReturnBuffer(std::vector<uint8_t>&& buffer)
+{
+    std::scoped_lock lock(m_freeBuffersLock);
+    m_freeBuffers.push_back(std::move(buffer));
+}
+
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::FailPipeline
+//
+// Stops the recording after a pipeline thread failed. Both queues are
+// closed so neither thread stays blocked on the other.
+//
+//----------------------------------------------------------------------------
+void GifRecordingSession::FailPipeline(winrt::hresult_error const& error)
+{
+    OutputDebugStringW(L"Error in GIF recording pipeline: ");
+    OutputDebugStringW(error.message().c_str());
+    OutputDebugStringW(L"\n");
 
-        // GIF encoding with palette generation is VERY slow at high resolutions (4K takes 1 second per frame!)
+    m_pipelineFailed = true;
+    m_readbackQueue.Close();
+    m_encodeQueue.Close();
+    m_frameWait->StopCapture();
+}
+
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::ConvertFrame
+//
+// Maps a readback texture and copies it into a CPU buffer at the GIF size,
+// after which the texture goes back to the ring.
+//
+//----------------------------------------------------------------------------
+GifRecordingSession::ConvertedFrame GifRecordingSession::ConvertFrame(ReadbackFrame const& frame)
+{
+    auto release = wil::scope_exit([&] { m_readbackRing->Release(frame.slot.index); });
+    auto texture = frame.slot.texture.get();
 
-        UINT targetWidth = frameDesc.Width;
-        UINT targetHeight = frameDesc.Height;
+    D3D11_TEXTURE2D_DESC frameDesc;
+    texture->GetDesc(&frameDesc);
 
+    // The GIF size is picked from the first frame. Later frames are scaled
+    // to it if the captured content changes size.
+    if (m_targetWidth == 0)
+    {
+        m_targetWidth = frameDesc.Width;
+        m_targetHeight = frameDesc.Height;
         if (frameDesc.Width > static_cast<uint32_t>(m_width) || frameDesc.Height > static_cast<uint32_t>(m_height))
         {
             float scaleX = static_cast<float>(m_width) / frameDesc.Width;
             float scaleY = static_cast<float>(m_height) / frameDesc.Height;
             float scale = min(scaleX, scaleY);
 
-            targetWidth = static_cast<UINT>(frameDesc.Width * scale);
-            targetHeight = static_cast<UINT>(frameDesc.Height * scale);
-
             // Ensure even dimensions for GIF
-            targetWidth = (targetWidth / 2) * 2;
-            targetHeight = (targetHeight / 2) * 2;
+            m_targetWidth = (static_cast<UINT>(frameDesc.Width * scale) / 2) * 2;
+            m_targetHeight = (static_cast<UINT>(frameDesc.Height * scale) / 2) * 2;
         }
+    }
 
-        D3D11_TEXTURE2D_DESC stagingDesc = frameDesc;
-        stagingDesc.Usage = D3D11_USAGE_STAGING;
-        stagingDesc.BindFlags = 0;
-        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-        stagingDesc.MiscFlags = 0;
-
-        winrt::com_ptr<ID3D11Texture2D> stagingTexture;
-        winrt::check_hresult(m_d3dDevice->CreateTexture2D(&stagingDesc, nullptr, stagingTexture.put()));
-
-        // Copy the frame to staging texture
-        m_d3dContext->CopyResource(stagingTexture.get(), frameTexture);
-
-        // Map the staging texture
-        D3D11_MAPPED_SUBRESOURCE mappedResource;
-        winrt::check_hresult(m_d3dContext->Map(stagingTexture.get(), 0, D3D11_MAP_READ, 0, &mappedResource));
-
-        // Create a new frame in the GIF
-        winrt::com_ptr<IWICBitmapFrameEncode> frameEncode;
-        winrt::com_ptr<IPropertyBag2> propertyBag;
-        winrt::check_hresult(m_gifEncoder->CreateNewFrame(frameEncode.put(), propertyBag.put()));
-
-        // Initialize the frame encoder with property bag
-        winrt::check_hresult(frameEncode->Initialize(propertyBag.get()));
-
-        // CRITICAL: For GIF, we MUST set size and pixel format BEFORE WriteSource
-        // Use target dimensions (may be downsampled)
-        winrt::check_hresult(frameEncode->SetSize(targetWidth, targetHeight));
+    // Poll rather than block in Map, which would hold the device lock and
+    // stall the capture thread until the copy finishes
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    HRESULT hr;
+    while ((hr = m_d3dContext->Map(texture, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource)) == DXGI_ERROR_WAS_STILL_DRAWING)
+    {
+        Sleep(1);
+    }
+    winrt::check_hresult(hr);
+    auto unmap = wil::scope_exit([&] { m_d3dContext->Unmap(texture, 0); });
 
-        // Set the pixel format to 8-bit indexed (required for GIF)
-        WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat8bppIndexed;
-        winrt::check_hresult(frameEncode->SetPixelFormat(&pixelFormat));
+    const UINT rowPitch = m_targetWidth * 4;
+    ConvertedFrame converted{ TakeBuffer(static_cast<size_t>(rowPitch) * m_targetHeight), m_targetWidth, m_targetHeight, frame.delay };
 
-        // Create a WIC bitmap from the BGRA texture data
+    // If we need downsampling, use WIC scaler
+    if (m_targetWidth != frameDesc.Width || m_targetHeight != frameDesc.Height)
+    {
         winrt::com_ptr<IWICBitmap> sourceBitmap;
         winrt::check_hresult(m_wicFactory->CreateBitmapFromMemory(
             frameDesc.Width,
@@ -310,78 +288,124 @@ HRESULT GifRecordingSession::EncodeFrame(ID3D11Texture2D* frameTexture)
             static_cast<BYTE*>(mappedResource.pData),
             sourceBitmap.put()));
 
-        // If we need downsampling, use WIC scaler
-        winrt::com_ptr<IWICBitmapSource> finalSource = sourceBitmap;
-        if (targetWidth != frameDesc.Width || targetHeight != frameDesc.Height)
+        winrt::com_ptr<IWICBitmapScaler> scaler;
+        winrt::check_hresult(m_wicFactory->CreateBitmapScaler(scaler.put()));
+        winrt::check_hresult(scaler->Initialize(
+            sourceBitmap.get(),
+            m_targetWidth,
+            m_targetHeight,
+            WICBitmapInterpolationModeHighQualityCubic));
+        winrt::check_hresult(scaler->CopyPixels(
+            nullptr,
+            rowPitch,
+            static_cast<UINT>(converted.pixels.size()),
+            converted.pixels.data()));
+    }
+    else
+    {
+        auto source = static_cast<const uint8_t*>(mappedResource.pData);
+        for (UINT y = 0; y < m_targetHeight; y++)
         {
-            winrt::com_ptr<IWICBitmapScaler> scaler;
-            winrt::check_hresult(m_wicFactory->CreateBitmapScaler(scaler.put()));
-            winrt::check_hresult(scaler->Initialize(
-                sourceBitmap.get(),
-                targetWidth,
-                targetHeight,
-                WICBitmapInterpolationModeHighQualityCubic));
-            finalSource = scaler;
-
-            OutputDebugStringW((L"Downsampled from " + std::to_wstring(frameDesc.Width) + L"x" + std::to_wstring(frameDesc.Height) +
-                               L" to " + std::to_wstring(targetWidth) + L"x" + std::to_wstring(targetHeight) + L"\n").c_str());
+            memcpy(converted.pixels.data() + static_cast<size_t>(y) * rowPitch, source + static_cast<size_t>(y) * mappedResource.RowPitch, rowPitch);
         }
+    }
+    return converted;
+}
 
-        // Use WriteSource - WIC will handle the BGRA to 8bpp indexed conversion
-        winrt::check_hresult(frameEncode->WriteSource(finalSource.get(), nullptr));
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::ConvertFrames
+//
+// Conversion thread: reads back captured frames and hands them to the
+// encoder thread. Blocking on a full encoder queue keeps the readback
+// textures busy, which makes the capture loop drop frames.
+//
+//----------------------------------------------------------------------------
+void GifRecordingSession::ConvertFrames()
+{
+    winrt::init_apartment(winrt::apartment_type::multi_threaded);
+    try
+    {
+        winrt::check_hresult(CoCreateInstance(
+            CLSID_WICImagingFactory,
+            nullptr,
+            CLSCTX_INPROC_SERVER,
+            IID_PPV_ARGS(m_wicFactory.put())));
 
-        try
+        while (auto frame = m_readbackQueue.Pop())
+        {
+            m_encodeQueue.Push(ConvertFrame(*frame));
+        }
+    }
+    catch (const winrt::hresult_error& error)
+    {
+        FailPipeline(error);
+    }
+    catch (...)
+    {
+        FailPipeline(winrt::hresult_error(winrt::to_hresult()));
+    }
+    m_encodeQueue.Close();
+    m_wicFactory = nullptr;
+    winrt::uninit_apartment();
+}
+
+//----------------------------------------------------------------------------
+//
+// GifRecordingSession::EncodeFrames
+//
+// Encoder thread: writes converted frames to the GIF and finishes the file
+// once the conversion thread is done.
+//
+//----------------------------------------------------------------------------
+void GifRecordingSession::EncodeFrames()
+{
+    winrt::init_apartment(winrt::apartment_type::multi_threaded);
+    try
+    {
+        while (auto frame = m_encodeQueue.Pop())
         {
-            winrt::com_ptr<IWICMetadataQueryWriter> frameMetadataWriter;
-            if (SUCCEEDED(frameEncode->GetMetadataQueryWriter(frameMetadataWriter.put())) && frameMetadataWriter)
+            if (!m_gifEncoder)
             {
-                // Set the frame delay in the metadata (in hundredths of a second)
-                PROPVARIANT propValue;
-                PropVariantInit(&propValue);
-                propValue.vt = VT_UI2;
-                propValue.uiVal = static_cast<USHORT>(m_frameDelay);
-                frameMetadataWriter->SetMetadataByName(L"/grctlext/Delay", &propValue);
-                PropVariantClear(&propValue);
-
-                // Set disposal method (2 = restore to background, needed for animation)
-                PropVariantInit(&propValue);
-                propValue.vt = VT_UI1;
-                propValue.bVal = 2; // Disposal method: restore to background color
-                frameMetadataWriter->SetMetadataByName(L"/grctlext/Disposal", &propValue);
-                PropVariantClear(&propValue);
+                m_gifEncoder = std::make_unique<GifEncoder>(frame->width, frame->height, [stream = m_outputStream](const uint8_t* data, size_t size) {
+                    ULONG written = 0;
+                    winrt::check_hresult(stream->Write(data, static_cast<ULONG>(size), &written));
+                });
             }
+            m_gifEncoder->AddFrame(frame->pixels.data(), frame->width * 4, frame->delay);
+            m_encodedFrames++;
+            ReturnBuffer(std::move(frame->pixels));
         }
-        catch (...)
+
+        // Finish the GIF even if the pipeline failed, so what was recorded
+        // so far is still readable
+        if (m_gifEncoder)
         {
-            // Metadata setting failed, continue anyway
-            OutputDebugStringW(L"Warning: Failed to set GIF frame metadata\n");
+            m_gifEncoder->Finish();
+            OutputDebugStringW((L"GIF frames written: " + std::to_wstring(m_gifEncoder->FramesWritten()) + L"\n").c_str());
+            OutputDebugStringW((L"GIF palettes built: " + std::to_wstring(m_gifEncoder->PalettesBuilt()) + L"\n").c_str());
         }
-
-        // Commit the frame
-        OutputDebugStringW(L"About to commit frame to encoder...\n");
-        winrt::check_hresult(frameEncode->Commit());
-        OutputDebugStringW(L"Frame committed successfully\n");
-
-        // Unmap the staging texture
-        m_d3dContext->Unmap(stagingTexture.get(), 0);
-
-        // Increment and log frame count
-        m_frameCount++;
-        OutputDebugStringW((L"GIF Frame #" + std::to_wstring(m_frameCount) + L" fully encoded and committed\n").c_str());
-
-        return S_OK;
     }
     catch (const winrt::hresult_error& error)
     {
-        OutputDebugStringW(error.message().c_str());
-        return error.code();
+        FailPipeline(error);
     }
+    catch (...)
+    {
+        FailPipeline(winrt::hresult_error(winrt::to_hresult()));
+    }
+    winrt::uninit_apartment();
 }
 
 //----------------------------------------------------------------------------
 //
 // GifRecordingSession::StartAsync
 //
+// Runs the capture loop. Captured frames are copied into textures from the
+// readback ring and passed on to the conversion and encoder threads. When the
+// ring is exhausted because a later stage can't keep up, the frame is dropped
+// and the previous one is simply shown for longer.
+//
 //----------------------------------------------------------------------------
 winrt::IAsyncAction GifRecordingSession::StartAsync()
 {
@@ -390,48 +414,61 @@ winrt::IAsyncAction GifRecordingSession::StartAsync()
     {
         auto self = shared_from_this();
 
-        try
-        {
-            // Start capturing frames
-            auto frameStartTime = std::chrono::high_resolution_clock::now();
-            int captureAttempts = 0;
-            int successfulCaptures = 0;
-            int duplicatedFrames = 0;
+        std::thread convertThread([this] { ConvertFrames(); });
+        std::thread encodeThread([this] { EncodeFrames(); });
 
-            // Keep track of the last frame to duplicate when needed
-            winrt::com_ptr<ID3D11Texture2D> lastCroppedTexture;
+        // Joined on every way out of the capture loop, a joinable thread
+        // going out of scope would terminate the process
+        auto joinPipeline = wil::scope_exit([&] {
+            m_readbackQueue.Close();
+            convertThread.join();
+            encodeThread.join();
+        });
 
-            while (m_isRecording && !m_closed)
-            {
-                captureAttempts++;
-                auto frame = m_frameWait->TryGetNextFrame();
+        auto frameStartTime = std::chrono::steady_clock::now();
+        const auto frameInterval = std::chrono::milliseconds(1000 / m_frameRate);
+        auto nextFrameTime = frameStartTime;
 
-                winrt::com_ptr<ID3D11Texture2D> croppedTexture;
+        // Each frame is held until the next one arrives, so its delay can be
+        // the time it was actually on screen. Delays are derived from the
+        // time since the first frame so that rounding doesn't add up.
+        std::optional<ReadbackFrame> heldFrame;
+        winrt::TimeSpan firstFrameTime{};
+        int64_t elapsedDelay = 0;
 
-                if (frame)
+        try
+        {
+            while (m_isRecording && !m_closed && !m_pipelineFailed)
+            {
+                auto frame = m_frameWait->TryGetNextFrame();
+                if (!frame)
+                {
+                    break;
+                }
+                m_capturedFrames++;
+
+                auto contentSize = frame->ContentSize;
+                auto frameTexture = GetDXGIInterfaceFromObject<ID3D11Texture2D>(frame->FrameTexture);
+                D3D11_TEXTURE2D_DESC desc = {};
+                frameTexture->GetDesc(&desc);
+
+                // Use the smaller of the crop size or content size
+                auto width = min(m_rcCrop.right - m_rcCrop.left, contentSize.Width);
+                auto height = min(m_rcCrop.bottom - m_rcCrop.top, contentSize.Height);
+
+                D3D11_TEXTURE2D_DESC readbackDesc = {};
+                readbackDesc.Width = width;
+                readbackDesc.Height = height;
+                readbackDesc.MipLevels = 1;
+                readbackDesc.ArraySize = 1;
+                readbackDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+                readbackDesc.SampleDesc.Count = 1;
+                readbackDesc.Usage = D3D11_USAGE_STAGING;
+                readbackDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+                auto slot = m_readbackRing->TryAcquire(readbackDesc);
+                if (slot)
                 {
-                    successfulCaptures++;
-                    auto contentSize = frame->ContentSize;
-                    auto frameTexture = GetDXGIInterfaceFromObject<ID3D11Texture2D>(frame->FrameTexture);
-                    D3D11_TEXTURE2D_DESC desc = {};
-                    frameTexture->GetDesc(&desc);
-
-                    // Use the smaller of the crop size or content size
-                    auto width = min(m_rcCrop.right - m_rcCrop.left, contentSize.Width);
-                    auto height = min(m_rcCrop.bottom - m_rcCrop.top, contentSize.Height);
-
-                    D3D11_TEXTURE2D_DESC croppedDesc = {};
-                    croppedDesc.Width = width;
-                    croppedDesc.Height = height;
-                    croppedDesc.MipLevels = 1;
-                    croppedDesc.ArraySize = 1;
-                    croppedDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-                    croppedDesc.SampleDesc.Count = 1;
-                    croppedDesc.Usage = D3D11_USAGE_DEFAULT;
-                    croppedDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
-
-                    winrt::check_hresult(m_d3dDevice->CreateTexture2D(&croppedDesc, nullptr, croppedTexture.put()));
-
                     // Set the content region to copy and clamp the coordinates
                     D3D11_BOX region = {};
                     region.left = std::clamp(m_rcCrop.left, static_cast<LONG>(0), static_cast<LONG>(desc.Width));
@@ -442,54 +479,47 @@ winrt::IAsyncAction GifRecordingSession::StartAsync()
 
                     // Copy the cropped region
                     m_d3dContext->CopySubresourceRegion(
-                        croppedTexture.get(),
+                        slot->texture.get(),
                         0,
                         0, 0, 0,
                         frameTexture.get(),
                         0,
                         &region);
 
-                    // Save this as the last frame for duplication
-                    lastCroppedTexture = croppedTexture;
+                    if (heldFrame)
+                    {
+                        const int64_t sinceFirstFrame = (frame->SystemRelativeTime - firstFrameTime).count() / 100000;
+                        const int64_t delay = std::clamp<int64_t>(sinceFirstFrame - elapsedDelay, 1, UINT16_MAX);
+                        elapsedDelay += delay;
+                        heldFrame->delay = static_cast<uint16_t>(delay);
+                        if (!m_readbackQueue.Push(std::move(*heldFrame)))
+                        {
+                            m_readbackRing->Release(heldFrame->slot.index);
+                        }
+                    }
+                    else
+                    {
+                        firstFrameTime = frame->SystemRelativeTime;
+                    }
+                    heldFrame = ReadbackFrame{ std::move(*slot), static_cast<uint16_t>(m_frameDelay) };
                 }
-                else if (lastCroppedTexture)
+                else
                 {
-                    // No new frame, duplicate the last one
-                    duplicatedFrames++;
-                    croppedTexture = lastCroppedTexture;
+                    m_droppedFrames++;
                 }
 
-                // Encode the frame (either new or duplicated)
-                if (croppedTexture)
+                // Wait for the next frame interval. A loop that fell behind
+                // continues from now instead of trying to catch up.
+                nextFrameTime += frameInterval;
+                auto now = std::chrono::steady_clock::now();
+                if (nextFrameTime > now)
                 {
-                    HRESULT hr = EncodeFrame(croppedTexture.get());
-                    if (FAILED(hr))
-                    {
-                        CloseInternal();
-                        break;
-                    }
+                    co_await winrt::resume_after(nextFrameTime - now);
+                }
+                else
+                {
+                    nextFrameTime = now;
                 }
-
-                // Wait for the next frame interval
-                co_await winrt::resume_after(std::chrono::milliseconds(1000 / m_frameRate));
-            }
-
-            // Commit the GIF encoder
-            if (m_gifEncoder)
-            {
-                auto frameEndTime = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEndTime - frameStartTime).count();
-
-                OutputDebugStringW(L"Recording stopped. Committing GIF encoder...\n");
-                OutputDebugStringW((L"Total frames captured: " + std::to_wstring(m_frameCount) + L"\n").c_str());
-                OutputDebugStringW((L"Capture attempts: " + std::to_wstring(captureAttempts) + L"\n").c_str());
-                OutputDebugStringW((L"Successful captures: " + std::to_wstring(successfulCaptures) + L"\n").c_str());
-                OutputDebugStringW((L"Duplicated frames: " + std::to_wstring(duplicatedFrames) + L"\n").c_str());
-                OutputDebugStringW((L"Recording duration: " + std::to_wstring(duration) + L"ms\n").c_str());
-                OutputDebugStringW((L"Actual FPS: " + std::to_wstring(m_frameCount * 1000.0 / duration) + L"\n").c_str());
-
-                winrt::check_hresult(m_gifEncoder->Commit());
-                OutputDebugStringW(L"GIF encoder committed successfully\n");
             }
         }
         catch (const winrt::hresult_error& error)
@@ -497,17 +527,39 @@ winrt::IAsyncAction GifRecordingSession::StartAsync()
             OutputDebugStringW(L"Error in GIF recording: ");
             OutputDebugStringW(error.message().c_str());
             OutputDebugStringW(L"\n");
+            m_pipelineFailed = true;
+        }
+        catch (...)
+        {
+            OutputDebugStringW(L"Error in GIF recording: ");
+            OutputDebugStringW(winrt::hresult_error(winrt::to_hresult()).message().c_str());
+            OutputDebugStringW(L"\n");
+            m_pipelineFailed = true;
+        }
 
-            // Try to commit the encoder even on error
-            if (m_gifEncoder)
-            {
-                try
-                {
-                    m_gifEncoder->Commit();
-                }
-                catch (...) {}
-            }
+        // The last frame keeps the default delay
+        if (heldFrame && !m_readbackQueue.Push(std::move(*heldFrame)))
+        {
+            m_readbackRing->Release(heldFrame->slot.index);
+        }
 
+        // Let the pipeline drain and finish the GIF
+        joinPipeline.reset();
+
+        auto frameEndTime = std::chrono::steady_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEndTime - frameStartTime).count();
+        auto statistics = Statistics();
+        OutputDebugStringW(L"Recording stopped.\n");
+        OutputDebugStringW((L"Captured frames: " + std::to_wstring(statistics.capturedFrames) + L"\n").c_str());
+        OutputDebugStringW((L"Dropped frames: " + std::to_wstring(statistics.droppedFrames) + L"\n").c_str());
+        OutputDebugStringW((L"Encoded frames: " + std::to_wstring(statistics.encodedFrames) + L"\n").c_str());
+        OutputDebugStringW((L"Encoder stalls: " + std::to_wstring(statistics.encoderStalls) + L"\n").c_str());
+        OutputDebugStringW((L"Max encode queue depth: " + std::to_wstring(statistics.maxEncodeQueueDepth) + L"\n").c_str());
+        OutputDebugStringW((L"Max readback textures in use: " + std::to_wstring(statistics.readback.maxInUse) + L"\n").c_str());
+        OutputDebugStringW((L"Recording duration: " + std::to_wstring(duration) + L"ms\n").c_str());
+
+        if (m_pipelineFailed)
+        {
             CloseInternal();
         }
     }
@@ -3,15 +3,28 @@
 // Zoomit
 // Sysinternals - www.sysinternals.com
 //
-// GIF recording support using Windows Imaging Component (WIC)
+// GIF recording support
 //
 //==============================================================================
 #pragma once
 
+#include "BoundedQueue.h"
 #include "CaptureFrameWait.h"
+#include "FrameTextureRing.h"
+#include "GifEncoder.h"
 #include <d3d11_4.h>
 #include <vector>
 
+struct GifRecordingStatistics
+{
+    uint64_t capturedFrames = 0;
+    uint64_t droppedFrames = 0;
+    uint64_t encodedFrames = 0;
+    uint64_t encoderStalls = 0;
+    size_t maxEncodeQueueDepth = 0;
+    FrameTextureRingStatistics readback;
+};
+
 class GifRecordingSession : public std::enable_shared_from_this<GifRecordingSession>
 {
 public:
@@ -26,6 +39,7 @@ public:
     winrt::IAsyncAction StartAsync();
     void EnableCursorCapture(bool enable = true) { m_frameWait->EnableCursorCapture(enable); }
     void Close();
+    GifRecordingStatistics Statistics() const;
 
 private:
     GifRecordingSession(
@@ -34,8 +48,32 @@ private:
         RECT const cropRect,
         uint32_t frameRate,
         winrt::Streams::IRandomAccessStream const& stream);
+    // A frame copied into a readback texture, waiting to be mapped
+    struct ReadbackFrame
+    {
+        FrameTextureRing::Slot slot;
+        uint16_t delay;
+    };
+
+    // A frame in CPU memory at the GIF size, waiting to be encoded
+    struct ConvertedFrame
+    {
+        std::vector<uint8_t> pixels;
+        uint32_t width;
+        uint32_t height;
+        uint16_t delay;
+    };
+
     void CloseInternal();
-    HRESULT EncodeFrame(ID3D11Texture2D* texture);
+    void ConvertFrames();
+    ConvertedFrame ConvertFrame(ReadbackFrame const& frame);
+    void EncodeFrames();
+    void FailPipeline(winrt::hresult_error const& error);
+    std::vector<uint8_t> TakeBuffer(size_t size);
+    void ReturnBuffer(std::vector<uint8_t>&& buffer);
+
+    static constexpr uint32_t c_readbackTextures = 4;
+    static constexpr size_t c_encodeQueueDepth = 4;
 
 private:
     winrt::Direct3D11::IDirect3DDevice m_device{ nullptr };
@@ -50,19 +88,28 @@ private:
 
     winrt::Streams::IRandomAccessStream m_stream{ nullptr };
 
-    // WIC components for GIF encoding
+    // Capture -> readback and scaling -> encoding pipeline. WIC is only used
+    // by the conversion thread to downscale frames.
+    std::shared_ptr<FrameTextureRing> m_readbackRing;
+    BoundedQueue<ReadbackFrame> m_readbackQueue{ c_readbackTextures };
+    BoundedQueue<ConvertedFrame> m_encodeQueue{ c_encodeQueueDepth };
+    std::mutex m_freeBuffersLock;
+    std::vector<std::vector<uint8_t>> m_freeBuffers;
     winrt::com_ptr<IWICImagingFactory> m_wicFactory;
-    winrt::com_ptr<IWICStream> m_wicStream;
-    winrt::com_ptr<IWICBitmapEncoder> m_gifEncoder;
-    winrt::com_ptr<IWICMetadataQueryWriter> m_encoderMetadataWriter;
+    winrt::com_ptr<IStream> m_outputStream;
+    std::unique_ptr<GifEncoder> m_gifEncoder;
 
     std::atomic<bool> m_isRecording = false;
     std::atomic<bool> m_closed = false;
+    std::atomic<bool> m_pipelineFailed = false;
+
+    std::atomic<uint64_t> m_capturedFrames = 0;
+    std::atomic<uint64_t> m_droppedFrames = 0;
+    std::atomic<uint64_t> m_encodedFrames = 0;
 
-    uint32_t m_frameWidth=0;
-    uint32_t m_frameHeight=0;
+    uint32_t m_targetWidth=0;
+    uint32_t m_targetHeight=0;
     uint32_t m_frameDelay=0;
-    uint32_t m_frameCount = 0;
 
     int32_t m_width=0;
     int32_t m_height=0;
@@ -0,0 +1,175 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Pixel kernels for blur and highlighter drawing on raw 32bpp BGRA buffers
+//
+//==============================================================================
+#include "pch.h"
+#include "PixelKernels.h"
+
+#if !defined(_M_ARM64)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr DWORD ALPHA_MASK = 0xFF000000;
+    constexpr int BOX_BLUR_PASSES = 3;
+
+    //----------------------------------------------------------------------------
+    //
+    // BoxBlurRow
+    //
+    // Box blurs a row of pixels from source into dest with a running sum per
+    // channel, so the cost doesn't depend on the radius.
+    //
+    //----------------------------------------------------------------------------
+    void BoxBlurRow( DWORD* dest, const DWORD* source, int count, int radius )
+    {
+        const int window = 2 * radius + 1;
+        auto pixelAt = [&]( int index ) { return source[std::clamp( index, 0, count - 1 )]; };
+
+        int sum[4] = {};
+        for( int i = -radius; i <= radius; i++ )
+        {
+            const DWORD pixel = pixelAt( i );
+            for( int channel = 0; channel < 4; channel++ )
+            {
+                sum[channel] += ( pixel >> ( channel * 8 ) ) & 0xFF;
+            }
+        }
+
+        for( int i = 0; i < count; i++ )
+        {
+            DWORD result = 0;
+            for( int channel = 0; channel < 4; channel++ )
+            {
+                result |= static_cast<DWORD>( sum[channel] / window ) << ( channel * 8 );
+            }
+            dest[i] = result;
+
+            const DWORD added = pixelAt( i + radius + 1 );
+            const DWORD removed = pixelAt( i - radius );
+            for( int channel = 0; channel < 4; channel++ )
+            {
+                sum[channel] += static_cast<int>( ( added >> ( channel * 8 ) ) & 0xFF ) -
+                                static_cast<int>( ( removed >> ( channel * 8 ) ) & 0xFF );
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    //
+    // BoxBlurColumns
+    //
+    // Box blurs all columns of source into dest at once. Running sums are kept
+    // for a whole row, so memory is walked row by row instead of down columns.
+    //
+    //----------------------------------------------------------------------------
+    void BoxBlurColumns( DWORD* dest, const DWORD* source, int width, int height, int radius )
+    {
+        const int window = 2 * radius + 1;
+        auto rowAt = [&]( int y ) { return source + static_cast<size_t>( std::clamp( y, 0, height - 1 ) ) * width; };
+        auto accumulate = [&]( std::vector<int>& sums, const DWORD* row, int sign ) {
+            for( int x = 0; x < width; x++ )
+            {
+                for( int channel = 0; channel < 4; channel++ )
+                {
+                    sums[x * 4 + channel] += sign * static_cast<int>( ( row[x] >> ( channel * 8 ) ) & 0xFF );
+                }
+            }
+        };
+
+        std::vector<int> sums( static_cast<size_t>( width ) * 4 );
+        for( int y = -radius; y <= radius; y++ )
+        {
+            accumulate( sums, rowAt( y ), 1 );
+        }
+
+        for( int y = 0; y < height; y++ )
+        {
+            DWORD* row = dest + static_cast<size_t>( y ) * width;
+            for( int x = 0; x < width; x++ )
+            {
+                DWORD result = 0;
+                for( int channel = 0; channel < 4; channel++ )
+                {
+                    result |= static_cast<DWORD>( sums[x * 4 + channel] / window ) << ( channel * 8 );
+                }
+                row[x] = result;
+            }
+
+            accumulate( sums, rowAt( y + radius + 1 ), 1 );
+            accumulate( sums, rowAt( y - radius ), -1 );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// SelectMaskedPixels
+//
+//----------------------------------------------------------------------------
+void SelectMaskedPixels( DWORD* dest, const DWORD* source, const DWORD* mask, size_t count, DWORD colorMask )
+{
+    size_t i = 0;
+
+#if !defined(_M_ARM64)
+    const __m128i alphaMask = _mm_set1_epi32( static_cast<int>( ALPHA_MASK ) );
+    const __m128i sourceMask = _mm_set1_epi32( static_cast<int>( colorMask & ~ALPHA_MASK ) );
+    const __m128i zero = _mm_setzero_si128();
+    for( ; i + 4 <= count; i += 4 )
+    {
+        const __m128i maskPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mask + i ) );
+        const __m128i destPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dest + i ) );
+        const __m128i sourcePixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source + i ) );
+
+        // All ones for pixels which weren't drawn
+        const __m128i notDrawn = _mm_cmpeq_epi32( _mm_and_si128( maskPixels, alphaMask ), zero );
+        const __m128i selected = _mm_or_si128( _mm_and_si128( destPixels, alphaMask ),
+                                               _mm_and_si128( sourcePixels, sourceMask ) );
+        const __m128i result = _mm_or_si128( _mm_and_si128( notDrawn, destPixels ),
+                                             _mm_andnot_si128( notDrawn, selected ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + i ), result );
+    }
+#endif
+
+    for( ; i < count; i++ )
+    {
+        if( mask[i] & ALPHA_MASK )
+        {
+            dest[i] = ( dest[i] & ALPHA_MASK ) | ( source[i] & colorMask & ~ALPHA_MASK );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// BlurPixels
+//
+//----------------------------------------------------------------------------
+void BlurPixels( DWORD* pixels, int width, int height, float radius )
+{
+    if( width <= 0 || height <= 0 )
+    {
+        return;
+    }
+
+    // The variance of three box passes with this radius matches a gaussian
+    // with sigma of about a third of the blur radius
+    const int boxRadius = max( 1, static_cast<int>( radius / BOX_BLUR_PASSES + 0.5f ) );
+
+    std::vector<DWORD> copy( static_cast<size_t>( width ) * height );
+    for( int pass = 0; pass < BOX_BLUR_PASSES; pass++ )
+    {
+        for( int y = 0; y < height; y++ )
+        {
+            const size_t offset = static_cast<size_t>( y ) * width;
+            BoxBlurRow( copy.data() + offset, pixels + offset, width, boxRadius );
+        }
+
+        BoxBlurColumns( pixels, copy.data(), width, height, boxRadius );
+    }
+}
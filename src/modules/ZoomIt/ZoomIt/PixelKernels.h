@@ -0,0 +1,20 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Pixel kernels for blur and highlighter drawing on raw 32bpp BGRA buffers
+//
+//==============================================================================
+#pragma once
+
+#include "pch.h"
+
+// Replaces the color (but not the alpha) of every destination pixel whose
+// mask pixel has a non-zero alpha with the source pixel ANDed with colorMask.
+void SelectMaskedPixels( DWORD* dest, const DWORD* source, const DWORD* mask, size_t count, DWORD colorMask );
+
+// Separable blur of a width x height buffer. Three box blur passes approximate
+// a gaussian with the given radius. Pixels outside of the buffer are treated
+// as copies of the nearest edge pixel.
+void BlurPixels( DWORD* pixels, int width, int height, float radius );
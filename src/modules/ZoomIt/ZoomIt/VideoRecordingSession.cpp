@@ -160,6 +160,7 @@ VideoRecordingSession::VideoRecordingSession(
     winrt::com_ptr<ID3D11Texture2D> backBuffer;
     winrt::check_hresult(m_previewSwapChain->GetBuffer(0, winrt::guid_of<ID3D11Texture2D>(), backBuffer.put_void()));
     winrt::check_hresult(m_d3dDevice->CreateRenderTargetView(backBuffer.get(), nullptr, m_renderTargetView.put()));
+    m_sampleRing = std::make_shared<FrameTextureRing>(m_d3dDevice, c_sampleTextures);
 
     if( captureAudio ) {
 
@@ -254,6 +255,10 @@ void VideoRecordingSession::CloseInternal()
     if(m_audioGenerator) {
         m_audioGenerator->Stop();
     }
+
+    auto statistics = Statistics();
+    OutputDebugStringW((L"Sample textures created: " + std::to_wstring(statistics.created) + L"\n").c_str());
+    OutputDebugStringW((L"Sample texture ring exhausted: " + std::to_wstring(statistics.exhausted) + L"\n").c_str());
     m_frameWait->StopCapture();
     m_itemClosed.revoke();
 }
@@ -351,8 +356,19 @@ void VideoRecordingSession::OnMediaStreamSourceSampleRequested(
                 desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
                 desc.CPUAccessFlags = 0;
                 desc.MiscFlags = 0;
+
+                // Reuse a sample texture the transcoder is done with. If it
+                // is holding on to all of them, fall back to a new texture.
                 winrt::com_ptr<ID3D11Texture2D> sampleTexture;
-                winrt::check_hresult(m_d3dDevice->CreateTexture2D(&desc, nullptr, sampleTexture.put()));
+                auto slot = m_sampleRing->TryAcquire(desc);
+                if (slot)
+                {
+                    sampleTexture = slot->texture;
+                }
+                else
+                {
+                    winrt::check_hresult(m_d3dDevice->CreateTexture2D(&desc, nullptr, sampleTexture.put()));
+                }
                 m_d3dContext->CopyResource(sampleTexture.get(), backBuffer.get());
                 auto dxgiSurface = sampleTexture.as<IDXGISurface>();
                 auto sampleSurface = CreateDirect3DSurface(dxgiSurface.get());
@@ -361,6 +377,13 @@ void VideoRecordingSession::OnMediaStreamSourceSampleRequested(
                 winrt::check_hresult(m_previewSwapChain->Present1(0, 0, &presentParameters));
 
                 auto sample = winrt::MediaStreamSample::CreateFromDirect3D11Surface(sampleSurface, timeStamp);
+                if (slot)
+                {
+                    sample.Processed([ring = m_sampleRing, index = slot->index](auto&&, auto&&)
+                        {
+                            ring->Release(index);
+                        });
+                }
                 request.Sample(sample);
             }
             catch (winrt::hresult_error const& error)
@@ -10,6 +10,7 @@
 
 #include "CaptureFrameWait.h"
 #include "AudioSampleGenerator.h"
+#include "FrameTextureRing.h"
 #include <d3d11_4.h>
 
 class VideoRecordingSession : public std::enable_shared_from_this<VideoRecordingSession>
@@ -27,6 +28,7 @@ public:
     winrt::IAsyncAction StartAsync();
     void EnableCursorCapture(bool enable = true) { m_frameWait->EnableCursorCapture(enable); }
     void Close();
+    FrameTextureRingStatistics Statistics() const { return m_sampleRing->Statistics(); }
 
 private:
     VideoRecordingSession(
@@ -66,6 +68,11 @@ private:
     winrt::com_ptr<IDXGISwapChain1> m_previewSwapChain;
     winrt::com_ptr<ID3D11RenderTargetView> m_renderTargetView;
 
+    // Textures handed to the transcoder come back to the ring once it has
+    // processed the sample
+    static constexpr uint32_t c_sampleTextures = 8;
+    std::shared_ptr<FrameTextureRing> m_sampleRing;
+
     std::atomic<bool> m_isRecording = false;
     std::atomic<bool> m_closed = false;
 };
\ No newline at end of file
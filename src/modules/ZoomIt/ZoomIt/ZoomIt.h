@@ -72,12 +72,6 @@ typedef struct _TYPED_KEY {
     struct _TYPED_KEY *Next;	
 } TYPED_KEY, *P_TYPED_KEY;
 
-typedef struct _DRAW_UNDO {
-    HDC			hDc;
-    HBITMAP		hBitmap;
-    struct _DRAW_UNDO *Next;
-} DRAW_UNDO, *P_DRAW_UNDO;
-
 typedef struct {
     TCHAR		TabTitle[64];
     HWND		hPage;
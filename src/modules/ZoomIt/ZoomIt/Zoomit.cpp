@@ -13,6 +13,8 @@
 
 #include "zoomit.h"
 #include "Utility.h"
+#include "PixelKernels.h"
+#include "DrawUndoHistory.h"
 #include "WindowsVersions.h"
 #include "ZoomItSettings.h"
 #include "GifRecordingSession.h"
@@ -779,30 +781,6 @@ void InvalidateGdiplusRect(HWND hWnd, Gdiplus::Rect BoundsRect)
 
 
 
-//----------------------------------------------------------------------------
-//
-// CreateGdiplusBitmap
-//
-// Creates a gdiplus bitmap of the specified region of the HDC.
-//
-//----------------------------------------------------------------------------
-Gdiplus::Bitmap *CreateGdiplusBitmap( HDC hDc, int x, int y, int Width, int Height )
-{
-    HBITMAP hBitmap = CreateCompatibleBitmap(hDc, Width, Height);
-
-    // Create a device context for the new bitmap
-    HDC hdcNewBitmap = CreateCompatibleDC(hDc);
-    SelectObject(hdcNewBitmap, hBitmap);
-
-    // Copy from the oldest undo bitmap to the new bitmap using the lineBounds as the source rectangle
-    BitBlt(hdcNewBitmap, 0, 0, Width, Height, hDc, x, y, SRCCOPY);
-    Gdiplus::Bitmap *blurBitmap = new Gdiplus::Bitmap(hBitmap, NULL);
-    DeleteDC(hdcNewBitmap);
-    DeleteObject(hBitmap);
-    return blurBitmap;
-}
-
-
 //----------------------------------------------------------------------------
 //
 // CreateBitmapMemoryDIB
@@ -873,41 +851,28 @@ Gdiplus::BitmapData* LockGdiPlusBitmap(Gdiplus::Bitmap* Bitmap)
 //
 // BlurScreen
 //
-// Blur the portion of the screen by copying a blurred bitmap with the
+// Blur the portion of the screen covered by the drawn pixels of the
 // specified shape.
 //
 //----------------------------------------------------------------------------
-void BlurScreen(HDC hdcScreenCompat, Gdiplus::Rect* lineBounds,
-                    Gdiplus::Bitmap *BlurBitmap, BYTE* pPixels)
+void BlurScreen(HDC hdcScreenCompat, Gdiplus::Rect* lineBounds, BYTE* pPixels)
 {
     HDC hdcDIB;
     HBITMAP hDibOrigBitmap, hDibBitmap;
     BYTE* pDestPixels = CreateBitmapMemoryDIB(hdcScreenCompat, hdcScreenCompat, lineBounds,
                                 &hdcDIB, &hDibBitmap, &hDibOrigBitmap);
+    if (pDestPixels == NULL) {
 
-    // Iterate through the pixels
-    for (int y = 0; y < lineBounds->Height; ++y) {
-        for (int x = 0; x < lineBounds->Width; ++x) {
-            int index = (y * lineBounds->Width * 4) + (x * 4);  // Assuming 4 bytes per pixel
-            // BYTE b = pPixels[index + 0];  // Blue channel
-            // BYTE g = pPixels[index + 1];  // Green channel
-            // BYTE r = pPixels[index + 2];  // Red channel
-            BYTE a = pPixels[index + 3];  // Alpha channel
-
-            // Check if this is a drawn pixel
-            if (a != 0) {
-                // get the blur pixel
-                Gdiplus::Color pixel;
-                BlurBitmap->GetPixel(x, y, &pixel);
-
-                COLORREF newPixel = pixel.GetValue() & 0xFFFFFF;
-                pDestPixels[index + 0] = GetRValue(newPixel);
-                pDestPixels[index + 1] = GetGValue(newPixel);
-                pDestPixels[index + 2] = GetBValue(newPixel);
-            }
-        }
+        return;
     }
 
+    // Blur a copy of the screen region and take the blurred pixels where the shape was drawn
+    DWORD* pDest = reinterpret_cast<DWORD*>(pDestPixels);
+    const size_t pixelCount = static_cast<size_t>(lineBounds->Width) * lineBounds->Height;
+    std::vector<DWORD> blurredPixels(pDest, pDest + pixelCount);
+    BlurPixels(blurredPixels.data(), lineBounds->Width, lineBounds->Height, g_BlurRadius);
+    SelectMaskedPixels(pDest, blurredPixels.data(), reinterpret_cast<const DWORD*>(pPixels), pixelCount, 0xFFFFFFFF);
+
     // Copy the updated DIB back to hdcScreenCompat
     BitBlt(hdcScreenCompat, lineBounds->X, lineBounds->Y, lineBounds->Width, lineBounds->Height, hdcDIB, 0, 0, SRCCOPY);
 
@@ -918,38 +883,6 @@ void BlurScreen(HDC hdcScreenCompat, Gdiplus::Rect* lineBounds,
 }
 
 
-
-//----------------------------------------------------------------------------
-//
-// BitmapBlur
-//
-// Blurs the bitmap.
-//
-//----------------------------------------------------------------------------
-void BitmapBlur(Gdiplus::Bitmap* hBitmap)
-{
-    // Git bitmap size
-    Gdiplus::Size bitmapSize;
-    bitmapSize.Width = hBitmap->GetWidth();
-    bitmapSize.Height = hBitmap->GetHeight();
-
-    // Blur the new bitmap
-    Gdiplus::Blur blurObject;
-    Gdiplus::BlurParams blurParams;
-    blurParams.radius = g_BlurRadius;
-    blurParams.expandEdge = FALSE;
-    blurObject.SetParameters(&blurParams);
-
-    // Apply blur to image
-    RECT linesRect;
-    linesRect.left = 0;
-    linesRect.top = 0;
-    linesRect.right = bitmapSize.Width;
-    linesRect.bottom = bitmapSize.Height;
-    hBitmap->ApplyEffect(&blurObject, &linesRect);
-}
-
-
 //----------------------------------------------------------------------------
 //
 // DrawBlurredShape
@@ -986,18 +919,12 @@ void DrawBlurredShape( DWORD Shape, Gdiplus::Pen *pen, HDC hdcScreenCompat, Gdip
     Gdiplus::BitmapData* lineData = LockGdiPlusBitmap(lineBitmap);
     BYTE* pPixels = static_cast<BYTE*>(lineData->Scan0);
 
-    // Create a GDI bitmap that's the size of the lineBounds rectangle
-    Gdiplus::Bitmap* blurBitmap = CreateGdiplusBitmap(hdcScreenCompat,
-        lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height);
-
     // Blur it
-    BitmapBlur(blurBitmap);
-    BlurScreen(hdcScreenCompat, &lineBounds, blurBitmap, pPixels);
+    BlurScreen(hdcScreenCompat, &lineBounds, pPixels);
 
     // Unlock the bits
     lineBitmap->UnlockBits(lineData);
     delete lineBitmap;
-    delete blurBitmap;
 }
 
 //----------------------------------------------------------------------------
@@ -1068,49 +995,20 @@ void AdjustHighlighterColor(BYTE* red, BYTE* green, BYTE* blue) {
 
 //----------------------------------------------------------------------------
 //
-// BlendColors
+// HighlighterColorMask
 //
-// Blends two colors together using the alpha channel of the second color.
-// The highlighter is the second color.
+// Returns the mask that is ANDed with the screen pixels (in BGRA memory
+// order) under the highlighter, which lightens the highlighter color to be
+// more visible. The highlighter color is a COLORREF read as Gdiplus ARGB.
 //
 //----------------------------------------------------------------------------
-COLORREF BlendColors(COLORREF color1, const Gdiplus::Color& color2) {
-
-    BYTE redResult, greenResult, blueResult;
-
-    // Extract the channels from the COLORREF
-    BYTE red1 = GetRValue(color1);
-    BYTE green1 = GetGValue(color1);
-    BYTE blue1 = GetBValue(color1);
-
-    // Get the channels and alpha from the Gdiplus::Color
-    BYTE blue2 = color2.GetRed();
-    BYTE green2 = color2.GetGreen();
-    BYTE red2 = color2.GetBlue();
-    float alpha2 = color2.GetAlpha() / 255.0f;  // Normalize to [0, 1]
-    //alpha2 /= 2; // Use half the alpha for higher contrast
+DWORD HighlighterColorMask(const Gdiplus::Color& highlighter) {
 
-    // Don't blend grey's as much
-    // int minValue = min(red1, min(green1, blue1));
-    // int maxValue = max(red1, max(green1, blue1));
-    if(TRUE) { // red1 > 0x10 && red1 < 0xC0 && (maxValue - minValue < 0x40)) {
-
-        // This does a standard bright highlight
-        alpha2 = 0;
-        AdjustHighlighterColor( &red2, &green2, &blue2 );
-        redResult	= red2 & red1;
-        greenResult = green2 & green1;
-        blueResult	= blue2 & blue1;
-    }
-    else {
-
-        // Blend each channel
-        redResult = static_cast<BYTE>(red2 * alpha2 + red1 * (1 - alpha2));
-        greenResult = static_cast<BYTE>(green2 * alpha2 + green1 * (1 - alpha2));
-        blueResult = static_cast<BYTE>(blue2 * alpha2 + blue1 * (1 - alpha2));
-    }
-    // Combine the result channels back into a COLORREF
-    return RGB(redResult, greenResult, blueResult);
+    BYTE blue = highlighter.GetRed();
+    BYTE green = highlighter.GetGreen();
+    BYTE red = highlighter.GetBlue();
+    AdjustHighlighterColor(&red, &green, &blue);
+    return RGB(blue, green, red);
 }
 
 
@@ -1178,32 +1076,10 @@ void DrawHighlightedShape( DWORD Shape, HDC hdcScreenCompat, Gdiplus::Brush *pBr
     BYTE* pDestPixels2 = CreateBitmapMemoryDIB(hdcScreenCompat, hdcScreenCompat, &lineBounds,
         &hdcDIBOrig, &hDibBitmap, &hDibOrigBitmap);
 
-    for (int y = 0; y < lineBounds.Height; ++y) {
-        for (int x = 0; x < lineBounds.Width; ++x) {
-            int index = (y * lineBounds.Width * 4) + (x * 4);  // Assuming 4 bytes per pixel
-            // BYTE b = pPixels[index + 0];  // Blue channel
-            // BYTE g = pPixels[index + 1];  // Green channel
-            // BYTE r = pPixels[index + 2];  // Red channel
-            BYTE a = pPixels[index + 3];  // Alpha channel
-
-            // Check if this is a drawn pixel
-            if (a != 0) {
-                // Assuming pDestPixels is a valid pointer to the destination bitmap's pixel data
-                BYTE destB = pDestPixels2[index + 0];  // Blue channel
-                BYTE destG = pDestPixels2[index + 1];  // Green channel
-                BYTE destR = pDestPixels2[index + 2];  // Red channel
-
-                // Create a COLORREF value from the destination pixel data
-                COLORREF currentPixel = RGB(destR, destG, destB);
-                // Blend the colors
-                COLORREF newPixel = BlendColors(currentPixel, g_PenColor);
-                // Update the destination pixel data with the new color
-                pDestPixels[index + 0] = GetBValue(newPixel);
-                pDestPixels[index + 1] = GetGValue(newPixel);
-                pDestPixels[index + 2] = GetRValue(newPixel);
-            }
-        }
-    }
+    // Highlight the drawn pixels
+    SelectMaskedPixels(reinterpret_cast<DWORD*>(pDestPixels), reinterpret_cast<const DWORD*>(pDestPixels2),
+        reinterpret_cast<const DWORD*>(pPixels), static_cast<size_t>(lineBounds.Width) * lineBounds.Height,
+        HighlighterColorMask(g_PenColor));
 
     // Copy the updated DIB back to hdcScreenCompat
     BitBlt(hdcScreenCompat, lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height, hdcDIB, 0, 0, SRCCOPY);
@@ -2481,20 +2357,9 @@ INT_PTR CALLBACK OptionsProc( HWND hDlg, UINT message,
 // DeleteDrawUndoList
 //
 //----------------------------------------------------------------------------
-void DeleteDrawUndoList( P_DRAW_UNDO *DrawUndoList )
+void DeleteDrawUndoList( DrawUndoHistory *DrawUndoList )
 {
-    P_DRAW_UNDO	nextUndo;
-
-    nextUndo = *DrawUndoList;
-    while( nextUndo ) {
-
-        *DrawUndoList = nextUndo->Next;
-        DeleteObject( nextUndo->hBitmap );
-        DeleteDC( nextUndo->hDc );
-        free( nextUndo );
-        nextUndo = *DrawUndoList;
-    }
-    *DrawUndoList = NULL;
+    DrawUndoList->Clear();
 }
 
 //----------------------------------------------------------------------------
@@ -2502,20 +2367,11 @@ void DeleteDrawUndoList( P_DRAW_UNDO *DrawUndoList )
 // PopDrawUndo
 //
 //----------------------------------------------------------------------------
-BOOLEAN PopDrawUndo( HDC hDc, P_DRAW_UNDO *DrawUndoList,
+BOOLEAN PopDrawUndo( HDC hDc, DrawUndoHistory *DrawUndoList,
                   int width, int height )
 {
-    P_DRAW_UNDO	nextUndo;
-
-    nextUndo = *DrawUndoList;
-    if( nextUndo ) {
+    if( DrawUndoList->Pop( hDc, width, height )) {
 
-        BitBlt( hDc, 0, 0, width, height,
-            nextUndo->hDc, 0, 0, SRCCOPY|CAPTUREBLT );
-        *DrawUndoList = nextUndo->Next;
-        DeleteObject( nextUndo->hBitmap );
-        DeleteDC( nextUndo->hDc );
-        free( nextUndo );
         return TRUE;
 
     } else {
@@ -2525,105 +2381,19 @@ BOOLEAN PopDrawUndo( HDC hDc, P_DRAW_UNDO *DrawUndoList,
     }
 }
 
-
-//----------------------------------------------------------------------------
-//
-// DeleteOldestUndo
-//
-//----------------------------------------------------------------------------
-void DeleteOldestUndo( P_DRAW_UNDO *DrawUndoList )
-{
-    P_DRAW_UNDO	nextUndo, freeUndo = NULL, prevUndo = NULL;
-
-    nextUndo = *DrawUndoList;
-    freeUndo = nextUndo;
-    do {
-
-        prevUndo = freeUndo;
-        freeUndo = nextUndo;
-        nextUndo = nextUndo->Next;
-
-    } while( nextUndo );
-
-    if( freeUndo ) {
-
-        DeleteObject( freeUndo->hBitmap );
-        DeleteDC( freeUndo->hDc );
-        free( freeUndo );
-        if( prevUndo != *DrawUndoList ) prevUndo->Next = NULL;
-        else *DrawUndoList = NULL;
-    }
-}
-
-//----------------------------------------------------------------------------
-//
-// GetOldestUndo
-//
-//----------------------------------------------------------------------------
-P_DRAW_UNDO GetOldestUndo(P_DRAW_UNDO DrawUndoList)
-{
-    P_DRAW_UNDO	nextUndo, oldestUndo = NULL;
-
-    nextUndo = DrawUndoList;
-    oldestUndo = nextUndo;
-    do {
-
-        oldestUndo = nextUndo;
-        nextUndo = nextUndo->Next;
-
-    } while( nextUndo );
-    return oldestUndo;
-}
-
-
 //----------------------------------------------------------------------------
 //
 // PushDrawUndo
 //
 //----------------------------------------------------------------------------
-void PushDrawUndo( HDC hDc, P_DRAW_UNDO *DrawUndoList, int width, int height )
+void PushDrawUndo( HDC hDc, DrawUndoHistory *DrawUndoList, int width, int height )
 {
-    P_DRAW_UNDO	nextUndo, newUndo;
-    int			i = 0;
-    HBITMAP		hUndoBitmap;
-
     OutputDebug(L"PushDrawUndo\n");
 
-    // Don't store more than 8 undo's (XP gets really upset when we
-    // exhaust heap with them)
-    nextUndo = *DrawUndoList;
-    do {
-
-        i++;
-        if( i == MAX_UNDO_HISTORY ) {
-
-            DeleteOldestUndo( DrawUndoList );
-            break;
-        }
-        if( nextUndo ) nextUndo = nextUndo->Next;
-
-    } while( nextUndo );
-
-    hUndoBitmap = CreateCompatibleBitmap( hDc, width, height );
-    if( !hUndoBitmap && *DrawUndoList ) {
-
-        // delete the oldest and try again
-        DeleteOldestUndo( DrawUndoList );
-        hUndoBitmap = CreateCompatibleBitmap( hDc, width, height );
-    }
-    if( hUndoBitmap ) {
-
-        newUndo = static_cast<P_DRAW_UNDO>(malloc( sizeof( DRAW_UNDO )));
-        if (newUndo != NULL)
-        {
-            newUndo->hDc = CreateCompatibleDC(hDc);
-            newUndo->hBitmap = hUndoBitmap;
-            SelectObject(newUndo->hDc, newUndo->hBitmap);
-            BitBlt(newUndo->hDc, 0, 0, width, height, hDc, 0, 0, SRCCOPY | CAPTUREBLT);
-            newUndo->Next = *DrawUndoList;
-            *DrawUndoList = newUndo;
-        }
-    }
+    // The history keeps at most MAX_UNDO_HISTORY states and drops the
+    // oldest ones once their saved tiles exceed the memory budget
+    DrawUndoList->SetMemoryBudget( static_cast<size_t>(g_DrawUndoMemoryBudget) * 1024 * 1024 );
+    DrawUndoList->Push( hDc, width, height );
 }
 
 //----------------------------------------------------------------------------
@@ -3910,7 +3680,7 @@ LRESULT APIENTRY MainWndProc(
     static POINT	prevPt;
     static POINT	textStartPt;
     static POINT	textPt;
-    static P_DRAW_UNDO drawUndoList = NULL;
+    static DrawUndoHistory drawUndoList;
     static P_TYPED_KEY	typedKeyList = NULL;
     static BOOLEAN	g_HaveDrawn = FALSE;
     static DWORD	g_DrawingShape = 0;
@@ -5674,7 +5444,7 @@ LRESULT APIENTRY MainWndProc(
                             if (PEN_COLOR_HIGHLIGHT(g_PenColor))
                             {
                                 // copy original bitmap to screen bitmap to erase previous highlight
-                                BitBlt(hdcScreenCompat, 0, 0, bmp.bmWidth, bmp.bmHeight, drawUndoList->hDc, 0, 0, SRCCOPY | CAPTUREBLT);
+                                BitBlt(hdcScreenCompat, 0, 0, bmp.bmWidth, bmp.bmHeight, drawUndoList.TopDc(), 0, 0, SRCCOPY | CAPTUREBLT);
                             }
                             else
                             {
@@ -5763,18 +5533,12 @@ LRESULT APIENTRY MainWndProc(
                         Gdiplus::BitmapData* lineData = LockGdiPlusBitmap(lineBitmap);
                         BYTE* pPixels = static_cast<BYTE*>(lineData->Scan0);
 
-                        // Create a GDI bitmap that's the size of the lineBounds rectangle
-                        Gdiplus::Bitmap *blurBitmap = CreateGdiplusBitmap( hdcScreenCompat, // oldestUndo->hDc,
-                                            lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height);
-
                         // Blur it
-                        BitmapBlur(blurBitmap);
-                        BlurScreen(hdcScreenCompat, &lineBounds, blurBitmap, pPixels);
+                        BlurScreen(hdcScreenCompat, &lineBounds, pPixels);
 
                         // Unlock the bits
                         lineBitmap->UnlockBits(lineData);
                         delete lineBitmap;
-                        delete blurBitmap;
 
                         // Invalidate the updated rectangle
                         InvalidateGdiplusRect( hWnd, lineBounds );
@@ -5816,39 +5580,15 @@ LRESULT APIENTRY MainWndProc(
                         // Pointer to the DIB bits
                         BYTE* pDestPixels = static_cast<BYTE*>(pDIBBits);
 
-                        // Pointer to screen bits
-                        HDC hdcDIBOrig;
-                        HBITMAP hDibOrigBitmap, hDibBitmap;
-                        P_DRAW_UNDO oldestUndo = GetOldestUndo(drawUndoList);
-                        BYTE* pDestPixels2 = CreateBitmapMemoryDIB(hdcScreenCompat, oldestUndo->hDc, &lineBounds,
-                                                &hdcDIBOrig, &hDibBitmap, &hDibOrigBitmap);
-
-                        for (int local_y = 0; local_y < lineBounds.Height; ++local_y) {
-                            for (int local_x = 0; local_x < lineBounds.Width; ++local_x) {
-                                int index = (local_y * lineBounds.Width * 4) + (local_x * 4); // Assuming 4 bytes per pixel
-                                // BYTE b = pPixels[index + 0];  // Blue channel
-                                // BYTE g = pPixels[index + 1];  // Green channel
-                                // BYTE r = pPixels[index + 2];  // Red channel
-                                BYTE a = pPixels[index + 3];  // Alpha channel
-
-                                // Check if this is a drawn pixel
-                                if (a != 0) {
-                                    // Assuming pDestPixels is a valid pointer to the destination bitmap's pixel data
-                                    BYTE destB = pDestPixels2[index + 0];  // Blue channel
-                                    BYTE destG = pDestPixels2[index + 1];  // Green channel
-                                    BYTE destR = pDestPixels2[index + 2];  // Red channel
-
-                                    // Create a COLORREF value from the destination pixel data
-                                    COLORREF currentPixel = RGB(destR, destG, destB);
-                                    // Blend the colors
-                                    COLORREF newPixel = BlendColors(currentPixel, g_PenColor);
-                                    // Update the destination pixel data with the new color
-                                    pDestPixels[index + 0] = GetBValue(newPixel);
-                                    pDestPixels[index + 1] = GetGValue(newPixel);
-                                    pDestPixels[index + 2] = GetRValue(newPixel);
-                                }
-                            }
-                        }
+                        // The screen before any drawing, from the oldest undo state
+                        std::vector<DWORD> originalPixels(static_cast<size_t>(lineBounds.Width) * lineBounds.Height);
+                        RECT rcLine = { lineBounds.X, lineBounds.Y, lineBounds.GetRight(), lineBounds.GetBottom() };
+                        drawUndoList.ReadOldest(rcLine, originalPixels.data());
+
+                        // Highlight the drawn pixels, based on the screen before any drawing
+                        SelectMaskedPixels(reinterpret_cast<DWORD*>(pDestPixels), originalPixels.data(),
+                            reinterpret_cast<const DWORD*>(pPixels), static_cast<size_t>(lineBounds.Width) * lineBounds.Height,
+                            HighlighterColorMask(g_PenColor));
 
                         // Copy the updated DIB back to hdcScreenCompat
                         BitBlt(hdcScreenCompat, lineBounds.X, lineBounds.Y, lineBounds.Width, lineBounds.Height, hdcDIB, 0, 0, SRCCOPY);
@@ -5857,10 +5597,6 @@ LRESULT APIENTRY MainWndProc(
                         DeleteObject(hDIB);
                         DeleteDC(hdcDIB);
 
-                        SelectObject(hdcDIBOrig, hDibOrigBitmap);
-                        DeleteObject(hDibBitmap);
-                        DeleteDC(hdcDIBOrig);
-
                         // Invalidate the updated rectangle
                         InvalidateGdiplusRect(hWnd, lineBounds);
                     }
@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft Corporation
+// The Microsoft Corporation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+using System.Diagnostics;
+using System.Globalization;
+using Microsoft.CmdPal.Ext.Calc.Helper;
+using Microsoft.CmdPal.Ext.UnitTestBase;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+
+namespace Microsoft.CmdPal.Ext.Calc.UnitTests;
+
+[TestClass]
+public class CalculateEngineBenchmarkTests : CommandPaletteUnitTestBase
+{
+    public required TestContext TestContext { get; set; }
+
+    [TestMethod]
+    [TestCategory("Benchmark")]
+    public void Interpret_PerKeystrokeCost()
+    {
+        var settings = new Settings();
+        const string query = "sin(pi / 4) * 2 ^ 10 + 5 * (3 - 1.5)";
+
+        // The first pass compiles every prefix, typing the same query again reuses the compiled expressions
+        var firstPass = MeasurePerKeystroke(settings, query, out var firstResult);
+        var secondPass = MeasurePerKeystroke(settings, query, out var secondResult);
+
+        TestContext.WriteLine($"first pass: {firstPass:F1} us per keystroke");
+        TestContext.WriteLine($"second pass: {secondPass:F1} us per keystroke");
+
+        Assert.AreEqual(CalculateEngine.FormatMax15Digits(731.577343935025M, new CultureInfo("en-US")), firstResult.RoundedResult);
+        Assert.AreEqual(firstResult.RoundedResult, secondResult.RoundedResult);
+    }
+
+    // Average time to evaluate every prefix of the query, the way the calculator sees it while it's typed
+    private static double MeasurePerKeystroke(Settings settings, string query, out CalculateResult lastResult)
+    {
+        lastResult = default;
+        var stopwatch = Stopwatch.StartNew();
+        for (var length = 1; length <= query.Length; length++)
+        {
+            lastResult = CalculateEngine.Interpret(settings, query.Substring(0, length), CultureInfo.InvariantCulture, out _);
+        }
+
+        stopwatch.Stop();
+        return stopwatch.Elapsed.TotalMicroseconds / query.Length;
+    }
+}
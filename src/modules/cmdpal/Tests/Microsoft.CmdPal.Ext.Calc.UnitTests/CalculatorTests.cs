@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation
+// The Microsoft Corporation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using CalculatorEngineCommon;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using Windows.Foundation.Collections;
+
+namespace Microsoft.CmdPal.Ext.Calc.UnitTests;
+
+[TestClass]
+public class CalculatorTests
+{
+    public required TestContext TestContext { get; set; }
+
+    [DataTestMethod]
+    [DataRow("2 * 2", "4")]
+    [DataRow("0.1 + 0.2", "0.30000000000000004")]
+    [DataRow("1 / 8", "0.125")]
+    [DataRow("-3 / 2", "-1.5")]
+    [DataRow("10 ^ 21", "1000000000000000000000")]
+    [DataRow("2 +", "NaN")]
+    public void EvaluateExpression_ReturnsShortestFixedText(string input, string expectedResult)
+    {
+        // Arrange
+        var calculator = new Calculator();
+
+        // Act
+        var result = calculator.EvaluateExpression(input);
+
+        // Assert
+        Assert.AreEqual(expectedResult, result);
+    }
+
+    [TestMethod]
+    public void EvaluateExpression_ResultParsesBackToTheSameDouble()
+    {
+        // Arrange
+        // Quotients and products of integers below 2^53 are correctly rounded, so .NET computes the same double
+        var calculator = new Calculator();
+        var random = new Random(1234);
+
+        for (var i = 0; i < 2000; i++)
+        {
+            var a = random.NextInt64(1, 1L << 53);
+            var b = random.NextInt64(1, 1L << 53);
+
+            // Act
+            var quotient = calculator.EvaluateExpression($"{a} / {b}");
+            var product = calculator.EvaluateExpression($"{a} * {b}");
+
+            // Assert
+            Assert.AreEqual((double)a / b, double.Parse(quotient, CultureInfo.InvariantCulture), quotient);
+            Assert.AreEqual((double)a * b, double.Parse(product, CultureInfo.InvariantCulture), product);
+        }
+    }
+
+    [DataTestMethod]
+    [DataRow("2 * 2", "4e+00")]
+    [DataRow("123 / 1000000", "1.23e-04")]
+    [DataRow("-3 / 2", "-1.5e+00")]
+    [DataRow("10 ^ 21", "1e+21")]
+    [DataRow("2 +", "NaN")]
+    public void EvaluateExpression_Scientific_ReturnsShortestText(string input, string expectedResult)
+    {
+        // Arrange
+        var calculator = new Calculator();
+
+        // Act
+        var result = calculator.EvaluateExpression(input, ResultFormat.Scientific);
+
+        // Assert
+        Assert.AreEqual(expectedResult, result);
+    }
+
+    [DataTestMethod]
+    [DataRow("sqrt(-1)", "NaN")]
+    [DataRow("10 ^ 400", "Infinity")]
+    [DataRow("-(10 ^ 400)", "-Infinity")]
+    public void EvaluateExpression_NonFiniteResults_UseDotNetSymbols(string input, string expectedResult)
+    {
+        // Arrange
+        var calculator = new Calculator();
+
+        // Act & Assert
+        Assert.AreEqual(expectedResult, calculator.EvaluateExpression(input, ResultFormat.Fixed));
+        Assert.AreEqual(expectedResult, calculator.EvaluateExpression(input, ResultFormat.Scientific));
+        Assert.AreEqual(double.Parse(expectedResult, CultureInfo.InvariantCulture), double.Parse(calculator.EvaluateExpression(input), CultureInfo.InvariantCulture));
+    }
+
+    [TestMethod]
+    public void EvaluateExpression_FormattedValuesParseBackBitForBit()
+    {
+        // Arrange
+        // Values reach the engine as constants, so they aren't rounded by the expression parser
+        // and only the formatting is checked. Random bit patterns cover denormals, extreme
+        // exponents, both zeros, infinities and NaNs.
+        var random = new Random(1234);
+        var values = new List<double>
+        {
+            0.0,
+            -0.0,
+            double.Epsilon,
+            -double.Epsilon,
+            2.2250738585072009e-308, // Largest denormal
+            2.2250738585072014e-308, // Smallest normal
+            double.MaxValue,
+            double.MinValue,
+            0.1,
+            1e21,
+            1e-7,
+        };
+        var bits = new byte[sizeof(long)];
+        while (values.Count < 10000)
+        {
+            random.NextBytes(bits);
+            values.Add(BitConverter.ToDouble(bits));
+        }
+
+        const int valuesPerCalculator = 500;
+        for (var start = 0; start < values.Count; start += valuesPerCalculator)
+        {
+            var constants = new PropertySet();
+            var count = Math.Min(valuesPerCalculator, values.Count - start);
+            for (var i = 0; i < count; i++)
+            {
+                constants.Add($"v{i}", values[start + i]);
+            }
+
+            var calculator = new Calculator(constants);
+            for (var i = 0; i < count; i++)
+            {
+                var value = values[start + i];
+                foreach (var format in new[] { ResultFormat.Fixed, ResultFormat.Scientific })
+                {
+                    // Act
+                    var text = calculator.EvaluateExpression($"v{i}", format);
+
+                    // Assert
+                    if (double.IsNaN(value))
+                    {
+                        Assert.AreEqual("NaN", text);
+                        continue;
+                    }
+
+                    var parsed = double.Parse(text, NumberStyles.Float, CultureInfo.InvariantCulture);
+                    Assert.AreEqual(BitConverter.DoubleToInt64Bits(value), BitConverter.DoubleToInt64Bits(parsed), text);
+                    if (double.IsFinite(value))
+                    {
+                        Assert.AreEqual(format == ResultFormat.Scientific, text.Contains('e'), text);
+                    }
+                }
+            }
+        }
+    }
+
+    [TestMethod]
+    [TestCategory("Benchmark")]
+    public void EvaluateExpression_FormattingCost()
+    {
+        // Compiled expressions come from the cache, what's left is evaluating and formatting the result
+        var calculator = new Calculator();
+        var expressions = new string[32];
+        for (var i = 0; i < expressions.Length; i++)
+        {
+            expressions[i] = $"{i + 1} / 7 + {i}";
+            calculator.EvaluateExpression(expressions[i]);
+        }
+
+        const int calls = 100000;
+        var stopwatch = Stopwatch.StartNew();
+        for (var i = 0; i < calls; i++)
+        {
+            calculator.EvaluateExpression(expressions[i % expressions.Length]);
+        }
+
+        stopwatch.Stop();
+
+        TestContext.WriteLine($"{stopwatch.Elapsed.TotalMicroseconds / calls:F2} us per evaluation");
+        Assert.AreEqual("7", calculator.EvaluateExpression(expressions[6]));
+    }
+
+    [TestMethod]
+    public void EvaluateBatch_ReturnsResultForEachInput()
+    {
+        // Arrange
+        var calculator = new Calculator();
+        double[] inputs = [32, 212, -40, 98.6];
+
+        // Act
+        var results = calculator.EvaluateBatch("(f - 32) * 5 / 9", "f", inputs);
+
+        // Assert
+        Assert.AreEqual(inputs.Length, results.Length);
+        Assert.AreEqual(0, results[0]);
+        Assert.AreEqual(100, results[1]);
+        Assert.AreEqual(-40, results[2]);
+        Assert.AreEqual(37, results[3], 1e-12);
+    }
+
+    [DataTestMethod]
+    [DataRow("x +", "x")]
+    [DataRow("y * 2", "x")]
+    [DataRow("x * 2", "1x")]
+    [DataRow("x * 2", "pi")]
+    public void EvaluateBatch_ReturnsNaN_WhenExpressionDoesNotCompile(string expression, string variable)
+    {
+        // Arrange
+        var calculator = new Calculator(new PropertySet { { "pi", Math.PI } });
+
+        // Act
+        var results = calculator.EvaluateBatch(expression, variable, [1, 2, 3]);
+
+        // Assert
+        Assert.AreEqual(3, results.Length);
+        foreach (var result in results)
+        {
+            Assert.IsTrue(double.IsNaN(result));
+        }
+    }
+
+    [TestMethod]
+    [TestCategory("Benchmark")]
+    public void EvaluateBatch_Throughput()
+    {
+        var calculator = new Calculator();
+        var inputs = new double[1_000_000];
+        for (var i = 0; i < inputs.Length; i++)
+        {
+            inputs[i] = i * 0.5;
+        }
+
+        var stopwatch = Stopwatch.StartNew();
+        var results = calculator.EvaluateBatch("x * 2.54", "x", inputs);
+        stopwatch.Stop();
+        var batchTime = stopwatch.Elapsed.TotalNanoseconds / inputs.Length;
+
+        // The same conversion one expression at a time, every item compiled and formatted separately
+        const int singleCount = 10_000;
+        stopwatch.Restart();
+        for (var i = 0; i < singleCount; i++)
+        {
+            _ = double.Parse(calculator.EvaluateExpression($"{inputs[i].ToString(CultureInfo.InvariantCulture)} * 2.54"), CultureInfo.InvariantCulture);
+        }
+
+        stopwatch.Stop();
+        var singleTime = stopwatch.Elapsed.TotalNanoseconds / singleCount;
+
+        TestContext.WriteLine($"batch: {batchTime:F1} ns per input");
+        TestContext.WriteLine($"one expression per input: {singleTime:F1} ns per input");
+
+        Assert.AreEqual(inputs.Length, results.Length);
+        Assert.AreEqual(inputs[^1] * 2.54, results[^1], 1e-9);
+    }
+}
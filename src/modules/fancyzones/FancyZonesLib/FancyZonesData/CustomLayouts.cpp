@@ -6,6 +6,7 @@
 #include <FancyZonesLib/FancyZonesData/LayoutDefaults.h>
 #include <FancyZonesLib/FancyZonesWinHookEventIDs.h>
 #include <FancyZonesLib/JsonHelpers.h>
+#include <FancyZonesLib/LayoutGeometryCache.h>
 #include <FancyZonesLib/util.h>
 
 namespace JsonUtils
@@ -214,6 +215,8 @@ void CustomLayouts::LoadData()
     {
         Logger::error(L"Parsing custom-layouts error: {}", e.message());
     }
+
+    LayoutGeometryCache::instance().InvalidateCustomLayouts();
 }
 
 std::optional<LayoutData> CustomLayouts::GetLayout(const GUID& id) const noexcept
@@ -4,9 +4,11 @@
 #include <FancyZonesLib/FancyZonesData/CustomLayouts.h>
 #include <FancyZonesLib/FancyZonesWindowProperties.h>
 #include <FancyZonesLib/LayoutConfigurator.h>
+#include <FancyZonesLib/LayoutGeometryCache.h>
 #include <FancyZonesLib/Settings.h>
 #include <FancyZonesLib/WindowUtils.h>
 
+#include <common/Display/dpi_aware.h>
 #include <common/logger/logger.h>
 
 namespace ZoneSelectionAlgorithms
@@ -129,6 +131,31 @@ bool Layout::Init(const FancyZonesUtils::Rect& workArea, HMONITOR monitor) noexc
 
     auto spacing = m_data.showSpacing ? m_data.spacing : 0; 
 
+    // Same monitor DPIAware::Convert scales custom layouts with, the primary one for span zones
+    HMONITOR dpiMonitor = monitor;
+    if (dpiMonitor == nullptr)
+    {
+        dpiMonitor = MonitorFromPoint(POINT{ 0, 0 }, MONITOR_DEFAULTTOPRIMARY);
+    }
+
+    UINT dpi = DPIAware::DEFAULT_DPI;
+    DPIAware::GetScreenDPIForMonitor(dpiMonitor, dpi);
+
+    const LayoutGeometryCache::Key cacheKey{
+        .uuid = m_data.uuid,
+        .type = m_data.type,
+        .zoneCount = m_data.zoneCount,
+        .spacing = spacing,
+        .workArea = RECT{ workArea.left(), workArea.top(), workArea.right(), workArea.bottom() },
+        .dpi = dpi
+    };
+
+    if (auto cachedZones = LayoutGeometryCache::instance().Get(cacheKey); cachedZones.has_value())
+    {
+        m_zones = std::move(cachedZones.value());
+        return m_zones.size() == m_data.zoneCount;
+    }
+
     switch (m_data.type)
     {
     case FancyZonesDataTypes::ZoneSetLayoutType::Blank:
@@ -165,7 +192,13 @@ bool Layout::Init(const FancyZonesUtils::Rect& workArea, HMONITOR monitor) noexc
     break;
     }
 
-    return m_zones.size() == m_data.zoneCount;
+    if (m_zones.size() != m_data.zoneCount)
+    {
+        return false;
+    }
+
+    LayoutGeometryCache::instance().Set(cacheKey, m_zones);
+    return true;
 }
 
 GUID Layout::Id() const noexcept
@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "LayoutGeometryCache.h"
+
+#include <FancyZonesLib/GuidUtils.h>
+
+namespace
+{
+    // Number of (layout, work area, dpi) combinations kept before the cache is reset.
+    // Plenty for docking/undocking between a handful of monitor setups.
+    constexpr size_t MaxCachedLayouts = 64;
+}
+
+LayoutGeometryCache& LayoutGeometryCache::instance()
+{
+    static LayoutGeometryCache self;
+    return self;
+}
+
+bool LayoutGeometryCache::KeyLess::operator()(const Key& lhs, const Key& rhs) const noexcept
+{
+    if (lhs.uuid != rhs.uuid)
+    {
+        return lhs.uuid < rhs.uuid;
+    }
+
+    return std::tie(lhs.type, lhs.zoneCount, lhs.spacing, lhs.dpi, lhs.workArea.left, lhs.workArea.top, lhs.workArea.right, lhs.workArea.bottom) <
+           std::tie(rhs.type, rhs.zoneCount, rhs.spacing, rhs.dpi, rhs.workArea.left, rhs.workArea.top, rhs.workArea.right, rhs.workArea.bottom);
+}
+
+std::optional<ZonesMap> LayoutGeometryCache::Get(const Key& key) const
+{
+    std::scoped_lock lock{ m_mutex };
+
+    auto iter = m_cache.find(key);
+    if (iter == m_cache.end())
+    {
+        return std::nullopt;
+    }
+
+    return iter->second;
+}
+
+void LayoutGeometryCache::Set(const Key& key, const ZonesMap& zones)
+{
+    std::scoped_lock lock{ m_mutex };
+
+    if (m_cache.size() >= MaxCachedLayouts && !m_cache.contains(key))
+    {
+        m_cache.clear();
+    }
+
+    m_cache[key] = zones;
+}
+
+void LayoutGeometryCache::InvalidateCustomLayouts()
+{
+    std::scoped_lock lock{ m_mutex };
+
+    std::erase_if(m_cache, [](const auto& entry) {
+        return entry.first.type == FancyZonesDataTypes::ZoneSetLayoutType::Custom;
+    });
+}
+
+void LayoutGeometryCache::Clear()
+{
+    std::scoped_lock lock{ m_mutex };
+    m_cache.clear();
+}
+
+size_t LayoutGeometryCache::Size() const noexcept
+{
+    std::scoped_lock lock{ m_mutex };
+    return m_cache.size();
+}
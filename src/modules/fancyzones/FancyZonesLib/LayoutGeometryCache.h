@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include <FancyZonesLib/FancyZonesData/LayoutData.h>
+#include <FancyZonesLib/LayoutConfigurator.h> // ZonesMap
+#include <FancyZonesLib/util.h>
+
+// Keeps zone geometry computed by LayoutConfigurator, so work areas re-created on
+// display, virtual desktop or DPI changes don't recalculate layouts they've already seen.
+class LayoutGeometryCache
+{
+public:
+    struct Key
+    {
+        GUID uuid = GUID_NULL;
+        FancyZonesDataTypes::ZoneSetLayoutType type = FancyZonesDataTypes::ZoneSetLayoutType::Blank;
+        int zoneCount = 0;
+        int spacing = 0;
+        RECT workArea{};
+        UINT dpi = 0;
+    };
+
+    static LayoutGeometryCache& instance();
+
+    std::optional<ZonesMap> Get(const Key& key) const;
+    void Set(const Key& key, const ZonesMap& zones);
+
+    // Drops the geometry of all custom layouts, should be called when custom layouts are edited.
+    void InvalidateCustomLayouts();
+    void Clear();
+
+    size_t Size() const noexcept;
+
+private:
+    struct KeyLess
+    {
+        bool operator()(const Key& lhs, const Key& rhs) const noexcept;
+    };
+
+    LayoutGeometryCache() = default;
+    ~LayoutGeometryCache() = default;
+
+    mutable std::mutex m_mutex;
+    std::map<Key, ZonesMap, KeyLess> m_cache;
+};
@@ -6,6 +6,7 @@
 #include <FancyZonesLib/FancyZonesData/CustomLayouts.h>
 #include <FancyZonesLib/ZoneIndexSetBitmask.h>
 #include <FancyZonesLib/Layout.h>
+#include <FancyZonesLib/LayoutGeometryCache.h>
 #include <FancyZonesLib/Settings.h>
 
 #include "Util.h"
@@ -183,6 +184,47 @@ namespace FancyZonesUnitTests
             Zone zone3({ 0, 100, 100, 200 }, 2);
             compareZones(zone3, layout->Zones().at(actual[1]));
         }
+
+        TEST_METHOD (CachedGeometryMatchesCalculated)
+        {
+            LayoutGeometryCache::instance().Clear();
+
+            auto first = std::make_unique<Layout>(m_data);
+            Assert::IsTrue(first->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()));
+            Assert::AreEqual(static_cast<size_t>(1), LayoutGeometryCache::instance().Size());
+
+            auto second = std::make_unique<Layout>(m_data);
+            Assert::IsTrue(second->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()));
+            Assert::AreEqual(static_cast<size_t>(1), LayoutGeometryCache::instance().Size());
+
+            Assert::AreEqual(first->Zones().size(), second->Zones().size());
+            for (const auto& [id, zone] : first->Zones())
+            {
+                compareZones(zone, second->Zones().at(id));
+            }
+
+            // different work area is a different entry
+            auto third = std::make_unique<Layout>(m_data);
+            Assert::IsTrue(third->Init(RECT{ 0, 0, 1280, 720 }, Mocks::Monitor()));
+            Assert::AreEqual(static_cast<size_t>(2), LayoutGeometryCache::instance().Size());
+        }
+
+        TEST_METHOD (CustomLayoutEditInvalidatesCachedGeometry)
+        {
+            LayoutData data = m_data;
+            data.type = FancyZonesDataTypes::ZoneSetLayoutType::Custom;
+            data.zoneCount = 1;
+
+            saveCustomLayout({ RECT{ 0, 0, 100, 100 } });
+            auto layout = std::make_unique<Layout>(data);
+            Assert::IsTrue(layout->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()));
+            compareZones(Zone({ 0, 0, 100, 100 }, 0), layout->Zones().at(0));
+
+            saveCustomLayout({ RECT{ 0, 0, 200, 200 } });
+            auto edited = std::make_unique<Layout>(data);
+            Assert::IsTrue(edited->Init(RECT{ 0, 0, 1920, 1080 }, Mocks::Monitor()));
+            compareZones(Zone({ 0, 0, 200, 200 }, 0), edited->Zones().at(0));
+        }
     };
 
     TEST_CLASS (LayoutInitUnitTests)
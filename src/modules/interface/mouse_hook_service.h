@@ -0,0 +1,43 @@
+#pragma once
+
+#include <common/hooks/LowlevelMouseEvent.h>
+#include <common/hooks/MouseEventRing.h>
+
+/*
+  One low level mouse hook, installed by the runner, shared by the mouse utilities.
+
+  A subscriber can have:
+    - a filter, called on the hook thread for every event. It returns true to swallow
+      the event, and has to return quickly, or Windows might remove the hook.
+    - a notification window. Events that weren't swallowed are queued in the
+      subscription's ring, and notifyMessage is posted to the window when the ring has
+      to be drained. Drain the ring on the window's thread.
+
+  The hook is only installed while there are subscribers.
+ */
+struct MouseHookSubscriberInfo
+{
+    // Used in logs.
+    const wchar_t* name = nullptr;
+
+    bool (*filter)(const LowlevelMouseEvent& event, void* context) = nullptr;
+    void* filterContext = nullptr;
+
+    HWND notifyWindow = nullptr;
+    UINT notifyMessage = 0;
+};
+
+class MouseHookService
+{
+public:
+    /* Returns the ring the subscriber drains its events from, which stays valid until
+     * Unsubscribe. Returns nullptr if the hook couldn't be installed.
+     */
+    virtual MouseEventRing* Subscribe(const MouseHookSubscriberInfo& info) = 0;
+
+    /* After Unsubscribe returns, the filter isn't called anymore and the ring is gone. */
+    virtual void Unsubscribe(MouseEventRing* subscription) = 0;
+
+protected:
+    ~MouseHookService() = default;
+};
@@ -3,6 +3,8 @@
 #include <compare>
 #include <common/utils/gpo.h>
 
+#include "mouse_hook_service.h"
+
 /*
   DLL Interface for PowerToys. The powertoy_create() (see below) must return
   an object that implements this interface.
@@ -15,6 +17,7 @@
 
   On the received object, the runner will call:
     - get_key() to get the non localized ID of the PowerToy,
+    - set_mouse_hook_service() to pass the shared low level mouse hook,
     - enable() to initialize the PowerToy.
     - get_hotkeys() to register the hotkeys that the PowerToy uses.
 
@@ -25,7 +28,11 @@
     - set_config() to set various settings,
     - call_custom_action() when the user selects clicks a custom action in settings,
     - get_hotkeys() when the settings change, to make sure the hotkey(s) are up to date.
-    - on_hotkey() when the corresponding hotkey is pressed.
+    - should_swallow_hotkey() from the keyboard hook and then on_hotkey() once the
+      hook has returned, when the corresponding hotkey is pressed.
+
+  All of these calls are made on the runner's main thread, one at a time, so module
+  state shared between them doesn't need a lock.
 
   When terminating, the runner will:
     - call destroy() which should free all the memory and delete the PowerToy object,
@@ -127,14 +134,28 @@ public:
     {
     }
 
-    /* Called when one of the registered hotkeys is pressed. Should return true
-     * if the key press is to be swallowed.
+    /* Called when one of the registered hotkeys is pressed. Runs on the runner's
+     * main thread after the keyboard hook has returned, so the key press has already
+     * been swallowed or passed on according to should_swallow_hotkey. Should return
+     * true if the key press is handled, the same decision should_swallow_hotkey made.
      */
     virtual bool on_hotkey(size_t /*hotkeyId*/)
     {
         return false;
     }
 
+    /* Called from the low level keyboard hook when one of the registered hotkeys
+     * is pressed, before on_hotkey is dispatched. Should return true if the key
+     * press is to be swallowed, which has to match what on_hotkey returns: override
+     * both to handle a hotkey. By default the key press is passed on, like the
+     * default on_hotkey does.
+     * Must return quickly, or Windows might remove the hook.
+     */
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/)
+    {
+        return false;
+    }
+
     /* These are for enabling the legacy behavior of showing the shortcut guide after pressing the win key.
      * keep_track_of_pressed_win_key returns true if the module wants to keep track of the win key being pressed.
      * milliseconds_win_key_must_be_pressed returns the number of milliseconds the win key should be pressed before triggering the module.
@@ -149,6 +170,12 @@ public:
 
     virtual bool is_enabled_by_default() const { return true; }
 
+    /* Called before enable() with the runner's shared low level mouse hook, which
+     * outlives the PowerToy. Modules that watch the mouse should subscribe to it
+     * instead of installing their own WH_MOUSE_LL hook.
+     */
+    virtual void set_mouse_hook_service(MouseHookService* /*service*/) {}
+
     /* Provides the GPO configuration value for the module. This should be overridden by the module interface to get the proper gpo policy setting. */
     virtual powertoys_gpo::gpo_rule_configured_t gpo_policy_enabled_configuration()
     {
@@ -20,7 +20,8 @@ int WINAPI wWinMain(_In_ HINSTANCE /*hInstance*/,
                     _In_ int /*nCmdShow*/)
 {
     winrt::init_apartment();
-    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName);
+    // The engine logs from its keyboard hook, keep the disk writes off the hook thread
+    LoggerHelpers::init_logger(KeyboardManagerConstants::ModuleName, L"Engine", LogSettings::keyboardManagerLoggerName, LoggerMode::Asynchronous);
 
     Shared::Trace::ETWTrace trace;
     trace.UpdateState(true);
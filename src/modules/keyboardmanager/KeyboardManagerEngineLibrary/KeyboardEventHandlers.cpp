@@ -335,7 +335,7 @@ namespace KeyboardEventHandlers
                         {
                             if (data->lParam->vkCode == itShortcut.GetSecondKey())
                             {
-                                Logger::trace(L"ChordKeyboardHandler:found chord match {}, {}", itShortcut.GetActionKey(), itShortcut.GetSecondKey());
+                                LOG_TRACE(L"ChordKeyboardHandler:found chord match {}, {}", itShortcut.GetActionKey(), itShortcut.GetSecondKey());
                                 isMatchOnChordEnd = true;
                             }
                             // Resets chord status for the shortcut. A key was pressed and we registered if it was the end of the chord. We can reset it.
@@ -414,7 +414,7 @@ namespace KeyboardEventHandlers
                             myThread.detach();
                         }
 
-                        Logger::trace(L"ChordKeyboardHandler:returning..");
+                        LOG_TRACE(L"ChordKeyboardHandler:returning..");
                         return 1;
                     }
                     else if (isOpenUri)
@@ -432,7 +432,7 @@ namespace KeyboardEventHandlers
                             if (UrlCreateFromPathW(uri.c_str(), url, &bufferSize, 0) == S_OK)
                             {
                                 newUri = url;
-                                Logger::trace(L"ChordKeyboardHandler:ConvertPathToURI from {} to {}", uri, url);
+                                LOG_TRACE(L"ChordKeyboardHandler:ConvertPathToURI from {} to {}", uri, url);
                             }
                             else
                             {
@@ -460,7 +460,7 @@ namespace KeyboardEventHandlers
                             myThread.detach();
                         }
 
-                        Logger::trace(L"ChordKeyboardHandler:returning..");
+                        LOG_TRACE(L"ChordKeyboardHandler:returning..");
                         return 1;
                     }
                     else if (remapToShortcut)
@@ -548,7 +548,7 @@ namespace KeyboardEventHandlers
                         state.SetActivatedApp(*activatedApp);
                     }
 
-                    Logger::trace(L"ChordKeyboardHandler:keyEventList.size:{}", keyEventList.size());
+                    LOG_TRACE(L"ChordKeyboardHandler:keyEventList.size:{}", keyEventList.size());
 
                     ii.SendVirtualInput(keyEventList);
                     if (activatedApp.has_value())
@@ -1268,7 +1268,7 @@ namespace KeyboardEventHandlers
             textElement1.InnerText(message1);
             textElement2.InnerText(message2);
 
-            Logger::trace(L"ChordKeyboardHandler:toastXml {}", toastXml.GetXml());
+            LOG_TRACE(L"ChordKeyboardHandler:toastXml {}", toastXml.GetXml());
             std::wstring APPLICATION_ID = L"Microsoft.PowerToysWin32";
             const auto notifier = ToastNotificationManager::ToastNotificationManager::CreateToastNotifier(APPLICATION_ID);
 
@@ -316,6 +316,12 @@ public:
     }
 
     // Process the hotkey event
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        // Without the centralized keyboard hook, PowerToys Run listens for its own global hotkey
+        return m_enabled && m_use_centralized_keyboard_hook;
+    }
+
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
         // For now, hotkeyId will always be zero
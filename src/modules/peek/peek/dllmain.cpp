@@ -621,20 +621,33 @@ public:
         }
     }
 
+    bool is_space_mode() const
+    {
+        return m_enableSpaceToActivate && !(m_hotkey.win || m_hotkey.alt || m_hotkey.shift || m_hotkey.ctrl) && m_hotkey.key == ' ';
+    }
+
+    bool is_hotkey_eligible(bool spaceMode)
+    {
+        if (spaceMode && g_foregroundHookActive.load(std::memory_order_relaxed))
+        {
+            return g_foregroundEligible.load(std::memory_order_relaxed);
+        }
+
+        return is_peek_or_explorer_or_desktop_window_focused();
+    }
+
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        // Space is always passed on, so that it keeps working in the focused window
+        return m_enabled && !is_space_mode() && is_hotkey_eligible(false);
+    }
+
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
         if (m_enabled)
         {
-            bool spaceMode = m_enableSpaceToActivate && !(m_hotkey.win || m_hotkey.alt || m_hotkey.shift || m_hotkey.ctrl) && m_hotkey.key == ' ';
-            bool eligible = false;
-            if (spaceMode && g_foregroundHookActive.load(std::memory_order_relaxed))
-            {
-                eligible = g_foregroundEligible.load(std::memory_order_relaxed);
-            }
-            else
-            {
-                eligible = is_peek_or_explorer_or_desktop_window_focused();
-            }
+            bool spaceMode = is_space_mode();
+            bool eligible = is_hotkey_eligible(spaceMode);
 
             if (eligible)
             {
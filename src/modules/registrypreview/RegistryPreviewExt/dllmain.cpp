@@ -294,6 +294,11 @@ public:
         return m_enabled;
     }
 
+    virtual bool should_swallow_hotkey(size_t /*hotkeyId*/) override
+    {
+        return m_enabled;
+    }
+
     // Respond to a "click" from the launcher
     virtual bool on_hotkey(size_t /*hotkeyId*/) override
     {
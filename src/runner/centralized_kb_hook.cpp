@@ -1,17 +1,29 @@
 #include "pch.h"
 #include "centralized_kb_hook.h"
+#include "tray_icon.h"
 #include <common/debug_control.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger.h>
 #include <common/interop/shared_constants.h>
 
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+
 namespace CentralizedKeyboardHook
 {
-    struct HotkeyDescriptor
+    struct HotkeyAction
     {
-        Hotkey hotkey;
         std::wstring moduleName;
+        std::function<bool()> shouldSwallow;
         std::function<bool()> action;
+    };
+
+    struct HotkeyDescriptor
+    {
+        Hotkey hotkey;
+        std::shared_ptr<const HotkeyAction> action;
 
         bool operator<(const HotkeyDescriptor& other) const
         {
@@ -23,6 +35,92 @@ namespace CentralizedKeyboardHook
     std::mutex mutex;
     HHOOK hHook{};
 
+    // The registered hotkeys indexed by modifiers and virtual key, so the hook finds
+    // a hotkey without searching. It's rebuilt from hotkeyDescriptors on every change.
+    constexpr size_t KEY_COUNT = 256;
+    struct HotkeyTable
+    {
+        std::array<std::shared_ptr<const HotkeyAction>, 16 * KEY_COUNT> actions;
+
+        // Lets the hook skip reading the modifier state for keys without hotkeys.
+        std::array<bool, KEY_COUNT> hasHotkey{};
+    };
+    std::unique_ptr<HotkeyTable> hotkeyTable = std::make_unique<HotkeyTable>();
+    std::shared_mutex hotkeyTableMutex;
+
+    size_t HotkeyTableIndex(bool win, bool ctrl, bool shift, bool alt, unsigned char key)
+    {
+        const size_t modifiers = (win ? 8 : 0) | (ctrl ? 4 : 0) | (shift ? 2 : 0) | (alt ? 1 : 0);
+        return modifiers * KEY_COUNT + key;
+    }
+
+    // Called with mutex held.
+    void RebuildHotkeyTable()
+    {
+        auto table = std::make_unique<HotkeyTable>();
+        for (const auto& descriptor : hotkeyDescriptors)
+        {
+            const auto& hotkey = descriptor.hotkey;
+            auto& slot = table->actions[HotkeyTableIndex(hotkey.win, hotkey.ctrl, hotkey.shift, hotkey.alt, hotkey.key)];
+            if (!slot)
+            {
+                // The first registration of a hotkey wins.
+                slot = descriptor.action;
+            }
+            table->hasHotkey[hotkey.key] = true;
+        }
+
+        std::unique_lock lock{ hotkeyTableMutex };
+        hotkeyTable.swap(table);
+    }
+
+    // Hotkey actions run on the main thread after the hook has returned, so a slow
+    // action can't make Windows time out the hook and remove it. The main thread is
+    // also where modules get their settings, enabled state and custom actions.
+    struct PendingHotkey
+    {
+        std::shared_ptr<const HotkeyAction> action;
+        bool swallowed;
+        std::chrono::steady_clock::time_point pressedAt;
+        std::chrono::steady_clock::duration hookTime;
+    };
+
+    struct
+    {
+        std::atomic<uint64_t> keyEvents;
+        std::atomic<uint64_t> hotkeysMatched;
+        std::atomic<uint64_t> hotkeysSwallowed;
+        std::atomic<std::chrono::steady_clock::rep> totalHookTime;
+        std::atomic<std::chrono::steady_clock::rep> maxHookTime;
+        std::atomic<std::chrono::steady_clock::rep> maxDispatchDelay;
+    } statistics;
+
+    void UpdateMax(std::atomic<std::chrono::steady_clock::rep>& max, std::chrono::steady_clock::rep value)
+    {
+        auto current = max.load(std::memory_order_relaxed);
+        while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void RunPendingHotkey(PVOID data)
+    {
+        std::unique_ptr<PendingHotkey> pending{ static_cast<PendingHotkey*>(data) };
+        const auto dispatchDelay = std::chrono::steady_clock::now() - pending->pressedAt;
+        UpdateMax(statistics.maxDispatchDelay, dispatchDelay.count());
+        Logger::trace(L"{} hotkey is invoked from Centralized keyboard hook. Hook time {} us, dispatched after {} us",
+                      pending->action->moduleName,
+                      std::chrono::duration_cast<std::chrono::microseconds>(pending->hookTime).count(),
+                      std::chrono::duration_cast<std::chrono::microseconds>(dispatchDelay).count());
+
+        // The key press was swallowed or passed on before the action ran
+        const bool handled = pending->action->action();
+        if (handled != pending->swallowed)
+        {
+            Logger::warn(L"{} hotkey was {} but the module {} it", pending->action->moduleName, pending->swallowed ? L"swallowed" : L"passed on", handled ? L"handled" : L"didn't handle");
+        }
+    }
+
     // To store information about handling pressed keys.
     struct PressedKeyDescriptor
     {
@@ -79,6 +177,59 @@ namespace CentralizedKeyboardHook
         KillTimer(hwnd, idTimer);
     }
 
+    // Looks the key press up in the hotkey table and queues the matching action.
+    // Returns true if the key press is to be swallowed.
+    bool HandleHotkey(const KBDLLHOOKSTRUCT& keyPressInfo, std::chrono::steady_clock::time_point pressedAt)
+    {
+        const auto key = static_cast<unsigned char>(keyPressInfo.vkCode);
+        std::shared_ptr<const HotkeyAction> action;
+        {
+            std::shared_lock lock{ hotkeyTableMutex };
+            if (!hotkeyTable->hasHotkey[key])
+            {
+                return false;
+            }
+
+            const bool win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000);
+            const bool ctrl = GetAsyncKeyState(VK_CONTROL) & 0x8000;
+            const bool shift = GetAsyncKeyState(VK_SHIFT) & 0x8000;
+            const bool alt = GetAsyncKeyState(VK_MENU) & 0x8000;
+            action = hotkeyTable->actions[HotkeyTableIndex(win, ctrl, shift, alt, key)];
+        }
+
+        if (!action)
+        {
+            return false;
+        }
+
+        statistics.hotkeysMatched.fetch_add(1, std::memory_order_relaxed);
+        const bool swallow = action->shouldSwallow && action->shouldSwallow();
+
+        auto pending = std::make_unique<PendingHotkey>(PendingHotkey{ action, swallow, pressedAt, std::chrono::steady_clock::now() - pressedAt });
+        if (dispatch_run_on_main_ui_thread(RunPendingHotkey, pending.get()))
+        {
+            pending.release();
+        }
+        else
+        {
+            Logger::error(L"Failed to queue the {} hotkey, there's no runner window", action->moduleName);
+        }
+
+        if (swallow)
+        {
+            // Send a dummy key to prevent Start Menu from activating
+            INPUT dummyEvent[1] = {};
+            dummyEvent[0].type = INPUT_KEYBOARD;
+            dummyEvent[0].ki.wVk = 0xFF;
+            dummyEvent[0].ki.dwFlags = KEYEVENTF_KEYUP;
+            SendInput(1, dummyEvent, sizeof(INPUT));
+
+            statistics.hotkeysSwallowed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return swallow;
+    }
+
     LRESULT CALLBACK KeyboardHookProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
     {
         if (nCode < 0)
@@ -86,6 +237,7 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
+        const auto hookStart = std::chrono::steady_clock::now();
         const auto& keyPressInfo = *reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
 
         if (keyPressInfo.dwExtraInfo == PowertoyModuleIface::CENTRALIZED_KEYBOARD_HOOK_DONT_TRIGGER_FLAG)
@@ -94,6 +246,8 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
+        statistics.keyEvents.fetch_add(1, std::memory_order_relaxed);
+
         // Check if the keys are pressed.
         if (!pressedKeyDescriptors.empty())
         {
@@ -138,60 +292,32 @@ namespace CentralizedKeyboardHook
             }
         }
 
-        if ((wParam != WM_KEYDOWN) && (wParam != WM_SYSKEYDOWN))
+        bool swallow = false;
+        if ((wParam == WM_KEYDOWN) || (wParam == WM_SYSKEYDOWN))
         {
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
+            swallow = HandleHotkey(keyPressInfo, hookStart);
         }
 
-        Hotkey hotkey{
-            .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
-            .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
-            .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
-            .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
-        };
-
-        if (hotkey == Hotkey{})
-        {
-            return CallNextHookEx(hHook, nCode, wParam, lParam);
-        }
-
-        std::function<bool()> action;
-        {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
-            {
-                action = it->action;
-            }
-        }
+        const auto hookTime = (std::chrono::steady_clock::now() - hookStart).count();
+        statistics.totalHookTime.fetch_add(hookTime, std::memory_order_relaxed);
+        UpdateMax(statistics.maxHookTime, hookTime);
 
-        if (action)
+        if (swallow)
         {
-            if (action())
-            {
-                // After invoking the hotkey send a dummy key to prevent Start Menu from activating
-                INPUT dummyEvent[1] = {};
-                dummyEvent[0].type = INPUT_KEYBOARD;
-                dummyEvent[0].ki.wVk = 0xFF;
-                dummyEvent[0].ki.dwFlags = KEYEVENTF_KEYUP;
-                SendInput(1, dummyEvent, sizeof(INPUT));
-
-                // Swallow the key press
-                return 1;
-            }
+            // Swallow the key press
+            return 1;
         }
 
         return CallNextHookEx(hHook, nCode, wParam, lParam);
     }
 
-    void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& action) noexcept
+    void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& shouldSwallow, std::function<bool()>&& action) noexcept
     {
         Logger::trace(L"Register hotkey action for {}", moduleName);
+        auto hotkeyAction = std::make_shared<const HotkeyAction>(HotkeyAction{ moduleName, std::move(shouldSwallow), std::move(action) });
         std::unique_lock lock{ mutex };
-        hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        hotkeyDescriptors.insert({ .hotkey = hotkey, .action = std::move(hotkeyAction) });
+        RebuildHotkeyTable();
     }
 
     void AddPressedKeyAction(const std::wstring& moduleName, const DWORD vk, const UINT milliseconds, std::function<bool()>&& action) noexcept
@@ -213,7 +339,7 @@ namespace CentralizedKeyboardHook
             auto it = hotkeyDescriptors.begin();
             while (it != hotkeyDescriptors.end())
             {
-                if (it->moduleName == moduleName)
+                if (it->action->moduleName == moduleName)
                 {
                     it = hotkeyDescriptors.erase(it);
                 }
@@ -222,6 +348,7 @@ namespace CentralizedKeyboardHook
                     ++it;
                 }
             }
+            RebuildHotkeyTable();
         }
         {
             std::unique_lock lock{ pressedKeyMutex };
@@ -273,4 +400,19 @@ namespace CentralizedKeyboardHook
     {
         runnerWindow = hwnd;
     }
+
+    HookStatistics GetStatistics() noexcept
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+        return {
+            .keyEvents = statistics.keyEvents.load(),
+            .hotkeysMatched = statistics.hotkeysMatched.load(),
+            .hotkeysSwallowed = statistics.hotkeysSwallowed.load(),
+            .totalHookTime = duration_cast<microseconds>(steady_clock::duration{ statistics.totalHookTime.load() }),
+            .maxHookTime = duration_cast<microseconds>(steady_clock::duration{ statistics.maxHookTime.load() }),
+            .maxDispatchDelay = duration_cast<microseconds>(steady_clock::duration{ statistics.maxDispatchDelay.load() }),
+        };
+    }
 }
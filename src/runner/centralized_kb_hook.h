@@ -6,10 +6,25 @@ namespace CentralizedKeyboardHook
 {
     using Hotkey = PowertoyModuleIface::Hotkey;
 
+    struct HookStatistics
+    {
+        uint64_t keyEvents = 0;
+        uint64_t hotkeysMatched = 0;
+        uint64_t hotkeysSwallowed = 0;
+        std::chrono::microseconds totalHookTime{};
+        std::chrono::microseconds maxHookTime{};
+        std::chrono::microseconds maxDispatchDelay{};
+    };
+
     void Start() noexcept;
     void Stop() noexcept;
-    void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& action) noexcept;
+
+    // shouldSwallow is called inside the keyboard hook and has to return quickly.
+    // action runs afterwards on the main thread and returns whether it handled the
+    // key press, a mismatch with shouldSwallow is logged.
+    void SetHotkeyAction(const std::wstring& moduleName, const Hotkey& hotkey, std::function<bool()>&& shouldSwallow, std::function<bool()>&& action) noexcept;
     void AddPressedKeyAction(const std::wstring& moduleName, const DWORD vk, const UINT milliseconds, std::function<bool()>&& action) noexcept;
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept;
     void RegisterWindow(HWND hwnd) noexcept;
+    HookStatistics GetStatistics() noexcept;
 };
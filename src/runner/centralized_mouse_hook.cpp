@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "centralized_mouse_hook.h"
+#include <common/debug_control.h>
+#include <common/logger/logger.h>
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+namespace CentralizedMouseHook
+{
+    struct Subscriber
+    {
+        std::wstring name;
+        bool (*filter)(const LowlevelMouseEvent& event, void* context);
+        void* filterContext;
+        HWND notifyWindow;
+        UINT notifyMessage;
+        std::unique_ptr<MouseEventRing> ring;
+    };
+
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    std::shared_mutex subscribersMutex;
+
+    // Serializes installing and removing the hook.
+    std::mutex hookThreadMutex;
+    std::thread hookThread;
+    DWORD hookThreadId = 0;
+    HHOOK hHook{};
+
+    struct
+    {
+        std::atomic<uint64_t> events;
+        std::atomic<uint64_t> swallowed;
+        std::atomic<std::chrono::steady_clock::rep> totalHookTime;
+        std::atomic<std::chrono::steady_clock::rep> maxHookTime;
+    } statistics;
+
+    LRESULT CALLBACK MouseHookProc(_In_ int nCode, _In_ WPARAM wParam, _In_ LPARAM lParam)
+    {
+        if (nCode < 0)
+        {
+            return CallNextHookEx(hHook, nCode, wParam, lParam);
+        }
+
+        const auto hookStart = std::chrono::steady_clock::now();
+        const auto& hookData = *reinterpret_cast<MSLLHOOKSTRUCT*>(lParam);
+
+        LARGE_INTEGER timestamp;
+        QueryPerformanceCounter(&timestamp);
+        const LowlevelMouseEvent event{
+            .message = static_cast<UINT>(wParam),
+            .pt = hookData.pt,
+            .mouseData = hookData.mouseData,
+            .flags = hookData.flags,
+            .time = hookData.time,
+            .hookTimestamp = timestamp.QuadPart
+        };
+
+        bool swallow = false;
+        {
+            std::shared_lock lock{ subscribersMutex };
+            for (const auto& subscriber : subscribers)
+            {
+                if (subscriber->filter && subscriber->filter(event, subscriber->filterContext))
+                {
+                    swallow = true;
+                    break;
+                }
+            }
+
+            if (!swallow)
+            {
+                for (const auto& subscriber : subscribers)
+                {
+                    if (subscriber->notifyWindow && subscriber->ring->Push(event))
+                    {
+                        PostMessageW(subscriber->notifyWindow, subscriber->notifyMessage, 0, 0);
+                    }
+                }
+            }
+        }
+
+        const auto hookTime = (std::chrono::steady_clock::now() - hookStart).count();
+        statistics.events.fetch_add(1, std::memory_order_relaxed);
+        statistics.totalHookTime.fetch_add(hookTime, std::memory_order_relaxed);
+        if (hookTime > statistics.maxHookTime.load(std::memory_order_relaxed))
+        {
+            statistics.maxHookTime.store(hookTime, std::memory_order_relaxed);
+        }
+
+        if (swallow)
+        {
+            statistics.swallowed.fetch_add(1, std::memory_order_relaxed);
+            return 1;
+        }
+
+        return CallNextHookEx(hHook, nCode, wParam, lParam);
+    }
+
+    // Low level hooks are called on the thread that installed them, which has to
+    // pump messages. A thread of its own keeps the mouse responsive while the
+    // runner's main thread is busy.
+    void HookThreadProc(HANDLE readyEvent)
+    {
+        MSG msg;
+        PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+        hookThreadId = GetCurrentThreadId();
+        hHook = SetWindowsHookExW(WH_MOUSE_LL, MouseHookProc, nullptr, 0);
+        if (!hHook)
+        {
+            Logger::error(L"Failed to install the centralized mouse hook. {}", GetLastError());
+        }
+        SetEvent(readyEvent);
+        if (!hHook)
+        {
+            return;
+        }
+
+        while (GetMessageW(&msg, nullptr, 0, 0) > 0)
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        UnhookWindowsHookEx(hHook);
+        hHook = nullptr;
+    }
+
+    // Called with hookThreadMutex held.
+    bool StartHookThread()
+    {
+#if defined(DISABLE_LOWLEVEL_HOOKS_WHEN_DEBUGGED)
+        if (IsDebuggerPresent())
+        {
+            return false;
+        }
+#endif
+        if (hookThread.joinable())
+        {
+            return hHook != nullptr;
+        }
+
+        wil::unique_event readyEvent;
+        readyEvent.create();
+        hookThread = std::thread(HookThreadProc, readyEvent.get());
+        readyEvent.wait();
+        if (!hHook)
+        {
+            hookThread.join();
+            return false;
+        }
+
+        Logger::info(L"Centralized mouse hook installed");
+        return true;
+    }
+
+    // Called with hookThreadMutex held.
+    void StopHookThread()
+    {
+        if (!hookThread.joinable())
+        {
+            return;
+        }
+
+        PostThreadMessageW(hookThreadId, WM_QUIT, 0, 0);
+        hookThread.join();
+        hookThreadId = 0;
+        Logger::info(L"Centralized mouse hook removed");
+    }
+
+    class Service final : public MouseHookService
+    {
+    public:
+        MouseEventRing* Subscribe(const MouseHookSubscriberInfo& info) override
+        {
+            std::scoped_lock threadLock{ hookThreadMutex };
+            if (!StartHookThread())
+            {
+                return nullptr;
+            }
+
+            auto subscriber = std::make_unique<Subscriber>(Subscriber{
+                .name = info.name ? info.name : L"",
+                .filter = info.filter,
+                .filterContext = info.filterContext,
+                .notifyWindow = info.notifyWindow,
+                .notifyMessage = info.notifyMessage,
+                .ring = std::make_unique<MouseEventRing>() });
+            auto ring = subscriber->ring.get();
+            Logger::info(L"{} subscribed to the centralized mouse hook", subscriber->name);
+
+            std::unique_lock lock{ subscribersMutex };
+            subscribers.push_back(std::move(subscriber));
+            return ring;
+        }
+
+        void Unsubscribe(MouseEventRing* subscription) override
+        {
+            std::scoped_lock threadLock{ hookThreadMutex };
+            std::unique_ptr<Subscriber> subscriber;
+            bool lastSubscriber = false;
+            {
+                // Waits for the hook to be done with the subscriber.
+                std::unique_lock lock{ subscribersMutex };
+                auto it = std::find_if(subscribers.begin(), subscribers.end(), [subscription](const auto& s) { return s->ring.get() == subscription; });
+                if (it == subscribers.end())
+                {
+                    return;
+                }
+                subscriber = std::move(*it);
+                subscribers.erase(it);
+                lastSubscriber = subscribers.empty();
+            }
+
+            const auto ringStatistics = subscriber->ring->Statistics();
+            Logger::info(L"{} unsubscribed from the centralized mouse hook. {} events delivered, {} coalesced, {} dropped. Latency {} us on average, {} us max",
+                         subscriber->name,
+                         ringStatistics.delivered,
+                         ringStatistics.coalesced,
+                         ringStatistics.dropped,
+                         ringStatistics.delivered ? ringStatistics.totalLatencyUs / ringStatistics.delivered : 0,
+                         ringStatistics.maxLatencyUs);
+
+            if (lastSubscriber)
+            {
+                StopHookThread();
+            }
+        }
+    };
+
+    Service service;
+
+    struct DestroyOnExit
+    {
+        ~DestroyOnExit()
+        {
+            Stop();
+        }
+    } destroyOnExitObj;
+
+    MouseHookService* GetService() noexcept
+    {
+        return &service;
+    }
+
+    void Stop() noexcept
+    {
+        std::scoped_lock threadLock{ hookThreadMutex };
+        StopHookThread();
+    }
+
+    HookStatistics GetStatistics() noexcept
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+        return {
+            .events = statistics.events.load(),
+            .swallowed = statistics.swallowed.load(),
+            .totalHookTime = duration_cast<microseconds>(steady_clock::duration{ statistics.totalHookTime.load() }),
+            .maxHookTime = duration_cast<microseconds>(steady_clock::duration{ statistics.maxHookTime.load() }),
+        };
+    }
+}
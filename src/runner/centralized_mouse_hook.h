@@ -0,0 +1,20 @@
+#include "pch.h"
+
+#include "../modules/interface/mouse_hook_service.h"
+
+namespace CentralizedMouseHook
+{
+    struct HookStatistics
+    {
+        uint64_t events = 0;
+        uint64_t swallowed = 0;
+        std::chrono::microseconds totalHookTime{};
+        std::chrono::microseconds maxHookTime{};
+    };
+
+    // The service handed to the modules. The hook is installed on its own thread
+    // when the first subscriber arrives, and removed with the last one.
+    MouseHookService* GetService() noexcept;
+    void Stop() noexcept;
+    HookStatistics GetStatistics() noexcept;
+};
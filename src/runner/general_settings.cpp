@@ -187,7 +187,7 @@ GeneralSettings get_general_settings()
 
     for (auto& [name, powertoy] : modules())
     {
-        settings.isModulesEnabledMap[name] = powertoy->is_enabled();
+        settings.isModulesEnabledMap[name] = powertoy.is_enabled();
     }
 
     return settings;
@@ -313,9 +313,15 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
                 continue;
             }
             PowertoyModule& powertoy = modules().at(name);
-            const bool module_inst_enabled = powertoy->is_enabled();
+            const bool module_inst_enabled = powertoy.is_enabled();
             bool target_enabled = value.GetBoolean();
 
+            // Modules that were never loaded are disabled, keep them unloaded until they're enabled
+            if (!powertoy.is_loaded() && !target_enabled)
+            {
+                continue;
+            }
+
             auto gpo_rule = powertoy->gpo_policy_enabled_configuration();
             if (gpo_rule == powertoys_gpo::gpo_rule_configured_enabled || gpo_rule == powertoys_gpo::gpo_rule_configured_disabled)
             {
@@ -330,7 +336,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             if (target_enabled)
             {
                 Logger::info(L"apply_general_settings: Enabling powertoy {}", name);
-                powertoy->enable();
+                powertoy.enable();
                 auto& hkmng = HotkeyConflictDetector::HotkeyConflictManager::GetInstance();
                 hkmng.EnableHotkeyByModule(name);
 
@@ -409,6 +415,12 @@ void start_enabled_powertoys()
     // Take into account default values supplied by modules themselves and gpo configurations
     for (auto& [name, powertoy] : modules())
     {
+        // Stubs are modules load_powertoys already found to stay disabled
+        if (!powertoy.is_loaded())
+        {
+            continue;
+        }
+
         auto gpo_rule = powertoy->gpo_policy_enabled_configuration();
         powertoys_gpo_configuration[name] = gpo_rule;
         if (gpo_rule == powertoys_gpo::gpo_rule_configured_unavailable)
@@ -462,6 +474,11 @@ void start_enabled_powertoys()
 
     for (auto& [name, powertoy] : modules())
     {
+        if (!powertoy.is_loaded())
+        {
+            continue;
+        }
+
         bool should_powertoy_be_enabled = true;
 
         auto gpo_rule = powertoys_gpo_configuration.find(name) != powertoys_gpo_configuration.end() ? powertoys_gpo_configuration[name] : powertoys_gpo::gpo_rule_configured_not_configured;
@@ -481,7 +498,7 @@ void start_enabled_powertoys()
         if (should_powertoy_be_enabled)
         {
             Logger::info(L"start_enabled_powertoys: Enabling powertoy {}", name);
-            powertoy->enable();
+            powertoy.enable();
             auto& hkmng = HotkeyConflictDetector::HotkeyConflictManager::GetInstance();
             hkmng.EnableHotkeyByModule(name);
             powertoy.UpdateHotkeyEx();
@@ -36,6 +36,7 @@
 #include <RestartManager.h>
 #include <shellapi.h>
 #include "centralized_kb_hook.h"
+#include "centralized_mouse_hook.h"
 #include "centralized_hotkeys.h"
 #include "quick_access_host.h"
 #include "ai_detection.h"
@@ -288,34 +289,27 @@ int runner(bool isProcessElevated, bool openSettings, std::string settingsWindow
             L"PowerToys.LightSwitchModuleInterface.dll",
         };
 
-        for (auto moduleSubdir : knownModules)
+        for (auto moduleSubdir : load_powertoys(knownModules))
         {
-            try
-            {
-                auto pt_module = load_powertoy(moduleSubdir);
-                modules().emplace(pt_module->get_key(), std::move(pt_module));
-            }
-            catch (...)
-            {
-                std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
-                errorMessage += moduleSubdir;
-                
+            std::wstring errorMessage = POWER_TOYS_MODULE_LOAD_FAIL;
+            errorMessage += moduleSubdir;
+            
 #ifdef _DEBUG
-                // In debug mode, simply log the warning and continue execution.
-                // This contrasts with the past approach where developers had to build all modules
-                // without errors before debugging—slowing down quick clone-and-fix iterations.
-                Logger::warn(L"Debug mode: {}", errorMessage);
+            // In debug mode, simply log the warning and continue execution.
+            // This contrasts with the past approach where developers had to build all modules
+            // without errors before debugging—slowing down quick clone-and-fix iterations.
+            Logger::warn(L"Debug mode: {}", errorMessage);
 #else
-                // In release mode, show error dialog as before
-                MessageBoxW(NULL,
-                            errorMessage.c_str(),
-                            L"PowerToys",
-                            MB_OK | MB_ICONERROR);
+            // In release mode, show error dialog as before
+            MessageBoxW(NULL,
+                        errorMessage.c_str(),
+                        L"PowerToys",
+                        MB_OK | MB_ICONERROR);
 #endif
-            }
         }
         // Start initial powertoys
         start_enabled_powertoys();
+        log_startup_timeline();
         std::wstring product_version = get_product_version();
         Trace::EventLaunch(product_version, isProcessElevated);
         PTSettingsHelper::save_last_version_run(product_version);
@@ -349,6 +343,25 @@ int runner(bool isProcessElevated, bool openSettings, std::string settingsWindow
         MessageBoxW(nullptr, std::wstring(err_what.begin(), err_what.end()).c_str(), GET_RESOURCE_STRING(IDS_ERROR).c_str(), MB_OK | MB_ICONERROR | MB_SETFOREGROUND);
         result = -1;
     }
+
+    CentralizedKeyboardHook::Stop();
+    const auto hookStatistics = CentralizedKeyboardHook::GetStatistics();
+    Logger::info(L"Keyboard hook handled {} key events and {} hotkeys ({} swallowed). {} us in the hook, longest {} us. Slowest hotkey dispatch {} us",
+                 hookStatistics.keyEvents,
+                 hookStatistics.hotkeysMatched,
+                 hookStatistics.hotkeysSwallowed,
+                 hookStatistics.totalHookTime.count(),
+                 hookStatistics.maxHookTime.count(),
+                 hookStatistics.maxDispatchDelay.count());
+
+    CentralizedMouseHook::Stop();
+    const auto mouseHookStatistics = CentralizedMouseHook::GetStatistics();
+    Logger::info(L"Mouse hook handled {} events ({} swallowed). {} us in the hook, longest {} us",
+                 mouseHookStatistics.events,
+                 mouseHookStatistics.swallowed,
+                 mouseHookStatistics.totalHookTime.count(),
+                 mouseHookStatistics.maxHookTime.count());
+
     Trace::UnregisterProvider();
     QuickAccessHost::stop();
     return result;
@@ -491,7 +504,8 @@ int WINAPI WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, LPSTR l
 
     std::filesystem::path logFilePath(PTSettingsHelper::get_root_save_folder_location());
     logFilePath.append(LogSettings::runnerLogPath);
-    Logger::init(LogSettings::runnerLoggerName, logFilePath.wstring(), PTSettingsHelper::get_log_settings_file_location());
+    // The runner logs from its keyboard and mouse hooks, keep the disk writes off the hook thread
+    Logger::init(LogSettings::runnerLoggerName, logFilePath.wstring(), PTSettingsHelper::get_log_settings_file_location(), LoggerMode::Asynchronous);
 
     const std::string cmdLine{ lpCmdLine };
     Logger::info("Running powertoys with cmd args: {}", cmdLine);
@@ -638,5 +652,8 @@ int WINAPI WinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, LPSTR l
     }
     stop_tray_icon();
 
+    // A policy refresh that is still running would use the watcher after the static destructors ran
+    powertoys_gpo::stopPolicyWatcher();
+
     return result;
 }
@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "module_manifest.h"
+
+#include <filesystem>
+
+#include <common/logger/logger.h>
+#include <common/SettingsAPI/settings_helpers.h>
+#include <common/utils/json.h>
+#include <common/version/version.h>
+
+namespace
+{
+    constexpr inline const wchar_t* manifest_filename = L"module_manifest.json";
+    constexpr inline const wchar_t* version_json_field_name = L"version";
+    constexpr inline const wchar_t* modules_json_field_name = L"modules";
+    constexpr inline const wchar_t* key_json_field_name = L"key";
+    constexpr inline const wchar_t* enabled_by_default_json_field_name = L"enabled_by_default";
+    constexpr inline const wchar_t* hotkeys_json_field_name = L"hotkeys";
+    constexpr inline const wchar_t* win_json_field_name = L"win";
+    constexpr inline const wchar_t* ctrl_json_field_name = L"ctrl";
+    constexpr inline const wchar_t* shift_json_field_name = L"shift";
+    constexpr inline const wchar_t* alt_json_field_name = L"alt";
+    constexpr inline const wchar_t* code_json_field_name = L"code";
+    constexpr inline const wchar_t* index_json_field_name = L"index";
+
+    std::wstring get_manifest_path()
+    {
+        std::filesystem::path path(PTSettingsHelper::get_root_save_folder_location());
+        return path.append(manifest_filename).wstring();
+    }
+
+    json::JsonArray hotkeys_to_json(const std::vector<ModuleManifest::ShownHotkey>& hotkeys)
+    {
+        json::JsonArray result;
+        for (const auto& [hotkey, index] : hotkeys)
+        {
+            json::JsonObject object;
+            object.SetNamedValue(win_json_field_name, json::value(hotkey.win));
+            object.SetNamedValue(ctrl_json_field_name, json::value(hotkey.ctrl));
+            object.SetNamedValue(shift_json_field_name, json::value(hotkey.shift));
+            object.SetNamedValue(alt_json_field_name, json::value(hotkey.alt));
+            object.SetNamedValue(code_json_field_name, json::value(static_cast<int>(hotkey.key)));
+            object.SetNamedValue(index_json_field_name, json::value(index));
+            result.Append(object);
+        }
+        return result;
+    }
+
+    std::vector<ModuleManifest::ShownHotkey> hotkeys_from_json(const json::JsonArray& array)
+    {
+        std::vector<ModuleManifest::ShownHotkey> result;
+        for (const auto& element : array)
+        {
+            const auto object = element.GetObjectW();
+            ModuleManifest::ShownHotkey shown;
+            shown.hotkey.win = object.GetNamedBoolean(win_json_field_name, false);
+            shown.hotkey.ctrl = object.GetNamedBoolean(ctrl_json_field_name, false);
+            shown.hotkey.shift = object.GetNamedBoolean(shift_json_field_name, false);
+            shown.hotkey.alt = object.GetNamedBoolean(alt_json_field_name, false);
+            shown.hotkey.key = static_cast<unsigned char>(object.GetNamedNumber(code_json_field_name, 0));
+            shown.index = static_cast<int>(object.GetNamedNumber(index_json_field_name, 0));
+            shown.hotkey.id = shown.index;
+            result.push_back(shown);
+        }
+        return result;
+    }
+}
+
+ModuleManifest ModuleManifest::load()
+{
+    ModuleManifest manifest;
+    manifest.version = get_product_version();
+
+    auto saved = json::from_file(get_manifest_path());
+    if (!saved)
+    {
+        return manifest;
+    }
+
+    try
+    {
+        if (saved->GetNamedString(version_json_field_name, L"") != manifest.version)
+        {
+            Logger::info(L"Module manifest is from another PowerToys version, every module will be loaded");
+            return manifest;
+        }
+
+        for (const auto& element : saved->GetNamedObject(modules_json_field_name))
+        {
+            const auto module = element.Value().GetObjectW();
+            Entry entry;
+            entry.key = module.GetNamedString(key_json_field_name);
+            entry.enabledByDefault = module.GetNamedBoolean(enabled_by_default_json_field_name, true);
+            if (module.HasKey(hotkeys_json_field_name))
+            {
+                entry.hotkeys = hotkeys_from_json(module.GetNamedArray(hotkeys_json_field_name));
+            }
+            manifest.entries.emplace(element.Key().c_str(), std::move(entry));
+        }
+    }
+    catch (...)
+    {
+        Logger::warn(L"Module manifest is malformed, every module will be loaded");
+        manifest.entries.clear();
+    }
+
+    return manifest;
+}
+
+std::optional<ModuleManifest::Entry> ModuleManifest::find(std::wstring_view dll) const
+{
+    if (auto it = entries.find(dll); it != entries.end())
+    {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void ModuleManifest::update(std::wstring_view dll, Entry entry)
+{
+    auto it = entries.find(dll);
+    if (it == entries.end())
+    {
+        entries.emplace(std::wstring{ dll }, std::move(entry));
+        changed = true;
+    }
+    else if (it->second != entry)
+    {
+        it->second = std::move(entry);
+        changed = true;
+    }
+}
+
+void ModuleManifest::update_hotkeys(std::wstring_view key, std::vector<ShownHotkey> hotkeys)
+{
+    for (auto& [dll, entry] : entries)
+    {
+        if (entry.key == key)
+        {
+            if (entry.hotkeys != hotkeys)
+            {
+                entry.hotkeys = std::move(hotkeys);
+                changed = true;
+            }
+            return;
+        }
+    }
+}
+
+void ModuleManifest::save()
+{
+    if (!changed)
+    {
+        return;
+    }
+
+    json::JsonObject modules;
+    for (const auto& [dll, entry] : entries)
+    {
+        json::JsonObject module;
+        module.SetNamedValue(key_json_field_name, json::value(entry.key));
+        module.SetNamedValue(enabled_by_default_json_field_name, json::value(entry.enabledByDefault));
+        module.SetNamedValue(hotkeys_json_field_name, hotkeys_to_json(entry.hotkeys));
+        modules.SetNamedValue(dll, module);
+    }
+
+    json::JsonObject manifest;
+    manifest.SetNamedValue(version_json_field_name, json::value(version));
+    manifest.SetNamedValue(modules_json_field_name, modules);
+    json::to_file(get_manifest_path(), manifest);
+    changed = false;
+}
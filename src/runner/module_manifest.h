@@ -0,0 +1,48 @@
+#pragma once
+#include <interface/powertoy_module_interface.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// What the runner remembers about every module DLL between runs, so it can tell a module stays
+// disabled without loading the DLL. The manifest is dropped when the PowerToys version changes,
+// since a new build can rename modules or change their defaults.
+class ModuleManifest
+{
+public:
+    // A hotkey the module shows in the settings, index is its position in get_hotkeys
+    struct ShownHotkey
+    {
+        PowertoyModuleIface::Hotkey hotkey;
+        int index = 0;
+
+        bool operator==(const ShownHotkey&) const = default;
+    };
+
+    struct Entry
+    {
+        std::wstring key;
+        bool enabledByDefault = true;
+        // Lets the hotkey conflict detection know about the hotkeys of modules that aren't loaded
+        std::vector<ShownHotkey> hotkeys;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    static ModuleManifest load();
+
+    std::optional<Entry> find(std::wstring_view dll) const;
+    void update(std::wstring_view dll, Entry entry);
+
+    // Updates the hotkeys of the module with this key, for when they change after startup
+    void update_hotkeys(std::wstring_view key, std::vector<ShownHotkey> hotkeys);
+
+    // Writes the manifest to disk if update() changed it
+    void save();
+
+private:
+    std::wstring version;
+    std::map<std::wstring, Entry, std::less<>> entries;
+    bool changed = false;
+};
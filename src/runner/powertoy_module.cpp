@@ -1,10 +1,89 @@
 #include "pch.h"
 #include "powertoy_module.h"
 #include "centralized_kb_hook.h"
+#include "centralized_mouse_hook.h"
 #include "centralized_hotkeys.h"
+#include "general_settings.h"
+#include "module_manifest.h"
 #include <common/logger/logger.h>
+#include <common/utils/gpo.h>
 #include <common/utils/winapi_error.h>
 
+#include <atomic>
+
+namespace
+{
+    using startup_clock = std::chrono::steady_clock;
+
+    // Loading a DLL is mostly disk I/O and relocations, more threads than this just contend on
+    // the loader lock
+    constexpr size_t max_load_threads = 8;
+
+    startup_clock::time_point startup_begin;
+    std::chrono::microseconds startup_duration{};
+
+    std::chrono::microseconds elapsed_since(startup_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(startup_clock::now() - start);
+    }
+
+    double to_milliseconds(std::chrono::microseconds duration)
+    {
+        return duration.count() / 1000.0;
+    }
+
+    struct LoadedLibrary
+    {
+        HMODULE handle = nullptr;
+        DWORD error = ERROR_SUCCESS;
+        std::chrono::microseconds duration{};
+    };
+
+    LoadedLibrary load_library(const std::wstring_view filename)
+    {
+        LoadedLibrary result;
+        const auto start = startup_clock::now();
+        result.handle = LoadLibraryW(filename.data());
+        result.error = result.handle ? ERROR_SUCCESS : GetLastError();
+        result.duration = elapsed_since(start);
+        return result;
+    }
+
+    // Takes ownership of the handle
+    PowertoyModule create_powertoy(HMODULE handle, std::chrono::microseconds load_duration)
+    {
+        const auto start = startup_clock::now();
+        auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
+        if (!create)
+        {
+            FreeLibrary(handle);
+            winrt::throw_last_error();
+        }
+        auto pt_module = create();
+        if (!pt_module)
+        {
+            FreeLibrary(handle);
+            winrt::throw_hresult(winrt::hresult(E_POINTER));
+        }
+        pt_module->set_mouse_hook_service(CentralizedMouseHook::GetService());
+        return PowertoyModule(pt_module, handle, { load_duration, elapsed_since(start) });
+    }
+
+    // Same decision start_enabled_powertoys makes, from what the manifest remembers about the module
+    bool stays_disabled(const ModuleManifest::Entry& entry, const std::optional<json::JsonObject>& enabled_settings)
+    {
+        if (enabled_settings && enabled_settings->HasKey(entry.key))
+        {
+            const auto value = enabled_settings->GetNamedValue(entry.key);
+            if (value.ValueType() == json::JsonValueType::Boolean)
+            {
+                return !value.GetBoolean();
+            }
+        }
+        return !entry.enabledByDefault;
+    }
+}
+
 std::map<std::wstring, PowertoyModule>& modules()
 {
     static std::map<std::wstring, PowertoyModule> modules;
@@ -13,20 +92,160 @@ std::map<std::wstring, PowertoyModule>& modules()
 
 PowertoyModule load_powertoy(const std::wstring_view filename)
 {
-    auto handle = winrt::check_pointer(LoadLibraryW(filename.data()));
-    auto create = reinterpret_cast<powertoy_create_func>(GetProcAddress(handle, "powertoy_create"));
-    if (!create)
+    auto library = load_library(filename);
+    winrt::check_pointer(library.handle);
+    return create_powertoy(library.handle, library.duration);
+}
+
+std::vector<std::wstring_view> load_powertoys(const std::vector<std::wstring_view>& known_modules)
+{
+    startup_begin = startup_clock::now();
+
+    auto manifest = ModuleManifest::load();
+
+    std::optional<json::JsonObject> enabled_settings;
+    try
     {
-        FreeLibrary(handle);
-        winrt::throw_last_error();
+        auto general_settings = load_general_settings();
+        if (general_settings.HasKey(L"enabled"))
+        {
+            enabled_settings = general_settings.GetNamedObject(L"enabled");
+        }
     }
-    auto pt_module = create();
-    if (!pt_module)
+    catch (...)
+    {
+    }
+
+    const bool forced_by_gpo = powertoys_gpo::isAnyUtilityForcedEnabled();
+    if (forced_by_gpo)
+    {
+        Logger::info(L"load_powertoys: a policy enables utilities, loading every module");
+    }
+
+    std::vector<std::wstring_view> to_load;
+    for (auto dll : known_modules)
+    {
+        const auto entry = manifest.find(dll);
+        if (!forced_by_gpo && entry && stays_disabled(*entry, enabled_settings))
+        {
+            Logger::info(L"load_powertoys: {} is disabled, loading it on first use", entry->key);
+            modules().emplace(entry->key, PowertoyModule(std::wstring{ dll }, entry->key, entry->hotkeys));
+        }
+        else
+        {
+            to_load.push_back(dll);
+        }
+    }
+
+    std::vector<LoadedLibrary> libraries(to_load.size());
+    std::atomic<size_t> next_library = 0;
+    auto load_libraries = [&] {
+        for (size_t i = next_library++; i < to_load.size(); i = next_library++)
+        {
+            libraries[i] = load_library(to_load[i]);
+        }
+    };
+
+    const size_t thread_count = (std::min)({ to_load.size(), static_cast<size_t>((std::max)(1u, std::thread::hardware_concurrency())), max_load_threads });
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; i++)
+    {
+        threads.emplace_back(load_libraries);
+    }
+    load_libraries();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Modules create their windows and hooks in powertoy_create, those belong to the thread that
+    // runs the message loop
+    std::vector<std::wstring_view> failed;
+    for (size_t i = 0; i < to_load.size(); i++)
     {
-        FreeLibrary(handle);
-        winrt::throw_hresult(winrt::hresult(E_POINTER));
+        if (!libraries[i].handle)
+        {
+            Logger::error(L"load_powertoys: failed to load {}. {}", to_load[i], get_last_error_or_default(libraries[i].error));
+            failed.push_back(to_load[i]);
+            continue;
+        }
+
+        try
+        {
+            auto pt_module = create_powertoy(libraries[i].handle, libraries[i].duration);
+            manifest.update(to_load[i], { pt_module.key(), pt_module->is_enabled_by_default(), pt_module.shown_hotkeys() });
+            modules().emplace(pt_module.key(), std::move(pt_module));
+        }
+        catch (...)
+        {
+            failed.push_back(to_load[i]);
+        }
+    }
+
+    try
+    {
+        manifest.save();
+    }
+    catch (...)
+    {
+        Logger::warn(L"load_powertoys: failed to save the module manifest");
+    }
+
+    return failed;
+}
+
+void remember_module_hotkeys(const PowertoyModule& powertoy)
+{
+    auto manifest = ModuleManifest::load();
+    manifest.update_hotkeys(powertoy.key(), powertoy.shown_hotkeys());
+    try
+    {
+        manifest.save();
+    }
+    catch (...)
+    {
+        Logger::warn(L"remember_module_hotkeys: failed to save the module manifest");
+    }
+}
+
+json::JsonObject get_startup_timeline()
+{
+    json::JsonArray timeline;
+    for (const auto& [name, powertoy] : modules())
+    {
+        const auto& timing = powertoy.startup_timing();
+        json::JsonObject entry;
+        entry.SetNamedValue(L"name", json::value(name));
+        entry.SetNamedValue(L"loaded", json::value(powertoy.is_loaded()));
+        entry.SetNamedValue(L"load_ms", json::value(to_milliseconds(timing.load)));
+        entry.SetNamedValue(L"create_ms", json::value(to_milliseconds(timing.create)));
+        entry.SetNamedValue(L"enable_ms", json::value(to_milliseconds(timing.enable)));
+        timeline.Append(entry);
+    }
+
+    json::JsonObject result;
+    result.SetNamedValue(L"total_ms", json::value(to_milliseconds(startup_duration)));
+    result.SetNamedValue(L"modules", timeline);
+    return result;
+}
+
+void log_startup_timeline()
+{
+    startup_duration = elapsed_since(startup_begin);
+
+    size_t deferred = 0;
+    for (const auto& [name, powertoy] : modules())
+    {
+        if (!powertoy.is_loaded())
+        {
+            deferred++;
+            continue;
+        }
+
+        const auto& timing = powertoy.startup_timing();
+        Logger::info(L"Startup timeline: {} load {:.1f} ms, create {:.1f} ms, enable {:.1f} ms", name, to_milliseconds(timing.load), to_milliseconds(timing.create), to_milliseconds(timing.enable));
     }
-    return PowertoyModule(pt_module, handle);
+    Logger::info(L"Startup timeline: {} modules started in {:.1f} ms, {} disabled modules deferred", modules().size() - deferred, to_milliseconds(startup_duration), deferred);
 }
 
 json::JsonObject PowertoyModule::json_config() const
@@ -39,45 +258,102 @@ json::JsonObject PowertoyModule::json_config() const
     return json::JsonObject::Parse(result);
 }
 
-PowertoyModule::PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle) :
-    handle(handle), pt_module(pt_module), hkmng(HotkeyConflictDetector::HotkeyConflictManager::GetInstance())
+PowertoyModule::PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle, ModuleStartupTiming timing) :
+    hkmng(HotkeyConflictDetector::HotkeyConflictManager::GetInstance()), handle(handle), pt_module(pt_module), timing(timing)
 {
     if (!pt_module)
     {
         throw std::runtime_error("Module not initialized");
     }
 
+    module_key = pt_module->get_key();
+    register_hotkeys();
+}
+
+PowertoyModule::PowertoyModule(std::wstring dll_path, std::wstring key, std::vector<ModuleManifest::ShownHotkey> hotkeys) :
+    hkmng(HotkeyConflictDetector::HotkeyConflictManager::GetInstance()), module_key(std::move(key)), hotkeys(std::move(hotkeys)), dll_path(std::move(dll_path))
+{
+    for (const auto& [hotkey, index] : this->hotkeys)
+    {
+        hkmng.AddHotkey(hotkey, module_key.c_str(), index, false);
+    }
+}
+
+void PowertoyModule::register_hotkeys()
+{
     remove_hotkey_records();
     update_hotkeys();
     UpdateHotkeyEx();
 }
 
+void PowertoyModule::ensure_loaded()
+{
+    if (pt_module)
+    {
+        return;
+    }
+
+    Logger::info(L"Loading {} on first use", module_key);
+    const auto stub_hotkeys = hotkeys;
+    auto loaded = load_powertoy(dll_path);
+    if (loaded.key() != module_key)
+    {
+        Logger::warn(L"{} was expected to be the {} module but is {}", dll_path, module_key, loaded.key());
+    }
+
+    // The loaded module registered its hotkeys under its own key, those records and actions go
+    // away with it, the ones of this stub are registered again from the module
+    loaded.remove_hotkey_records();
+    CentralizedKeyboardHook::ClearModuleHotkeys(loaded.key());
+    handle = std::move(loaded.handle);
+    pt_module = std::move(loaded.pt_module);
+    timing = loaded.timing;
+
+    register_hotkeys();
+    if (hotkeys != stub_hotkeys)
+    {
+        remember_module_hotkeys(*this);
+    }
+}
+
+void PowertoyModule::enable()
+{
+    const auto start = startup_clock::now();
+    (*this)->enable();
+    timing.enable = elapsed_since(start);
+}
+
 void PowertoyModule::update_hotkeys()
 {
+    ensure_loaded();
     CentralizedKeyboardHook::ClearModuleHotkeys(pt_module->get_key());
 
     size_t hotkeyCount = pt_module->get_hotkeys(nullptr, 0);
-    std::vector<PowertoyModuleIface::Hotkey> hotkeys(hotkeyCount);
-    pt_module->get_hotkeys(hotkeys.data(), hotkeyCount);
+    std::vector<PowertoyModuleIface::Hotkey> moduleHotkeys(hotkeyCount);
+    pt_module->get_hotkeys(moduleHotkeys.data(), hotkeyCount);
 
     auto modulePtr = pt_module.get();
 
+    hotkeys.clear();
     for (size_t i = 0; i < hotkeyCount; i++)
     {
-        if (hotkeys[i].isShown)
+        if (moduleHotkeys[i].isShown)
         {
-            hkmng.AddHotkey(hotkeys[i], pt_module->get_key(), static_cast<int>(i), pt_module->is_enabled());
+            hkmng.AddHotkey(moduleHotkeys[i], pt_module->get_key(), static_cast<int>(i), pt_module->is_enabled());
+            hotkeys.push_back({ moduleHotkeys[i], static_cast<int>(i) });
 
-            CentralizedKeyboardHook::SetHotkeyAction(pt_module->get_key(), hotkeys[i], [modulePtr, i] {
-                Logger::trace(L"{} hotkey is invoked from Centralized keyboard hook", modulePtr->get_key());
-                return modulePtr->on_hotkey(i);
-            });
+            CentralizedKeyboardHook::SetHotkeyAction(
+                pt_module->get_key(),
+                moduleHotkeys[i],
+                [modulePtr, i] { return modulePtr->should_swallow_hotkey(i); },
+                [modulePtr, i] { return modulePtr->on_hotkey(i); });
         }
     }
 }
 
 void PowertoyModule::UpdateHotkeyEx()
 {
+    ensure_loaded();
     CentralizedHotkeys::UnregisterHotkeysForModule(pt_module->get_key());
 
     auto container = pt_module->GetHotkeyEx();
@@ -5,7 +5,10 @@
 #include <mutex>
 #include <vector>
 #include <functional>
+#include <chrono>
+#include <map>
 #include "hotkey_conflict_detector.h"
+#include "module_manifest.h"
 
 #include <common/utils/json.h>
 
@@ -29,34 +32,104 @@ struct PowertoyModuleDLLDeleter
     }
 };
 
+// How long each startup step of a module took
+struct ModuleStartupTiming
+{
+    std::chrono::microseconds load{};
+    std::chrono::microseconds create{};
+    std::chrono::microseconds enable{};
+};
+
 class PowertoyModule
 {
 public:
-    PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle);
+    PowertoyModule(PowertoyModuleIface* pt_module, HMODULE handle, ModuleStartupTiming timing = {});
+
+    // Stub for a module that stays disabled, the DLL is loaded the first time the module is used.
+    // The hotkeys the module had when it was last loaded are added to the conflict detection as disabled.
+    PowertoyModule(std::wstring dll_path, std::wstring key, std::vector<ModuleManifest::ShownHotkey> hotkeys = {});
 
+    // Loads a stub module, throws if the DLL can't be loaded
     inline PowertoyModuleIface* operator->()
     {
+        ensure_loaded();
         return pt_module.get();
     }
 
+    inline bool is_loaded() const
+    {
+        return pt_module != nullptr;
+    }
+
+    // Doesn't load a stub module, stubs are only created for disabled modules
+    inline bool is_enabled() const
+    {
+        return pt_module && pt_module->is_enabled();
+    }
+
+    // Loads a stub module and registers its hotkeys, throws if the DLL can't be loaded
+    void ensure_loaded();
+
+    // Doesn't load a stub module
+    inline const std::wstring& key() const
+    {
+        return module_key;
+    }
+
+    // Enables the module and records how long it took
+    void enable();
+
+    inline const ModuleStartupTiming& startup_timing() const
+    {
+        return timing;
+    }
+
     json::JsonObject json_config() const;
 
+    // Both load a stub module first
     void update_hotkeys();
-
     void UpdateHotkeyEx();
 
+    // The hotkeys update_hotkeys last added to the conflict detection, or the ones a stub was created with
+    inline const std::vector<ModuleManifest::ShownHotkey>& shown_hotkeys() const
+    {
+        return hotkeys;
+    }
+
+    // Doesn't load a stub module
     inline void remove_hotkey_records()
     {
-        hkmng.RemoveHotkeyByModule(pt_module->get_key());
+        hkmng.RemoveHotkeyByModule(module_key);
     }
 
 private:
+    void register_hotkeys();
+
     HotkeyConflictDetector::HotkeyConflictManager& hkmng;
     std::unique_ptr<HMODULE, PowertoyModuleDLLDeleter> handle;
     std::unique_ptr<PowertoyModuleIface, PowertoyModuleDeleter> pt_module;
 
-    
+    std::wstring module_key;
+    std::vector<ModuleManifest::ShownHotkey> hotkeys;
+
+    // Set for stubs only
+    std::wstring dll_path;
+
+    ModuleStartupTiming timing;
 };
 
 PowertoyModule load_powertoy(const std::wstring_view filename);
+
+// Loads the known modules into modules() and returns the DLLs that failed to load.
+// Modules that stay disabled according to the settings are added as stubs. The DLLs of the
+// others are loaded in parallel, their modules are created on the calling thread.
+std::vector<std::wstring_view> load_powertoys(const std::vector<std::wstring_view>& known_modules);
+
+// Load, create and enable durations of every module, for the log and the settings window
+json::JsonObject get_startup_timeline();
+void log_startup_timeline();
+
+// Saves the hotkeys of the module to the module manifest, call when they changed after startup
+void remember_module_hotkeys(const PowertoyModule& powertoy);
+
 std::map<std::wstring, PowertoyModule>& modules();
@@ -43,6 +43,12 @@ json::JsonObject get_power_toys_settings()
     json::JsonObject result;
     for (const auto& [name, powertoy] : modules())
     {
+        // Not worth loading a disabled module for, its settings are on disk
+        if (!powertoy.is_loaded())
+        {
+            continue;
+        }
+
         try
         {
             result.SetNamedValue(name, powertoy.json_config());
@@ -61,6 +67,7 @@ json::JsonObject get_all_settings()
 
     result.SetNamedValue(L"general", get_general_settings().to_json());
     result.SetNamedValue(L"powertoys", get_power_toys_settings());
+    result.SetNamedValue(L"startup_timeline", get_startup_timeline());
     return result;
 }
 
@@ -160,6 +167,7 @@ void send_json_config_to_module(const std::wstring& module_key, const std::wstri
             moduleIt->second.remove_hotkey_records();
             moduleIt->second.update_hotkeys();
             moduleIt->second.UpdateHotkeyEx();
+            remember_module_hotkeys(moduleIt->second);
         }
     }
 }
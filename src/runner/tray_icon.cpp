@@ -456,10 +456,11 @@ void update_quick_access_hotkey(bool enabled, PowerToysSettings::HotkeyObject ho
         };
 
         hkmng.AddHotkey(hk, L"GeneralSettings", 0, true);
-        CentralizedKeyboardHook::SetHotkeyAction(L"QuickAccess", hk, []() {
-            open_quick_access_flyout_window();
-            return true;
-        });
+        CentralizedKeyboardHook::SetHotkeyAction(
+            L"QuickAccess", hk, [] { return true; }, [] {
+                open_quick_access_flyout_window();
+                return true;
+            });
 
         current_hotkey = hotkey;
         is_registered = true;
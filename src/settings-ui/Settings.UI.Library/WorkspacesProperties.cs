@@ -18,9 +18,12 @@ namespace Microsoft.PowerToys.Settings.UI.Library
 
         public static readonly HotkeySettings DefaultHotkeyValue = new HotkeySettings(true, true, false, false, 0xC0);
 
+        public const int DefaultLaunchConcurrency = 4;
+
         public WorkspacesProperties()
         {
             Hotkey = new KeyboardKeysProperty(DefaultHotkeyValue);
+            LaunchConcurrency = new IntProperty(DefaultLaunchConcurrency);
         }
 
         [JsonPropertyName("hotkey")]
@@ -29,6 +32,10 @@ namespace Microsoft.PowerToys.Settings.UI.Library
         [JsonPropertyName("sortby")]
         public SortByProperty SortBy { get; set; }
 
+        // How many apps the launcher starts at the same time
+        [JsonPropertyName("launch-concurrency")]
+        public IntProperty LaunchConcurrency { get; set; }
+
         public string ToJsonString()
         {
             return JsonSerializer.Serialize(this);